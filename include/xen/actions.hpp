@@ -68,7 +68,7 @@ void copy(XenTimeline const &tl);
 
 [[nodiscard]] auto cut(XenTimeline const &tl) -> SequencerState;
 
-[[nodiscard]] auto paste(XenTimeline const &tl) -> SequencerState;
+[[nodiscard]] auto paste(XenTimeline const &tl, std::size_t history) -> SequencerState;
 
 [[nodiscard]] auto duplicate(XenTimeline const &tl) -> TrackedState;
 
@@ -89,10 +89,28 @@ void save_measure(juce::File const &filepath, sequence::Measure const &measure);
 
 [[nodiscard]] auto load_measure(juce::File const &filepath) -> sequence::Measure;
 
+/**
+ * Write \p bank to \p filepath as JSON.
+ */
 void save_sequence_bank(SequenceBank const &bank,
                         std::array<std::string, 16> const &sequence_names,
                         juce::File const &filepath);
 
+/**
+ * Write \p bank to \p filepath in the binary format, see binary_serialize.hpp.
+ *
+ * @throw std::runtime_error If the file could not be written.
+ */
+void save_sequence_bank_binary(SequenceBank const &bank,
+                               std::array<std::string, 16> const &sequence_names,
+                               juce::File const &filepath);
+
+/**
+ * Read a sequence bank from \p filepath, in either the binary or the JSON format.
+ *
+ * @throw std::runtime_error If the file is larger than 128MB.
+ * @throw std::invalid_argument If the file contents can't be parsed.
+ */
 [[nodiscard]] auto load_sequence_bank(juce::File const &filepath)
     -> std::pair<SequenceBank, std::array<std::string, 16>>;
 
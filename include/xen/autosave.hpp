@@ -0,0 +1,172 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include <xen/state.hpp>
+
+namespace xen
+{
+
+/**
+ * Records each commit to a journal file in the autosave directory, so work can be
+ * recovered if the host crashes.
+ *
+ * @details Each line of the journal holds the command that made the commit and
+ * either the measures it changed, or a snapshot of the whole SequencerState for the
+ * first line and for any change outside of the sequence bank. Lines are written by a
+ * background thread in batches, and each batch is synced to disk once. Once the
+ * journal grows too long it is atomically replaced by a single snapshot.
+ *
+ * Journals are named by the id of the plugin instance they belong to, which is saved
+ * with the host state, so a restored instance only recovers its own work. The journal
+ * is deleted when the Autosave is destroyed, so any journal left without an owner is
+ * from a session that crashed, see find_recoverable_journals.
+ */
+class Autosave
+{
+  public:
+    // Commits that arrive within this time of each other share one flush to disk.
+    static constexpr auto batch_interval = std::chrono::milliseconds{250};
+
+    // The journal is compacted once it has this many lines or bytes.
+    static constexpr auto compact_line_count = std::size_t{256};
+    static constexpr auto compact_byte_count = std::size_t{4 * 1'024 * 1'024};
+
+  public:
+    /**
+     * Starts the background thread, the journal is created by the first append().
+     */
+    Autosave();
+
+    /**
+     * @param directory Returns the directory to write the journal to, called on the
+     * background thread. If it throws, commits are discarded.
+     */
+    explicit Autosave(std::function<juce::File()> directory);
+
+    Autosave(Autosave const &) = delete;
+    Autosave(Autosave &&) = delete;
+    auto operator=(Autosave const &) -> Autosave & = delete;
+    auto operator=(Autosave &&) -> Autosave & = delete;
+
+    /**
+     * Writes any pending commits, then deletes the journal and stops the thread.
+     */
+    ~Autosave();
+
+  public:
+    /**
+     * Queue a commit to be written to the journal, this never waits on the disk.
+     *
+     * @param command The command that made the commit, reported on recovery.
+     * @param state The committed state.
+     * @param instance_id The plugin instance, a change of id starts a new journal.
+     */
+    void append(std::string command, std::shared_ptr<SequencerState const> state,
+                std::string instance_id);
+
+    /**
+     * Queue a search for journals of \p instance_id left by sessions that crashed,
+     * see find_recoverable_journals.
+     *
+     * @details The search runs on the background thread, after any commits already
+     * queued, and is skipped if the Autosave is destroyed first.
+     * @param on_done Called on the background thread, with true if any were found.
+     */
+    void find_recoverable(std::string instance_id, std::function<void(bool)> on_done);
+
+  private:
+    struct Entry
+    {
+        std::string command;
+        std::shared_ptr<SequencerState const> state;
+        std::string instance_id;
+    };
+
+    struct Search
+    {
+        std::string instance_id;
+        std::function<void(bool)> on_done;
+    };
+
+    void run();
+
+    void open_journal(std::string const &instance_id);
+
+    void write_batch(std::vector<Entry> const &batch);
+
+    void run_search(Search const &search) const;
+
+    /**
+     * Replace the journal with a snapshot of the most recently written state.
+     */
+    void compact();
+
+    void close_journal();
+
+  private:
+    std::function<juce::File()> directory_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::vector<Entry> pending_;
+    std::vector<Search> pending_searches_;
+
+    // Distinguishes this journal from those of earlier sessions of the same instance.
+    juce::String const session_id_ = juce::Uuid{}.toString();
+
+    // Only used by the background thread.
+    std::optional<std::string> journal_instance_id_{std::nullopt};
+    juce::File journal_;
+    std::unique_ptr<juce::InterProcessLock> journal_lock_;
+    std::unique_ptr<juce::FileOutputStream> out_; // Null if the journal isn't open.
+    Entry written_; // The last commit written to the journal.
+    std::size_t line_count_ = 0;
+    std::size_t byte_count_ = 0;
+
+    std::thread thread_; // Last, so it starts after the members it uses.
+};
+
+/**
+ * The last state recorded by a journal.
+ */
+struct RecoveredSession
+{
+    SequencerState state;
+    std::string last_command;
+};
+
+/**
+ * Find the journals of \p instance_id in \p directory that were left by sessions that
+ * crashed.
+ *
+ * @details Journals in use by this or another process are skipped. Journals of any
+ * instance not modified in the last 30 days are deleted.
+ * @return The journals, most recently modified first.
+ */
+[[nodiscard]] auto find_recoverable_journals(juce::File const &directory,
+                                             std::string const &instance_id)
+    -> std::vector<juce::File>;
+
+/**
+ * Read the state recorded by the last complete line of a journal.
+ *
+ * @details A partially written line, and anything after it, is ignored.
+ * @throws std::runtime_error If the journal cannot be read or does not begin with a
+ * snapshot.
+ */
+[[nodiscard]] auto read_journal(juce::File const &journal) -> RecoveredSession;
+
+} // namespace xen
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <xen/message_level.hpp>
+
+namespace xen
+{
+struct PluginState;
+
+/**
+ * Cancellation state shared between a running task and its owner.
+ */
+class TaskContext
+{
+  public:
+    void cancel();
+
+    /**
+     * Work should check this between steps and return early if true, the result of a
+     * cancelled task is never applied.
+     */
+    [[nodiscard]] auto is_cancelled() const -> bool;
+
+  private:
+    std::atomic<bool> cancelled_{false};
+};
+
+/**
+ * Applies the result of a finished task to the PluginState on the message thread.
+ *
+ * @details This should stage any changes and set the commit flag, it is not
+ * responsible for committing.
+ */
+using TaskResult = std::function<std::pair<MessageLevel, std::string>(PluginState &)>;
+
+/**
+ * The work of a task, run on the worker thread against a snapshot taken before it was
+ * started. It must not touch the PluginState, changes are returned as a TaskResult.
+ */
+using TaskWork = std::function<TaskResult(TaskContext &)>;
+
+/**
+ * Runs a single TaskWork at a time on a background thread.
+ *
+ * @details All member functions must be called from the same (message) thread. The
+ * result of a task is only handed back through take_result, so it is up to the owner
+ * to decide when it is applied.
+ */
+class BackgroundWorker
+{
+  public:
+    BackgroundWorker() = default;
+
+    BackgroundWorker(BackgroundWorker const &) = delete;
+    BackgroundWorker(BackgroundWorker &&) = default;
+    auto operator=(BackgroundWorker const &) -> BackgroundWorker & = delete;
+    auto operator=(BackgroundWorker &&) -> BackgroundWorker & = delete;
+
+    /**
+     * Cancels and joins any running task, its result is discarded.
+     */
+    ~BackgroundWorker();
+
+  public:
+    /**
+     * Start running \p work on a new thread.
+     *
+     * @param description Short description of the task, used in status messages.
+     * @param work The work to run.
+     * @throws std::runtime_error If a task is already running.
+     */
+    void start(std::string description, TaskWork work);
+
+    /**
+     * Apply \p next after the result of the current task, as part of that result.
+     *
+     * @details \p next is discarded if the task is cancelled or its result reports an
+     * error. If both report a status, the more severe one is kept.
+     * @throws std::logic_error If not busy.
+     */
+    void then(TaskResult next);
+
+    /**
+     * Returns true if a task has been started and its result not yet taken.
+     */
+    [[nodiscard]] auto is_busy() const -> bool;
+
+    /**
+     * Returns the description of the current task, or an empty string if not busy.
+     */
+    [[nodiscard]] auto description() const -> std::string;
+
+    /**
+     * Request the current task to stop.
+     *
+     * @return True if there was a task to cancel.
+     */
+    auto cancel() -> bool;
+
+    /**
+     * Collect the result of the current task if it has finished.
+     *
+     * @details Joins the worker thread and leaves the worker ready for a new task.
+     * Errors thrown by the work and cancellation are reported by the returned result.
+     * @return The result to apply, or std::nullopt if not busy or not finished.
+     */
+    [[nodiscard]] auto take_result() -> std::optional<TaskResult>;
+
+    /**
+     * Block until the current task has finished, then take its result.
+     *
+     * @return The result to apply, or std::nullopt if not busy.
+     */
+    [[nodiscard]] auto wait() -> std::optional<TaskResult>;
+
+  private:
+    struct Task
+    {
+        std::string description;
+        TaskContext context;
+        TaskResult result;
+        TaskResult next;
+        std::atomic<bool> finished{false};
+        std::thread thread;
+    };
+
+    std::unique_ptr<Task> task_{nullptr};
+};
+
+} // namespace xen
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <xen/state.hpp>
+
+namespace xen
+{
+
+/**
+ * Binary .xss sequence bank format.
+ *
+ * @details All integers and floats are little-endian. The file begins with a fixed
+ * header followed by a section table, readers skip sections they don't recognize.
+ *
+ * Header (16 bytes):
+ *     char[4] magic "XSSB", u16 version, u16 reserved, u32 section count, u32 reserved
+ *
+ * Section table entry (16 bytes):
+ *     char[4] id, u32 reserved, u32 offset from file start, u32 size in bytes
+ *
+ * Sections:
+ *     "NODE" u32 count, then count 24 byte node records in pre-order:
+ *         u8 type (0 Rest, 1 Note, 2 Sequence), u8[3] reserved, f32 weight,
+ *         Note: i32 pitch, f32 velocity, f32 delay, f32 gate
+ *         Sequence: u32 child count, u32[3] reserved
+ *         Rest: u32[4] reserved
+ *     "MEAS" 16 measure records: u32 root node index, u32 numerator, u32 denominator
+ *     "STRS" u32 count, then count (u32 offset, u32 size) pairs into the bytes that
+ *         follow. The first 16 strings are the sequence names.
+ */
+namespace binary_bank
+{
+constexpr auto magic = std::array<char, 4>{'X', 'S', 'S', 'B'};
+constexpr auto version = std::uint16_t{1};
+} // namespace binary_bank
+
+/**
+ * Return true if \p bytes begins with the binary sequence bank magic number.
+ */
+[[nodiscard]] auto is_binary_sequence_bank(std::span<std::byte const> bytes) -> bool;
+
+/**
+ * Serialize a SequenceBank to the binary .xss format.
+ *
+ * @param bank The SequenceBank to serialize.
+ * @param sequence_names The names of the sequences in the bank.
+ * @return std::string The serialized bytes.
+ */
+[[nodiscard]] auto serialize_sequence_bank_binary(
+    SequenceBank const &bank, std::array<std::string, 16> const &sequence_names)
+    -> std::string;
+
+/**
+ * Deserialize a SequenceBank from the binary .xss format.
+ *
+ * @details \p bytes is read in place, this does not copy it or allocate until the Cell
+ * trees are built, so it can point directly into a memory mapped file.
+ * @param bytes The serialized bytes.
+ * @return The deserialized SequenceBank and sequence names.
+ * @throw std::invalid_argument If \p bytes is not a valid binary sequence bank or
+ * uses a newer version of the format.
+ */
+[[nodiscard]] auto deserialize_sequence_bank_binary(std::span<std::byte const> bytes)
+    -> std::pair<SequenceBank, std::array<std::string, 16>>;
+
+} // namespace xen
@@ -16,7 +16,19 @@ struct Chord
 };
 
 /**
- * Loads in Chords from library directory's chords.yml and user_chords.yml files.
+ * Returns the built-in Chords, converted from data/chords/chords.yml at build time.
+ */
+[[nodiscard]] auto get_system_chords() -> std::vector<Chord>;
+
+/**
+ * Loads in Chords from the library directory's user_chords.yml file.
+ *
+ * @throws YAML::Exception If the file cannot be parsed.
+ */
+[[nodiscard]] auto load_user_chords() -> std::vector<Chord>;
+
+/**
+ * Returns the built-in Chords followed by those in user_chords.yml.
  */
 [[nodiscard]] auto load_chords_from_files() -> std::vector<Chord>;
 
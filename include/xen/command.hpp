@@ -40,6 +40,29 @@ struct SplitInput
  */
 [[nodiscard]] auto split_input(std::string input) -> SplitInput;
 
+/**
+ * A single command that has been normalized and split ahead of execution.
+ *
+ * @details This lets callers that run the same command string repeatedly, such as key
+ * bindings, pay for parsing once instead of on every execution.
+ */
+struct PreparedCommand
+{
+    std::string text; // Normalized command text, used for 'again' and error messages.
+    SplitInput input;
+};
+
+/**
+ * Split a command string on ';' and prepare each non-empty command for execution.
+ *
+ * @param command_string The command string to prepare.
+ * @return std::vector<PreparedCommand> The prepared commands, in order.
+ * @exception std::invalid_argument Thrown when any command is not valid input to
+ * split_input.
+ */
+[[nodiscard]] auto prepare_command_string(std::string const &command_string)
+    -> std::vector<PreparedCommand>;
+
 /**
  * Provides a textural description of a command for documentation purposes.
  */
@@ -73,7 +96,7 @@ class CommandBase
 
     [[nodiscard]] virtual auto complete_text(SplitInput input) const -> std::string = 0;
 
-    [[nodiscard]] virtual auto generate_docs() -> std::vector<Documentation> = 0;
+    [[nodiscard]] virtual auto generate_docs() const -> std::vector<Documentation> = 0;
 };
 
 // -------------------------------------------------------------------------------------
@@ -126,7 +149,7 @@ class Command : public CommandBase
         return oss.str();
     }
 
-    [[nodiscard]] auto generate_docs() -> std::vector<Documentation> override
+    [[nodiscard]] auto generate_docs() const -> std::vector<Documentation> override
     {
         return {Documentation{
             .signature = generate_display(signature),
@@ -180,12 +203,27 @@ template <typename Signature_t, typename Fn>
 
 // -------------------------------------------------------------------------------------
 
+/**
+ * A named collection of Commands and nested CommandGroups.
+ *
+ * @details Child ids are matched case-insensitively. A lowercased, sorted index of the
+ * child ids is maintained as commands are added, so dispatch is a binary search over
+ * the index instead of a linear scan, and prefix completion only visits the contiguous
+ * range of ids that share the typed prefix.
+ */
 class CommandGroup : public CommandBase
 {
   public:
     CommandGroup(std::string_view id);
 
   public:
+    /**
+     * Add a child command to this group.
+     *
+     * @param cmd The command to add.
+     * @throws std::invalid_argument If a child with the same id, ignoring case, already
+     * exists in this group.
+     */
     void add(std::unique_ptr<CommandBase> cmd);
 
   public:
@@ -196,11 +234,36 @@ class CommandGroup : public CommandBase
 
     [[nodiscard]] auto complete_text(SplitInput input) const -> std::string override;
 
-    [[nodiscard]] auto generate_docs() -> std::vector<Documentation> override;
+    [[nodiscard]] auto generate_docs() const -> std::vector<Documentation> override;
 
   private:
+    /**
+     * Find the child whose id matches \p lowered_id exactly.
+     *
+     * @param lowered_id The id to look up, already lowercased.
+     * @return CommandBase* The matching child, or nullptr if there is no match.
+     */
+    [[nodiscard]] auto find_exact(std::string_view lowered_id) const -> CommandBase *;
+
+    /**
+     * Find the earliest added child whose id starts with \p lowered_prefix.
+     *
+     * @param lowered_prefix The prefix to look up, already lowercased.
+     * @return CommandBase* The matching child, or nullptr if there is no match.
+     */
+    [[nodiscard]] auto find_prefix(std::string_view lowered_prefix) const
+        -> CommandBase *;
+
+  private:
+    struct IndexEntry
+    {
+        std::string lowered_id;
+        std::size_t order; // Index into commands_, insertion order breaks ties.
+    };
+
     std::string_view id_;
     std::vector<std::unique_ptr<CommandBase>> commands_;
+    std::vector<IndexEntry> index_; // Sorted by lowered_id.
 };
 
 [[nodiscard]] auto cmd_group(std::string_view id) -> std::unique_ptr<CommandGroup>;
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <xen/command.hpp>
+
+namespace xen
+{
+
+/**
+ * A prebuilt index of every command path and argument signature in a command tree,
+ * used to generate guide text and tab completions for the command bar.
+ *
+ * @details The resolved state of the words before the one being typed is cached, so a
+ * keystroke within a word only matches that word against the children of the cached
+ * node. Partial ids match by prefix first, then by abbreviation, where the typed
+ * characters appear in order within the id, starting with its first character (e.g.
+ * 'sb' for 'sequenceBank'). Matches are ranked by number of uses, then by match
+ * quality, then by the order they were added to the tree.
+ */
+class CompletionIndex
+{
+  public:
+    /**
+     * Build the index from every command in \p tree.
+     */
+    explicit CompletionIndex(CommandBase const &tree);
+
+  public:
+    /**
+     * Generate guide text that completes the last command in \p input and lists
+     * argument info if applicable.
+     *
+     * @param input The current text of the command bar.
+     * @return The guide text, does not duplicate \p input text. Abbreviation matches
+     * are displayed in parentheses, as they can't be appended to the input.
+     */
+    [[nodiscard]] auto guide_text(std::string const &input) -> std::string;
+
+    /**
+     * Complete the id being typed at the end of \p input.
+     *
+     * @param input The current text of the command bar.
+     * @return The input with its last word replaced by the best matching id, followed
+     * by a space, or std::nullopt if there is nothing to complete.
+     */
+    [[nodiscard]] auto complete(std::string const &input) -> std::optional<std::string>;
+
+    /**
+     * Count a use of each command in \p command_string, ranking it higher in future
+     * matches.
+     *
+     * @details Words that do not resolve to an id in the index are ignored.
+     */
+    void record_use(std::string const &command_string);
+
+  private:
+    struct Node
+    {
+        std::string id;
+        std::string lowered_id;
+        std::size_t order; // Among siblings, in order of addition to the tree.
+        std::vector<std::size_t> children; // Indices into nodes_, sorted by lowered_id
+        std::optional<std::vector<std::string>> arguments; // Only set for Commands.
+        std::size_t uses = 0;
+    };
+
+    struct Match
+    {
+        std::size_t node;
+        bool is_prefix;
+    };
+
+    /**
+     * The last command in an input, split into the complete words and the word being
+     * typed.
+     */
+    struct Split
+    {
+        std::string_view complete;
+        std::string partial;
+    };
+
+    /**
+     * The node reached by the complete words of an input.
+     */
+    struct Resolved
+    {
+        std::string text;
+        std::optional<std::size_t> node; // std::nullopt if the words did not resolve.
+        std::size_t argument_count = 0;  // Words past a Command node.
+    };
+
+  private:
+    /**
+     * Split the last command in \p input, returns std::nullopt if it can't be parsed.
+     */
+    [[nodiscard]] auto split(std::string_view input) const -> std::optional<Split>;
+
+    /**
+     * Resolve the complete words of an input, reusing the previous result if the text
+     * is unchanged.
+     */
+    [[nodiscard]] auto resolve(std::string_view complete) -> Resolved const &;
+
+    [[nodiscard]] auto find_exact(std::size_t parent, std::string_view lowered_id) const
+        -> std::optional<std::size_t>;
+
+    [[nodiscard]] auto find_best(std::size_t parent, std::string_view lowered_id) const
+        -> std::optional<Match>;
+
+  private:
+    std::vector<Node> nodes_; // nodes_[0] is the root.
+    std::optional<Resolved> last_resolved_{std::nullopt};
+};
+
+} // namespace xen
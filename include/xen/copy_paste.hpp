@@ -1,6 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <optional>
+#include <thread>
+
+#include <juce_core/juce_core.h>
 
 #include <sequence/sequence.hpp>
 
@@ -8,20 +17,110 @@ namespace xen
 {
 
 /**
- * Write the Cell to the shared copy buffer file.
+ * The copy buffer shared by every plugin instance in the process, with a history of
+ * recent copies.
+ *
+ * @details Use through juce::SharedResourcePointer so instances share one Clipboard.
+ * Copies are held in memory, the most recent is also written to a file in the user
+ * library on a background thread. That file is polled for changes so copies made in
+ * other processes, or previous sessions, can be pasted here.
+ */
+class Clipboard
+{
+  public:
+    static constexpr auto history_size = std::size_t{16};
+    static constexpr auto poll_interval = std::chrono::milliseconds{1'000};
+
+  public:
+    /**
+     * Share the copy buffer file in the user library.
+     */
+    Clipboard();
+
+    /**
+     * @param filepath Returns the copy buffer file, called on the background thread.
+     * If it throws, there is no file to read or write and copies are only held in
+     * memory.
+     */
+    explicit Clipboard(std::function<juce::File()> filepath);
+
+    Clipboard(Clipboard const &) = delete;
+    Clipboard(Clipboard &&) = delete;
+    auto operator=(Clipboard const &) -> Clipboard & = delete;
+    auto operator=(Clipboard &&) -> Clipboard & = delete;
+
+    /**
+     * Finishes writing the most recent copy to file, then stops the background thread.
+     */
+    ~Clipboard();
+
+  public:
+    /**
+     * Add \p cell as the most recent copy, dropping the oldest if the history is full.
+     */
+    void write(sequence::Cell cell);
+
+    /**
+     * Return a copy from the history.
+     *
+     * @details The first call waits for the file to be read once, so a copy made
+     * before this process started can be pasted.
+     * @param age The number of copies made since, 0 is the most recent.
+     * @return The Cell, or std::nullopt if the history does not go back that far.
+     */
+    [[nodiscard]] auto read(std::size_t age = 0) -> std::optional<sequence::Cell>;
+
+  private:
+    void run();
+
+    /**
+     * Add the file contents to the history if another process has changed it.
+     */
+    void import_file_if_changed(std::unique_lock<std::mutex> &lock);
+
+    void write_file(std::unique_lock<std::mutex> &lock, sequence::Cell const &cell);
+
+  private:
+    struct FileStamp
+    {
+        juce::int64 modified = 0;
+        juce::int64 size = -1;
+
+        [[nodiscard]] auto operator==(FileStamp const &) const -> bool = default;
+    };
+
+    std::function<juce::File()> filepath_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    bool file_read_ = false;
+
+    std::deque<sequence::Cell> history_; // Most recent first.
+    std::optional<sequence::Cell> pending_write_{std::nullopt};
+    // Of the last file contents read or written here, only used on the background
+    // thread.
+    FileStamp known_stamp_;
+
+    std::thread thread_; // Last, so it starts after the members it uses.
+};
+
+/**
+ * Write the Cell to the shared copy buffer.
+ *
+ * @details This does not wait for the copy buffer file to be written.
  * @param cell The Cell to write to the copy buffer.
- * @throws std::runtime_error If the copy buffer file can't be opened or the file lock
- * can't be acquired.
  */
 void write_copy_buffer(sequence::Cell const &cell);
 
 /**
- * Read the Cell from the shared copy buffer file.
- * @return The Cell read from the copy buffer, or std::nullopt if the copy buffer file
- * does not exist.
- * @throws std::runtime_error If the copy buffer file can't be opened or the file lock
- * can't be acquired.
+ * Read a Cell from the shared copy buffer.
+ *
+ * @param age The number of copies made since, 0 is the most recent.
+ * @return The Cell read from the copy buffer, or std::nullopt if nothing has been
+ * copied.
  */
-[[nodiscard]] auto read_copy_buffer() -> std::optional<sequence::Cell>;
+[[nodiscard]] auto read_copy_buffer(std::size_t age = 0)
+    -> std::optional<sequence::Cell>;
 
-} // namespace xen
\ No newline at end of file
+} // namespace xen
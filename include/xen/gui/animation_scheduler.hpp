@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <xen/clock.hpp>
+#include <xen/double_buffer.hpp>
+#include <xen/state.hpp>
+
+namespace xen::gui
+{
+
+/**
+ * Calls registered components once per display refresh while they are animating.
+ *
+ * @details Frames come from a juce::VBlankAttachment on the host, so they follow the
+ * refresh rate of the display the editor is on. The attachment only exists while a
+ * client is animating and the host is showing, at other times there are no frames at
+ * all. While idle a slow timer compares the generation of the audio thread state, and
+ * restarts every client when it changes. Message thread only.
+ */
+class AnimationScheduler : private juce::Timer, private juce::AsyncUpdater
+{
+  public:
+    class Client
+    {
+      public:
+        virtual ~Client() = default;
+
+        /**
+         * Advance the animation to \p now.
+         *
+         * @param state The audio thread state, read once for each frame.
+         * @param now The time of this frame.
+         * @return True to be called again next frame, false to stop until restarted.
+         */
+        virtual auto animate(AudioThreadStateForGUI const &state, Clock::time_point now)
+            -> bool = 0;
+    };
+
+  public:
+    /**
+     * @param host Frames are synced to the display this component is on, and stop
+     * while it is not showing.
+     * @param audio_thread_state Owned by XenProcessor.
+     */
+    AnimationScheduler(juce::Component &host,
+                       DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state);
+
+    ~AnimationScheduler() override;
+
+    AnimationScheduler(AnimationScheduler const &) = delete;
+    auto operator=(AnimationScheduler const &) -> AnimationScheduler & = delete;
+
+  public:
+    /**
+     * Start \p client whenever the audio thread state changes, and on the next frame.
+     *
+     * @details \p client must be removed before it is destroyed.
+     */
+    void add(Client &client);
+
+    void remove(Client &client);
+
+    /**
+     * Call \p client every frame until its animate() returns false.
+     *
+     * @details \p client must have been added.
+     */
+    void start(Client &client);
+
+  private:
+    void timerCallback() override;
+
+    // Removes the VBlankAttachment, which can't be destroyed from its own callback.
+    void handleAsyncUpdate() override;
+
+    void on_frame();
+
+    /**
+     * Start every client if the audio thread state has changed since the last call.
+     */
+    void wake_if_changed(std::uint64_t generation);
+
+    void attach();
+
+    void detach();
+
+  private:
+    juce::Component &host_;
+    DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state_;
+
+    std::vector<Client *> clients_;
+    std::vector<Client *> animating_;
+    std::uint64_t generation_ = 0;
+
+    std::unique_ptr<juce::VBlankAttachment> vblank_;
+};
+
+} // namespace xen::gui
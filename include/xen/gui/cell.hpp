@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <juce_core/juce_core.h>
@@ -11,12 +12,16 @@
 #include <sequence/sequence.hpp>
 #include <sequence/tuning.hpp>
 
+#include <xen/gui/glyph_atlas.hpp>
 #include <xen/gui/homogenous_row.hpp>
+#include <xen/gui/staff.hpp>
 #include <xen/scale.hpp>
 
 namespace xen::gui
 {
 
+class BuildAndAllocateCell;
+
 class Cell : public juce::Component
 {
   public:
@@ -25,6 +30,11 @@ class Cell : public juce::Component
   public:
     virtual void make_selected();
 
+    /**
+     * Undo make_selected and emphasize_selection, repainting if either was set.
+     */
+    virtual void clear_selection();
+
     /**
      * Makes this cell visually distinct from the default selection.
      * @details Used to mark a Cell that is part of the current Pattern.
@@ -45,6 +55,24 @@ class Cell : public juce::Component
     [[nodiscard]] virtual auto find_child(std::vector<std::size_t> const &indices)
         -> Cell *;
 
+    /**
+     * Update this Cell in place to display \p next, reusing child Cells where possible.
+     *
+     * @details \p previous must be what this Cell currently displays, it is diffed with
+     * \p next so unchanged subtrees are skipped and only Cells that change are
+     * repainted. The weight of this Cell is left to the caller.
+     * @param build Holds the scale, tuning and pitch range to display, and creates any
+     * new Cells.
+     * @param restyle True if the scale, tuning, translate direction or pitch range has
+     * changed, so unchanged subtrees have to be visited too.
+     * @return False if \p next is a different kind of element, this Cell must then be
+     * replaced.
+     */
+    [[nodiscard]] virtual auto reconcile(sequence::Cell const &previous,
+                                         sequence::Cell const &next,
+                                         BuildAndAllocateCell const &build,
+                                         bool restyle) -> bool;
+
   public:
     void paintOverChildren(juce::Graphics &g) override;
 
@@ -62,6 +90,12 @@ class Rest : public Cell
                   sequence::Tuning const &tuning,
                   TranslateDirection scale_translate_direction);
 
+  public:
+    [[nodiscard]] auto reconcile(sequence::Cell const &previous,
+                                 sequence::Cell const &next,
+                                 BuildAndAllocateCell const &build, bool restyle)
+        -> bool override;
+
   public:
     void paint(juce::Graphics &g) override;
 
@@ -77,7 +111,14 @@ class Note : public Cell
 {
   public:
     Note(sequence::Note note, std::optional<Scale> const &scale,
-         sequence::Tuning const &tuning, TranslateDirection scale_translate_direction);
+         sequence::Tuning const &tuning, TranslateDirection scale_translate_direction,
+         PitchRange pitch_range);
+
+  public:
+    [[nodiscard]] auto reconcile(sequence::Cell const &previous,
+                                 sequence::Cell const &next,
+                                 BuildAndAllocateCell const &build, bool restyle)
+        -> bool override;
 
   public:
     void paint(juce::Graphics &g) override;
@@ -87,6 +128,8 @@ class Note : public Cell
     std::optional<Scale> scale_;
     sequence::Tuning tuning_;
     TranslateDirection scale_translate_direction_;
+    PitchRange pitch_range_;
+    juce::SharedResourcePointer<GlyphAtlas> glyph_atlas_;
 };
 
 // -------------------------------------------------------------------------------------
@@ -96,16 +139,30 @@ class Sequence : public Cell
   public:
     explicit Sequence(sequence::Sequence const &seq, std::optional<Scale> const &scale,
                       sequence::Tuning const &tuning,
-                      TranslateDirection scale_translate_direction);
+                      TranslateDirection scale_translate_direction,
+                      PitchRange pitch_range);
 
   public:
     void make_selected() override;
 
+    void clear_selection() override;
+
     void update_pattern(sequence::Pattern const &pattern) override;
 
     [[nodiscard]] auto find_child(std::vector<std::size_t> const &indices)
         -> Cell * override;
 
+    /**
+     * @details Children matching at the start and end of the Sequence are kept as they
+     * are, so inserting or erasing a Cell only touches the Cells around it. Children
+     * in between are reconciled by index, then the difference in length is inserted
+     * or erased.
+     */
+    [[nodiscard]] auto reconcile(sequence::Cell const &previous,
+                                 sequence::Cell const &next,
+                                 BuildAndAllocateCell const &build, bool restyle)
+        -> bool override;
+
   public:
     void resized() override;
 
@@ -120,7 +177,8 @@ class BuildAndAllocateCell
   public:
     BuildAndAllocateCell(std::optional<Scale> const &scale,
                          sequence::Tuning const &tuning,
-                         TranslateDirection scale_translate_direction);
+                         TranslateDirection scale_translate_direction,
+                         PitchRange pitch_range);
 
   public:
     [[nodiscard]] auto operator()(sequence::Rest r) const -> std::unique_ptr<Cell>;
@@ -129,10 +187,31 @@ class BuildAndAllocateCell
 
     [[nodiscard]] auto operator()(sequence::Sequence s) const -> std::unique_ptr<Cell>;
 
+    [[nodiscard]] auto scale() const -> std::optional<Scale> const &
+    {
+        return scale_;
+    }
+
+    [[nodiscard]] auto tuning() const -> sequence::Tuning const &
+    {
+        return tuning_;
+    }
+
+    [[nodiscard]] auto scale_translate_direction() const -> TranslateDirection
+    {
+        return scale_translate_direction_;
+    }
+
+    [[nodiscard]] auto pitch_range() const -> PitchRange
+    {
+        return pitch_range_;
+    }
+
   private:
     std::optional<Scale> scale_;
     sequence::Tuning tuning_;
     TranslateDirection scale_translate_direction_;
+    PitchRange pitch_range_;
 };
 
 // -------------------------------------------------------------------------------------
@@ -141,15 +220,20 @@ class BuildAndAllocateCell
  * Computes the Rectangle bounds for a given note.
  *
  * @details this takes into consideration the pitch (and tuning length), delay and gate.
+ * Notes are at least two pixels tall, even if their row is thinner.
  * @param bounds The bounds of the component in which the note will be displayed.
  * @param note The note.
  * @param tuning_length The number of pitches in the tuning.
- * @return The Rectangle that represents the position and size of the note.
+ * @param pitch_range The pitches displayed within \p bounds.
+ * @return The Rectangle that represents the position and size of the note. If the
+ * pitch is outside of \p pitch_range this has zero height, on the top edge of \p bounds
+ * if the pitch is above the range and on the bottom edge if it is below.
  * @exception std::invalid_argument If tuning_length is zero, to prevent division by
  * zero.
  */
 [[nodiscard]]
 auto compute_note_bounds(juce::Rectangle<int> const &bounds, sequence::Note note,
-                         std::size_t tuning_length) -> juce::Rectangle<int>;
+                         std::size_t tuning_length, PitchRange pitch_range)
+    -> juce::Rectangle<int>;
 
 } // namespace xen::gui
\ No newline at end of file
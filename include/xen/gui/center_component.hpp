@@ -16,14 +16,15 @@
 #include <signals_light/signal.hpp>
 
 #include <xen/clock.hpp>
-#include <xen/double_buffer.hpp>
 #include <xen/gui/accordion.hpp>
+#include <xen/gui/animation_scheduler.hpp>
 #include <xen/gui/bg_sequence.hpp>
 #include <xen/gui/cell.hpp>
 #include <xen/gui/library_view.hpp>
 #include <xen/gui/message_log.hpp>
 #include <xen/gui/modulation_pane.hpp>
 #include <xen/gui/sequence_bank.hpp>
+#include <xen/gui/staff.hpp>
 #include <xen/gui/tuning_reference.hpp>
 #include <xen/scale.hpp>
 #include <xen/state.hpp>
@@ -122,28 +123,64 @@ class MeasureInfo : public juce::Component
 // -------------------------------------------------------------------------------------
 
 /**
- * Vertical column to display pitch numbers, [0, size) bottom to top, evenly spaced.
+ * Vertical column to display the pitch numbers of a PitchRange, bottom to top, lined up
+ * with the rows of the staff.
+ *
+ * @details If rows are too thin to label each one, only every 2nd, 5th, 10th, 20th...
+ * pitch is labeled. Labels are drawn into an image that is reused until the range, size
+ * or colors change.
  */
 class PitchColumn : public juce::Component
 {
   public:
-    PitchColumn(std::size_t size);
+    explicit PitchColumn(PitchRange range);
 
   public:
-    void update(std::size_t new_size);
+    void update(PitchRange range);
 
     void paint(juce::Graphics &g) override;
 
   private:
-    std::size_t size_;
+    void paint_labels(juce::Graphics &g) const;
+
+  private:
+    PitchRange range_;
+
+    struct LabelsKey
+    {
+        int width;
+        int height;
+        float pixel_scale;
+        PitchRange range;
+        juce::uint32 background_color;
+        juce::uint32 text_color;
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+#endif
+        auto operator==(LabelsKey const &) const -> bool = default;
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+    };
+
+    juce::Image labels_image_;
+    std::optional<LabelsKey> labels_key_;
 };
 
 // -------------------------------------------------------------------------------------
 
 /**
  * Draws playhead and owns the gui::Cell object.
+ *
+ * @details The staff is drawn into an image that is only redrawn when its key changes,
+ * the background sequences and their trigger lines move every frame and are drawn over
+ * it. The playhead is drawn over the children, and moving it only repaints the columns
+ * it left and entered. Frames are only requested while a trigger is active or the
+ * background state has to be redrawn.
  */
-class MeasureView : public juce::Component, juce::Timer
+class MeasureView : public juce::Component, AnimationScheduler::Client
 {
   public:
     struct BGCurrentState
@@ -153,7 +190,7 @@ class MeasureView : public juce::Component, juce::Timer
     };
 
   public:
-    MeasureView(DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state);
+    explicit MeasureView(AnimationScheduler &scheduler);
 
     ~MeasureView() override;
 
@@ -164,6 +201,19 @@ class MeasureView : public juce::Component, juce::Timer
 
     void update(SequencerState const &state, AuxState const &aux);
 
+    /**
+     * Display only the pitches in \p range, the whole tuning if it is empty.
+     */
+    void set_pitch_range(PitchRange range);
+
+    /**
+     * Display the selected Cell as \p modify returns it, without changing any state.
+     *
+     * @details Only the Cells that differ from what is displayed are repainted. The
+     * next update() replaces the preview with the given state.
+     */
+    void preview(ModulationPane::Preview const &modify);
+
     /**
      * \p percent must be in range [0, 1).
      */
@@ -181,14 +231,64 @@ class MeasureView : public juce::Component, juce::Timer
 
     void paintOverChildren(juce::Graphics &g) override;
 
-    void timerCallback() override;
+    auto animate(AudioThreadStateForGUI const &state, Clock::time_point now)
+        -> bool override;
+
+  private:
+    /**
+     * Paint the staff, the cached image is drawn from this.
+     */
+    void paint_staff(juce::Graphics &g) const;
+
+    /**
+     * Paint the windowed background sequences and their trigger lines.
+     */
+    void paint_bg_sequences(juce::Graphics &g) const;
+
+    /**
+     * Return the x coordinate of the playhead at \p percent of the measure.
+     */
+    [[nodiscard]] auto playhead_x(float percent) const -> float;
+
+    /**
+     * Return the area a playhead at \p percent paints into, including antialiasing.
+     */
+    [[nodiscard]] auto playhead_column(float percent) const -> juce::Rectangle<int>;
 
   private:
     std::unique_ptr<Cell> cell_ptr_; // Never Null
     std::optional<float> playhead_ = std::nullopt;
+    PitchRange pitch_range_{};
+
+    // The measure displayed by the last preview(), if any since update().
+    std::optional<sequence::Cell> preview_;
+
+    // Everything the cached staff image depends on.
+    struct StaffKey
+    {
+        int width;
+        int height;
+        float pixel_scale;
+        std::size_t tuning_length;
+        std::optional<Scale> scale;
+        TranslateDirection scale_translate_direction;
+        PitchRange pitch_range;
+        juce::uint32 staff_color;
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+#endif
+        auto operator==(StaffKey const &) const -> bool = default;
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+    };
+
+    juce::Image staff_image_;
+    std::optional<StaffKey> staff_key_;
 
-    // Owned by XenProcessor
-    DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state_;
+    AnimationScheduler &scheduler_;
 
     SequencerState sequencer_state_ = {.tuning_name = "repaint"}; // Force init paint.
     SelectedState selected_state_{};
@@ -196,6 +296,10 @@ class MeasureView : public juce::Component, juce::Timer
     // BG Rendering
     std::array<std::optional<BGCurrentState>, 16> bg_current_;
 
+    // The generate_ir result of each measure, reset by update() when the measure
+    // (including its time signature) or the tuning changes. Frames only window it.
+    std::array<std::optional<IR>, 16> bg_ir_cache_;
+
     struct BGPreviousState
     {
         sequence::Tuning tuning;
@@ -216,7 +320,7 @@ class SequenceView : public juce::Component
     sl::Signal<void(std::string const &)> on_command;
 
   public:
-    SequenceView(DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state);
+    explicit SequenceView(AnimationScheduler &scheduler);
 
   public:
     void update(SequencerState const &state, AuxState const &aux);
@@ -226,6 +330,19 @@ class SequenceView : public juce::Component
 
     void paintOverChildren(juce::Graphics &g) override;
 
+    /**
+     * Over the staff, scroll the displayed pitches or, with ctrl/cmd held, zoom in or
+     * out around the pitch under the mouse.
+     */
+    void mouseWheelMove(juce::MouseEvent const &event,
+                        juce::MouseWheelDetails const &wheel) override;
+
+  private:
+    /**
+     * Display \p range on the staff, after fitting it to the current tuning.
+     */
+    void set_pitch_range(PitchRange range);
+
   public:
     MeasureInfo measure_info;
     PitchColumn pitch_column;
@@ -233,8 +350,12 @@ class SequenceView : public juce::Component
     std::unique_ptr<TuningReference> tuning_reference_ptr{nullptr};
     HAccordion<SequenceBankGrid> sequence_bank_accordion{"Sequence Bank"};
     SequenceBankGrid &sequence_bank = sequence_bank_accordion.child;
-    HAccordion<ModulationPane> modulation_pane_accordion{"Modulation"};
+    HAccordion<ModulationPane> modulation_pane_accordion;
     ModulationPane &modulation_pane = modulation_pane_accordion.child;
+
+  private:
+    std::size_t tuning_length_ = 0;
+    PitchRange pitch_range_{};
 };
 
 // -------------------------------------------------------------------------------------
@@ -249,7 +370,7 @@ class CenterComponent : public juce::Component
   public:
     CenterComponent(juce::File const &sequence_library_dir,
                     juce::File const &tuning_library_dir,
-                    DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state);
+                    AnimationScheduler &scheduler);
 
   public:
     void show_sequence_view();
@@ -49,8 +49,14 @@ class CommandBar : public juce::Component
 {
   public:
     sl::Signal<void(std::string const &)> on_command;
+
+    // Emitted with each command the user enters, before it is sent with on_command.
+    sl::Signal<void(std::string const &)> on_command_entered;
+
     sl::Signal<std::string(std::string const &)> on_guide_text_request;
-    sl::Signal<std::string(std::string const &)> on_complete_id_request;
+
+    // Returns the input with its last word completed, or an empty string if none.
+    sl::Signal<std::string(std::string const &)> on_complete_request;
     sl::Signal<void(sequence::Pattern const &)> on_pattern_update;
 
   public:
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <optional>
+#include <string>
+#include <vector>
 
 #include <juce_core/juce_core.h>
 #include <juce_gui_basics/juce_gui_basics.h>
@@ -9,6 +12,7 @@
 #include <signals_light/signal.hpp>
 
 #include <xen/gui/xen_list_box.hpp>
+#include <xen/library_index.hpp>
 
 namespace xen::gui
 {
@@ -35,14 +39,38 @@ class DirectoryListBox : public XenListBox, public juce::ChangeListener
 
     void item_selected(std::size_t index) override;
 
+    /**
+     * Show the indexed files that match \p query in place of the directory contents.
+     *
+     * @details An empty query shows the directory again. Results are refreshed each
+     * time the LibraryIndex changes. See LibrarySearch::search for the query syntax,
+     * an invalid query shows no files.
+     */
+    void set_filter(std::string query);
+
   protected:
     /**
      * Retrieve a file if it exists. Index of 0 will return nullopt, that is parent dir.
-     * @details Returns nullopt for directories.
+     * @details Returns nullopt for directories. While filtered there is no parent dir
+     * row, indices are into the search results.
      */
     [[nodiscard]] auto get_file(std::size_t index) -> std::optional<juce::File>;
 
+    /**
+     * Retrieve the LibraryIndex entry for a row, without accessing the file.
+     * @details Returns nullptr for the parent dir, directories, and files that have not
+     * been indexed yet.
+     */
+    [[nodiscard]] auto get_entry(std::size_t index) const
+        -> std::shared_ptr<LibraryEntry const>;
+
+  private:
+    void update_filter_results();
+
   private:
+    juce::SharedResourcePointer<LibraryIndex> library_index_;
+    std::string filter_;
+    std::vector<std::shared_ptr<LibraryEntry const>> filter_results_;
     juce::TimeSliceThread dcl_thread_{"DirectoryListBoxThread"};
     juce::WildcardFileFilter file_filter_;
     juce::DirectoryContentsList directory_contents_list_{&file_filter_, dcl_thread_};
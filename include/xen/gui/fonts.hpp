@@ -2,85 +2,49 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 
-#include <embed_fonts.hpp>
-
 namespace xen::gui::fonts
 {
 
 /**
- * Take embedded binary data and create a juce::Font.
+ * Each weight's typeface is created from the embedded font data on first use, so only
+ * the weights that are actually drawn with are loaded.
  */
-[[nodiscard]] inline auto binary_to_font(char const *data, int size) -> juce::Font
+struct SourceCodePro
 {
+    [[nodiscard]] auto extra_light() const -> juce::Font const &;
+    [[nodiscard]] auto light() const -> juce::Font const &;
+    [[nodiscard]] auto regular() const -> juce::Font const &;
+    [[nodiscard]] auto medium() const -> juce::Font const &;
+    [[nodiscard]] auto semi_bold() const -> juce::Font const &;
+    [[nodiscard]] auto bold() const -> juce::Font const &;
+    [[nodiscard]] auto extra_bold() const -> juce::Font const &;
+    [[nodiscard]] auto black() const -> juce::Font const &;
+};
 
-    return juce::Font{
-        juce::FontOptions{
-            juce::Typeface::createSystemTypefaceFor(data, (std::size_t)size),
-        },
-    };
-}
+/**
+ * Loaded lazily by weight, as with SourceCodePro.
+ */
+struct RobotoMono
+{
+    [[nodiscard]] auto thin() const -> juce::Font const &;
+    [[nodiscard]] auto extra_light() const -> juce::Font const &;
+    [[nodiscard]] auto light() const -> juce::Font const &;
+    [[nodiscard]] auto regular() const -> juce::Font const &;
+    [[nodiscard]] auto medium() const -> juce::Font const &;
+    [[nodiscard]] auto semi_bold() const -> juce::Font const &;
+    [[nodiscard]] auto bold() const -> juce::Font const &;
+};
 
-[[nodiscard]] inline auto source_code_pro() -> auto const &
+[[nodiscard]] inline auto source_code_pro() -> SourceCodePro const &
 {
-    static const struct
-    {
-        juce::Font extra_light;
-        juce::Font light;
-        juce::Font regular;
-        juce::Font medium;
-        juce::Font semi_bold;
-        juce::Font bold;
-        juce::Font extra_bold;
-        juce::Font black;
-    } font{
-        .extra_light = binary_to_font(embed_fonts::SourceCodeProExtraLight_ttf,
-                                      embed_fonts::SourceCodeProExtraLight_ttfSize),
-        .light = binary_to_font(embed_fonts::SourceCodeProLight_ttf,
-                                embed_fonts::SourceCodeProLight_ttfSize),
-        .regular = binary_to_font(embed_fonts::SourceCodeProRegular_ttf,
-                                  embed_fonts::SourceCodeProRegular_ttfSize),
-        .medium = binary_to_font(embed_fonts::SourceCodeProMedium_ttf,
-                                 embed_fonts::SourceCodeProMedium_ttfSize),
-        .semi_bold = binary_to_font(embed_fonts::SourceCodeProSemiBold_ttf,
-                                    embed_fonts::SourceCodeProSemiBold_ttfSize),
-        .bold = binary_to_font(embed_fonts::SourceCodeProBold_ttf,
-                               embed_fonts::SourceCodeProBold_ttfSize),
-        .extra_bold = binary_to_font(embed_fonts::SourceCodeProExtraBold_ttf,
-                                     embed_fonts::SourceCodeProExtraBold_ttfSize),
-        .black = binary_to_font(embed_fonts::SourceCodeProBlack_ttf,
-                                embed_fonts::SourceCodeProBlack_ttfSize),
-    };
-    return font;
+    static constexpr auto family = SourceCodePro{};
+    return family;
 }
 
-[[nodiscard]] inline auto roboto_mono() -> auto const &
+[[nodiscard]] inline auto roboto_mono() -> RobotoMono const &
 {
-    static const struct
-    {
-        juce::Font thin;
-        juce::Font extra_light;
-        juce::Font light;
-        juce::Font regular;
-        juce::Font medium;
-        juce::Font semi_bold;
-        juce::Font bold;
-    } font{
-        .thin = binary_to_font(embed_fonts::RobotoMonoThin_ttf,
-                               embed_fonts::RobotoMonoThin_ttfSize),
-        .extra_light = binary_to_font(embed_fonts::RobotoMonoExtraLight_ttf,
-                                      embed_fonts::RobotoMonoExtraLight_ttfSize),
-        .light = binary_to_font(embed_fonts::RobotoMonoLight_ttf,
-                                embed_fonts::RobotoMonoLight_ttfSize),
-        .regular = binary_to_font(embed_fonts::RobotoMonoRegular_ttf,
-                                  embed_fonts::RobotoMonoRegular_ttfSize),
-        .medium = binary_to_font(embed_fonts::RobotoMonoMedium_ttf,
-                                 embed_fonts::RobotoMonoMedium_ttfSize),
-        .semi_bold = binary_to_font(embed_fonts::RobotoMonoSemiBold_ttf,
-                                    embed_fonts::RobotoMonoSemiBold_ttfSize),
-        .bold = binary_to_font(embed_fonts::RobotoMonoBold_ttf,
-                               embed_fonts::RobotoMonoBold_ttfSize),
-    };
-    return font;
+    static constexpr auto family = RobotoMono{};
+    return family;
 }
 
 [[nodiscard]] inline auto monospaced() -> auto const &
@@ -89,12 +53,15 @@ namespace xen::gui::fonts
     return roboto_mono();
 }
 
-[[nodiscard]] inline auto symbols() -> juce::Font const &
-{
-    static auto const font =
-        binary_to_font(embed_fonts::NotoSansSymbols2Regular_ttf,
-                       embed_fonts::NotoSansSymbols2Regular_ttfSize);
-    return font;
-}
+[[nodiscard]] auto symbols() -> juce::Font const &;
+
+/**
+ * Return the width of \p text laid out on a single line in \p font.
+ *
+ * @details Results are cached by font and text, so repeated layouts of the same labels
+ * do not shape the text again. Message thread only.
+ */
+[[nodiscard]] auto text_width(juce::Font const &font, juce::String const &text)
+    -> float;
 
-} // namespace xen::gui::fonts
\ No newline at end of file
+} // namespace xen::gui::fonts
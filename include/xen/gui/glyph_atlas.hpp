@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <string_view>
+#include <utility>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+namespace xen::gui
+{
+
+/**
+ * Pre-rendered glyphs of the bold monospaced font, for the short numeric labels drawn
+ * on every Cell.
+ *
+ * @details Use through juce::SharedResourcePointer so every Cell shares one atlas. The
+ * atlas characters are rendered once per font height and display scale into a single
+ * channel image, then each label is drawn by copying glyphs out of it filled with the
+ * current colour, rather than shaping and rasterizing the text again. Message thread
+ * only.
+ */
+class GlyphAtlas
+{
+  public:
+    static constexpr auto characters = std::string_view{"+-0123456789"};
+
+    // Larger labels are rare and would make for large pages, they are drawn directly.
+    static constexpr auto max_font_height = 64;
+
+    static constexpr auto max_pages = std::size_t{16};
+
+  public:
+    /**
+     * Draw \p text centred in \p area, with the current colour.
+     *
+     * @details Text with characters outside of the atlas, or taller than
+     * max_font_height, is drawn with juce::Graphics::drawText instead.
+     */
+    void draw(juce::Graphics &g, juce::String const &text, int font_height,
+              juce::Rectangle<float> area);
+
+  private:
+    struct Page
+    {
+        juce::Image image;
+        std::array<juce::Image, characters.size()> glyphs; // Clipped from image.
+        float advance;                                     // Logical pixels.
+    };
+
+    [[nodiscard]] auto page(int font_height, float pixel_scale) -> Page const &;
+
+  private:
+    std::map<std::pair<int, float>, Page> pages_;
+};
+
+} // namespace xen::gui
@@ -221,6 +221,14 @@ class HomogenousRow : public juce::Component
         return *(children_[index]);
     }
 
+    /**
+     * Lay out the children again, after any of their weights have changed.
+     */
+    void update_layout()
+    {
+        this->resized();
+    }
+
   public:
     /**
      * @return The number of children in the row.
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <map>
 #include <string>
 #include <vector>
 
@@ -18,6 +17,24 @@
 namespace xen::gui
 {
 
+/**
+ * Lists sequence bank files, with a preview of each measure drawn from the
+ * LibraryIndex.
+ */
+class SequencesList : public DirectoryListBox
+{
+  public:
+    explicit SequencesList(juce::File const &sequences_dir);
+
+  public:
+    void paintListBoxItem(int row_number, juce::Graphics &g, int width, int height,
+                          bool row_is_selected) override;
+
+    auto getTooltipForRow(int row) -> juce::String override;
+};
+
+// -------------------------------------------------------------------------------------
+
 class TuningsList : public DirectoryListBox
 {
   public:
@@ -25,10 +42,6 @@ class TuningsList : public DirectoryListBox
 
   public:
     auto getTooltipForRow(int row) -> juce::String override;
-
-  private:
-    // {filename 32bit hash, tooltip string}
-    std::map<juce::int32, juce::String> tooltip_cache_;
 };
 
 // -------------------------------------------------------------------------------------
@@ -75,7 +88,7 @@ class LabeledLibraryComponent : public juce::Component
         this->addAndMakeVisible(label);
         this->addAndMakeVisible(component);
         label.setText(std::move(label_text), juce::dontSendNotification);
-        label.setFont(fonts::monospaced().bold.withHeight(18.f));
+        label.setFont(fonts::monospaced().bold().withHeight(18.f));
     }
 
   public:
@@ -107,8 +120,10 @@ class LibraryView : public juce::Component
     };
 
   public:
-    LabeledLibraryComponent<DirectoryListBox> sequences;
-    DirectoryListBox &sequences_list = sequences.component;
+    juce::TextEditor filter_box;
+
+    LabeledLibraryComponent<SequencesList> sequences;
+    SequencesList &sequences_list = sequences.component;
     Divider divider_1;
 
     LabeledLibraryComponent<TuningsList> tunings;
@@ -122,8 +137,17 @@ class LibraryView : public juce::Component
     LibraryView(juce::File const &sequence_library_dir,
                 juce::File const &tuning_library_dir);
 
+  public:
+    /**
+     * Show only the sequence banks and tunings matching \p query, see
+     * LibrarySearch::search. An empty query shows the directories again.
+     */
+    void set_filter(std::string const &query);
+
   public:
     void resized() override;
+
+    void lookAndFeelChanged() override;
 };
 
 } // namespace xen::gui
\ No newline at end of file
@@ -1,11 +1,16 @@
 #pragma once
 
-#include <cassert>
 #include <cstddef>
-#include <sstream>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include <xen/gui/xen_list_box.hpp>
@@ -14,13 +19,35 @@
 namespace xen::gui
 {
 
-class MessageLog : public XenListBox
+/**
+ * Displays the status messages of every command run in this editor.
+ *
+ * @details Holds the most recent `capacity` messages, older ones are dropped. Messages
+ * are stored as they are given and only formatted as rows when painted. Repeated text
+ * is stored once. The list is updated once for all messages added before the message
+ * loop next runs, so a long chain of commands does not relayout for each.
+ */
+class MessageLog : public XenListBox, private juce::AsyncUpdater
 {
+  public:
+    static constexpr auto capacity = std::size_t{4'096};
+
   public:
     MessageLog();
 
   public:
-    void add_message(juce::String const &text, ::xen::MessageLevel level);
+    void add_message(std::string_view text, ::xen::MessageLevel level);
+
+    /**
+     * Only display messages at \p level or above, the messages below are kept.
+     */
+    void set_level_filter(::xen::MessageLevel level);
+
+    /**
+     * Return every message held, whatever the level filter, oldest first and one per
+     * line.
+     */
+    [[nodiscard]] auto to_text() const -> std::string;
 
     /**
      * Gets the total number of rows (messages) in the log.
@@ -38,7 +65,34 @@ class MessageLog : public XenListBox
     void item_selected(std::size_t index) override;
 
   private:
-    std::vector<juce::String> messages_;
+    void handleAsyncUpdate() override;
+
+    struct Entry
+    {
+        juce::int64 time; // Milliseconds since the Unix epoch.
+        ::xen::MessageLevel level;
+        std::shared_ptr<std::string const> text;
+    };
+
+    /**
+     * Return the stored copy of \p text, adding it if there is none.
+     */
+    [[nodiscard]] auto intern(std::string_view text)
+        -> std::shared_ptr<std::string const>;
+
+    [[nodiscard]] auto entry(std::uint64_t id) const -> Entry const &;
+
+  private:
+    // Ring buffer, the message with id n is at n % capacity.
+    std::vector<Entry> entries_;
+    std::uint64_t next_id_ = 0;
+
+    // Ids of the held messages that pass the level filter, oldest first.
+    std::deque<std::uint64_t> visible_;
+    ::xen::MessageLevel level_filter_ = ::xen::MessageLevel::Debug;
+
+    // Keys view the mapped string. Entries no longer in the ring are pruned.
+    std::unordered_map<std::string_view, std::shared_ptr<std::string const>> interned_;
 };
 
-} // namespace xen::gui
\ No newline at end of file
+} // namespace xen::gui
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <cstddef>
+#include <functional>
 #include <optional>
 #include <string>
 #include <utility>
@@ -11,10 +13,16 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 
+#include <sequence/sequence.hpp>
+
 #include <signals_light/signal.hpp>
 
+#include <xen/clock.hpp>
+#include <xen/gui/animation_scheduler.hpp>
 #include <xen/gui/sequence_bank.hpp>
 #include <xen/gui/xen_slider.hpp>
+#include <xen/modulator.hpp>
+#include <xen/state.hpp>
 
 namespace xen::gui
 {
@@ -53,6 +61,12 @@ class ModulationParameters : public juce::Component
     [[nodiscard]]
     auto get_json() -> nlohmann::json;
 
+    /**
+     * The slider values, in the order of the Modulator::Instruction args.
+     */
+    [[nodiscard]]
+    auto get_args() const -> std::array<float, 4>;
+
     /**
      * Return true if the mod_type is empty.
      */
@@ -67,17 +81,36 @@ class ModulationParameters : public juce::Component
     std::vector<std::unique_ptr<XenSlider>> sliders_;
 };
 
-class ModulationPane : public juce::Component
+/**
+ * Edits a modulator applied to the weights, velocities, delays or gates of the
+ * selected Cell.
+ *
+ * @details While a slider is dragged, the modulated Cell is sent through on_preview at
+ * most once per frame and the state is left alone. The command is only sent through
+ * on_change when the slider is released, or a dropdown changes. The previewed Modulator
+ * is compiled once per modulator selection, a slider change only updates its args.
+ */
+class ModulationPane : public juce::Component, AnimationScheduler::Client
 {
+  public:
+    /// Returns the selected Cell with the modulator applied.
+    using Preview = std::function<sequence::Cell(sequence::Cell const &)>;
+
   public:
     sl::Signal<void(std::string const &)> on_change; // Emits command string
+    sl::Signal<void(Preview const &)> on_preview;
 
   public:
-    ModulationPane();
+    explicit ModulationPane(AnimationScheduler &scheduler);
+
+    ~ModulationPane() override;
 
   public:
     void resized() override;
 
+    auto animate(AudioThreadStateForGUI const &state, Clock::time_point now)
+        -> bool override;
+
   private:
     juce::ComboBox target_command_dropdown_;
     juce::ComboBox modulator_dropdown_;
@@ -85,12 +118,41 @@ class ModulationPane : public juce::Component
     std::size_t current_selection_{0};
     ModulationButtons buttons_;
 
+    AnimationScheduler &scheduler_;
+    bool preview_pending_ = false;
+
+    // Null until the first preview after a modulator is selected.
+    std::optional<Modulator> preview_modulator_{std::nullopt};
+
+    // The instruction each non-empty parameter UI compiles to in preview_modulator_.
+    std::array<std::size_t, 16> instruction_indices_{};
+
+    // The parameter UIs with sliders moved since the last preview.
+    std::bitset<16> changed_parameters_{};
+
   private:
     [[nodiscard]]
-    auto generate_json() -> std::string;
+    auto generate_json() -> nlohmann::json;
 
     [[nodiscard]]
     auto generate_command_string(bool commit) -> std::string;
+
+    /**
+     * Compile preview_modulator_ from the current modulators, and find the instruction
+     * each parameter UI compiles to.
+     *
+     * @throws std::invalid_argument If a modulator parameter is invalid.
+     */
+    void compile_preview_modulator();
+
+    /**
+     * Return the Preview for the current sliders, or std::nullopt if there is nothing
+     * to apply.
+     *
+     * @throws std::invalid_argument If a modulator parameter is invalid.
+     */
+    [[nodiscard]]
+    auto generate_preview() -> std::optional<Preview>;
 };
 
 } // namespace xen::gui
\ No newline at end of file
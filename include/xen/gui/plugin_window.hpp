@@ -6,6 +6,7 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include <xen/double_buffer.hpp>
+#include <xen/gui/animation_scheduler.hpp>
 #include <xen/gui/bottom_bar.hpp>
 #include <xen/gui/center_component.hpp>
 
@@ -27,6 +28,8 @@ namespace xen::gui
 class PluginWindow : public juce::Component
 {
   public:
+    // Declared first, the components below register with it.
+    AnimationScheduler animation_scheduler;
     CenterComponent center_component;
     BottomBar bottom_bar;
 
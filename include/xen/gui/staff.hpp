@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include <juce_graphics/juce_graphics.h>
+
+#include <xen/scale.hpp>
+
+namespace xen::gui
+{
+
+/**
+ * The normalized pitches displayed on the staff, [first, first + count).
+ *
+ * @details A count of zero displays every pitch of the tuning.
+ */
+struct PitchRange
+{
+    std::size_t first = 0;
+    std::size_t count = 0;
+
+    auto operator==(PitchRange const &) const -> bool = default;
+};
+
+/**
+ * Return \p range shrunk and moved to fit within a tuning of \p tuning_length pitches.
+ */
+[[nodiscard]] auto clamp_pitch_range(PitchRange range, std::size_t tuning_length)
+    -> PitchRange;
+
+/**
+ * Return the vertical span of \p pitch's row, or std::nullopt if it is outside of
+ * \p range.
+ *
+ * @details Rows are spread evenly over \p bounds with the highest pitch at the top,
+ * leftover pixels go one each to the top rows.
+ * @param range Must not be empty, see clamp_pitch_range.
+ */
+[[nodiscard]] auto pitch_row(juce::Rectangle<int> const &bounds, PitchRange range,
+                             std::size_t pitch) -> std::optional<juce::Range<int>>;
+
+/**
+ * Return the pitch whose row contains \p y, or the nearest one if \p y is outside of
+ * \p bounds.
+ *
+ * @param range Must not be empty, see clamp_pitch_range.
+ */
+[[nodiscard]] auto pitch_at(juce::Rectangle<int> const &bounds, PitchRange range, int y)
+    -> std::size_t;
+
+/**
+ * Fill the rows of \p range, alternating colors between scale degrees.
+ *
+ * @details Rows at least three pixels tall are separated by a one pixel gap. Thinner
+ * rows are not, neighbouring rows of the same color are filled as one band and bands
+ * under two pixels tall are left out, so the number of fills is bounded by the height
+ * of \p bounds rather than the size of the tuning.
+ */
+void draw_staff(juce::Graphics &g, juce::Rectangle<int> bounds,
+                juce::Colour lighter_color, std::optional<Scale> const &scale,
+                std::size_t tuning_length, TranslateDirection scale_translate_direction,
+                PitchRange range);
+
+} // namespace xen::gui
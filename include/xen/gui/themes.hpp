@@ -27,6 +27,8 @@ struct Theme
     std::uint32_t bg_med;
     std::uint32_t bg_low;
     std::uint32_t bg_inv;
+
+    auto operator==(Theme const &) const -> bool = default;
 };
 
 struct ColorID
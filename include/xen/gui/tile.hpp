@@ -41,7 +41,7 @@ class Tile : public juce::Component
   public:
     int background_color_id = ColorID::Background;
     int text_color_id = ColorID::ForegroundMedium;
-    juce::Font font = fonts::monospaced().bold;
+    juce::Font font = fonts::monospaced().bold();
 
   private:
     std::string display_;
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstddef>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <juce_core/juce_core.h>
@@ -10,7 +13,9 @@
 
 #include <signals_light/signal.hpp>
 
+#include <xen/command.hpp>
 #include <xen/input_mode.hpp>
+#include <xen/shared_resources.hpp>
 #include <xen/state.hpp>
 
 namespace juce
@@ -38,46 +43,102 @@ struct KeyConfig
     std::string command;
 };
 
+/**
+ * A key binding's command string, prepared once when the key config is loaded.
+ *
+ * @details Each ';' separated command is normalized and split ahead of time. Words
+ * that contain a `:N=default:` placeholder are stored as pieces around the placeholder
+ * so that only the numeric prefix needs to be substituted when the key is pressed.
+ */
+class KeyBinding
+{
+  public:
+    /**
+     * Prepare a command string for repeated execution.
+     *
+     * @param command_string The command string from the key config file.
+     * @throws std::invalid_argument If the command string cannot be split, or if a
+     * `:N=default:` placeholder is not within a command argument.
+     */
+    explicit KeyBinding(std::string const &command_string);
+
+  public:
+    /**
+     * Generate the commands to execute for the given numeric prefix.
+     *
+     * @param prefix The number typed before the keypress, if any. If not given, the
+     * default value of the first placeholder is used.
+     * @return std::vector<PreparedCommand> The commands, ready to execute.
+     */
+    [[nodiscard]] auto commands(std::optional<int> prefix) const
+        -> std::vector<PreparedCommand>;
+
+  private:
+    struct PrefixSlot
+    {
+        std::size_t command_index;
+        std::optional<std::size_t> word_index; // nullopt targets PreparedCommand::text
+        std::vector<std::string> pieces;       // Placeholder goes between each piece.
+    };
+
+    std::vector<PreparedCommand> default_commands_;
+    std::vector<PrefixSlot> prefix_slots_;
+};
+
+/**
+ * Hash for juce::KeyPress that is consistent with juce::KeyPress::operator==.
+ */
+struct KeyPressHash
+{
+    [[nodiscard]] auto operator()(juce::KeyPress const &key) const -> std::size_t;
+};
+
 class KeyCore
 {
   public:
     /**
      * Constructs a new KeyCore object.
      *
+     * @details Every command string is prepared here, so invalid commands are reported
+     * when the key config is loaded rather than when a key is pressed. A binding with
+     * an invalid command is skipped and listed in skipped(), the others are still
+     * bound.
      * @param configs A vector of KeyConfig objects to initialize the KeyCore.
      */
     explicit KeyCore(std::vector<KeyConfig> const &configs);
 
   public:
     /**
-     * Finds an associated command.
+     * Finds an associated key binding.
      *
+     * @details Mode-sensitive bindings take precedence over mode-independent bindings.
      * @param key The juce::KeyPress to search for.
      * @param mode The current InputMode.
-     * @return An optional string, which contains the associated command if the search
-     * is successful.
+     * @return A pointer to the associated KeyBinding, or nullptr if there is none.
+     */
+    [[nodiscard]] auto find_action(juce::KeyPress const &key, InputMode mode) const
+        -> KeyBinding const *;
+
+    /**
+     * Return a message for each binding that was skipped, naming its key and command.
      */
-    [[nodiscard]] auto find_action(juce::KeyPress const &key,
-                                   InputMode mode) const -> std::optional<std::string>;
+    [[nodiscard]] auto skipped() const -> std::vector<std::string> const &;
 
   private:
-    struct KeyAction
-    {
-        juce::KeyPress key;
-        std::string action;
-    };
+    using KeyTable = std::unordered_map<juce::KeyPress, KeyBinding, KeyPressHash>;
 
-    std::map<InputMode, std::vector<KeyAction>> mode_sensitive_actions_;
-    std::vector<KeyAction> mode_independent_actions_;
+    std::map<InputMode, KeyTable> mode_sensitive_actions_;
+    KeyTable mode_independent_actions_;
+    std::vector<std::string> skipped_;
 };
 
 class KeyConfigListener : public juce::KeyListener
 {
   public:
-    sl::Signal<void(std::string const &)> on_command;
+    sl::Signal<void(std::vector<PreparedCommand> const &)> on_command;
 
   public:
-    KeyConfigListener(KeyCore key_core, XenTimeline const &tl);
+    KeyConfigListener(std::shared_ptr<KeyCore const> key_core, XenTimeline const &tl);
 
   protected:
     auto keyPressed(juce::KeyPress const &key,
@@ -86,13 +147,25 @@ class KeyConfigListener : public juce::KeyListener
     auto keyStateChanged(bool, juce::Component *) -> bool override;
 
   private:
-    KeyCore key_core_;
+    std::shared_ptr<KeyCore const> key_core_;
     XenTimeline const &tl_;
     std::optional<int> prefix_int_;
 };
 
+/**
+ * Parse the built-in key bindings with \p user_keys overlaid into a KeyCore for each
+ * component.
+ *
+ * @throws std::runtime_error if the user key configuration file has errors.
+ */
+[[nodiscard]] auto load_key_cores(juce::File const &user_keys)
+    -> SharedResources::KeyCores;
+
+/**
+ * Build a KeyConfigListener for each component, sharing the KeyCores in \p key_cores.
+ */
 [[nodiscard]] auto build_key_listeners(
-    juce::File const &default_keys, juce::File const &user_keys,
+    std::shared_ptr<SharedResources::KeyCores const> const &key_cores,
     XenTimeline const &tl) -> std::map<std::string, KeyConfigListener>;
 
 } // namespace xen
\ No newline at end of file
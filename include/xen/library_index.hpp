@@ -0,0 +1,237 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include <sequence/tuning.hpp>
+
+namespace xen
+{
+
+class LibrarySearch;
+
+/**
+ * What the library index knows about a single sequence bank (.xss) or tuning (.scl)
+ * file, without having to read it again.
+ */
+struct LibraryEntry
+{
+    enum class Type : std::uint8_t
+    {
+        SequenceBank = 0,
+        Tuning = 1,
+    };
+
+    /**
+     * A Note in a measure preview, all values are scaled to [0, 255].
+     */
+    struct PreviewNote
+    {
+        std::uint8_t x;
+        std::uint8_t width;
+        std::uint8_t y; // 0 is the lowest pitch in the measure.
+
+        auto operator==(PreviewNote const &) const -> bool = default;
+    };
+
+    struct Measure
+    {
+        std::string name;
+        std::uint32_t numerator;
+        std::uint32_t denominator;
+        std::uint32_t note_count;
+        std::vector<PreviewNote> preview; // The first preview_note_limit Notes.
+
+        auto operator==(Measure const &) const -> bool = default;
+    };
+
+    static constexpr auto preview_note_limit = std::size_t{32};
+
+    std::string path;
+    juce::int64 modified; // Milliseconds since epoch, with size detects changes.
+    juce::int64 size;
+    Type type;
+    bool readable; // False if the file could not be parsed, the fields below are empty.
+
+    std::vector<Measure> measures; // Sequence banks only.
+
+    sequence::Tuning tuning; // Tunings only, loaded from here without reparsing.
+
+    auto operator==(LibraryEntry const &) const -> bool = default;
+};
+
+/**
+ * Read a .xss or .scl file into a LibraryEntry.
+ *
+ * @details Files that cannot be parsed produce an entry with readable set to false,
+ * so they are not read again until they change.
+ * @throws std::invalid_argument If \p file does not have a .xss or .scl extension.
+ */
+[[nodiscard]] auto read_library_entry(juce::File const &file) -> LibraryEntry;
+
+/**
+ * Serialize entries to the binary format of the persisted library index.
+ */
+[[nodiscard]] auto serialize_library_index(std::vector<LibraryEntry> const &entries)
+    -> std::string;
+
+/**
+ * Deserialize entries written by serialize_library_index.
+ *
+ * @throws std::invalid_argument If \p bytes is not a library index of this version.
+ */
+[[nodiscard]] auto deserialize_library_index(std::span<std::byte const> bytes)
+    -> std::vector<LibraryEntry>;
+
+/**
+ * Keeps a LibraryEntry for each .xss and .scl file in the sequence and tuning
+ * libraries, and in any directory that is browsed to.
+ *
+ * @details Use through juce::SharedResourcePointer so instances share one index. A
+ * background thread first publishes the index saved by the previous session, then
+ * rescans the directories and reads only the files that are new or have a different
+ * modification time or size. Watched directories are polled for modification time
+ * changes, which catch files being added, removed or replaced. Every file is checked
+ * on a slower interval to catch files modified in place. A change message is sent
+ * each time new entries are published, and the index is saved after each scan that
+ * changed it. The search index is rebuilt at the end of each scan that changed the
+ * entries, so files read partway through a scan are not searchable until it ends.
+ */
+class LibraryIndex : public juce::ChangeBroadcaster
+{
+  public:
+    using Entries =
+        std::unordered_map<std::string, std::shared_ptr<LibraryEntry const>>;
+
+    static constexpr auto poll_interval = std::chrono::seconds{2};
+
+    // Every file is checked once per this many polls.
+    static constexpr auto full_scan_polls = 30;
+
+    // Entries are published after this many files have been read in one scan.
+    static constexpr auto publish_count = std::size_t{256};
+
+  public:
+    LibraryIndex();
+
+    LibraryIndex(LibraryIndex const &) = delete;
+    LibraryIndex(LibraryIndex &&) = delete;
+    auto operator=(LibraryIndex const &) -> LibraryIndex & = delete;
+    auto operator=(LibraryIndex &&) -> LibraryIndex & = delete;
+
+    ~LibraryIndex() override;
+
+  public:
+    /**
+     * Index and watch the files directly within \p directory.
+     *
+     * @details Does nothing if it is already watched.
+     */
+    void add_directory(juce::File const &directory);
+
+    /**
+     * Return the entry for \p file, or nullptr if it has not been indexed yet.
+     */
+    [[nodiscard]] auto find(juce::File const &file) const
+        -> std::shared_ptr<LibraryEntry const>;
+
+    /**
+     * Return the entry for \p file if it was indexed since the file last changed.
+     *
+     * @details Compares the modification time and size of the file with the entry,
+     * so the entry can be used in place of reading the file. Returns nullptr if the
+     * file has not been indexed yet or has changed since.
+     */
+    [[nodiscard]] auto find_current(juce::File const &file) const
+        -> std::shared_ptr<LibraryEntry const>;
+
+    /**
+     * Return every entry, keyed by full path.
+     *
+     * @details The returned map is never modified, later changes publish a new one.
+     */
+    [[nodiscard]] auto entries() const -> std::shared_ptr<Entries const>;
+
+    /**
+     * Return the entries matching \p query, ordered by path.
+     *
+     * @details See LibrarySearch::search for the query syntax. Returns nothing until
+     * the first search index has been built.
+     * @throws std::invalid_argument If \p query has an invalid attribute term.
+     */
+    [[nodiscard]] auto search(std::string_view query) const
+        -> std::vector<std::shared_ptr<LibraryEntry const>>;
+
+  private:
+    struct Watch
+    {
+        juce::int64 modified;
+        bool recursive;
+    };
+
+    /**
+     * Tracks the state of one pass over the watched directories.
+     */
+    struct Scan
+    {
+        Entries entries;
+        std::vector<std::string> scanned_directories;
+        std::vector<std::string> seen_files;
+        std::size_t read_count = 0;
+    };
+
+    void run();
+
+    [[nodiscard]] auto is_stopping() const -> bool;
+
+    void load_saved_index(Entries &entries);
+
+    void scan_directory(juce::File const &directory, bool recursive, Scan &scan);
+
+    /**
+     * Remove entries for files that were not seen in a scanned directory.
+     *
+     * @return The number of entries removed.
+     */
+    auto remove_missing(Scan &scan) -> std::size_t;
+
+    /**
+     * Make \p entries visible to other threads and send a change message.
+     *
+     * @param rebuild_search If true, the search index is rebuilt from \p entries.
+     */
+    void publish(Entries const &entries, bool rebuild_search);
+
+    void save(Entries const &entries);
+
+  private:
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::vector<juce::File> added_directories_;
+    std::shared_ptr<Entries const> entries_;
+    std::shared_ptr<LibrarySearch const> search_; // Null until the first is built.
+
+    // Only used by the background thread.
+    juce::File index_file_;
+    std::vector<juce::File> roots_;
+    std::map<std::string, Watch> watched_;
+
+    std::thread thread_; // Last, so it starts after the members it uses.
+};
+
+} // namespace xen
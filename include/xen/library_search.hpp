@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <xen/library_index.hpp>
+
+namespace xen
+{
+
+/**
+ * An inverted index over the names and attributes of library entries.
+ *
+ * @details Built once from a snapshot of the LibraryIndex and never modified. Words
+ * are taken from file names, sequence names and tuning descriptions, split on
+ * anything that is not a letter or digit and lowercased. Each word is stored once
+ * with the sorted list of entries it appears in, so a query term is a binary search
+ * followed by a walk over the words it is a prefix of.
+ */
+class LibrarySearch
+{
+  public:
+    explicit LibrarySearch(LibraryIndex::Entries const &entries);
+
+  public:
+    /**
+     * Return the entries matching every term in \p query, ordered by path.
+     *
+     * @details Terms are separated by whitespace. A plain term matches entries with a
+     * word that begins with it, so results can be shown while a word is being typed.
+     * Attribute terms compare a number with one of =, <, >, <= or >=:
+     * - notes: The note count of any measure in a sequence bank.
+     * - size: The number of intervals in a tuning.
+     * - ts: The time signature of any measure in a sequence bank, as ts=7/8.
+     *
+     * Empty measures are not considered. An empty query matches every entry.
+     * @throws std::invalid_argument If an attribute term has an invalid value.
+     */
+    [[nodiscard]] auto search(std::string_view query) const
+        -> std::vector<std::shared_ptr<LibraryEntry const>>;
+
+    [[nodiscard]] auto size() const -> std::size_t
+    {
+        return documents_.size();
+    }
+
+  private:
+    /**
+     * The attributes of a non-empty measure, stored contiguously for filtering.
+     */
+    struct MeasureAttributes
+    {
+        std::uint32_t numerator;
+        std::uint32_t denominator;
+        std::uint32_t note_count;
+    };
+
+    std::vector<std::shared_ptr<LibraryEntry const>> documents_; // Sorted by path.
+
+    // The measures of documents_[i] are measures_[measure_offsets_[i]] up to
+    // measures_[measure_offsets_[i + 1]].
+    std::vector<MeasureAttributes> measures_;
+    std::vector<std::uint32_t> measure_offsets_;
+
+    // Sorted and unique, postings_[i] holds the documents containing words_[i].
+    std::vector<std::string> words_;
+    std::vector<std::vector<std::uint32_t>> postings_;
+};
+
+/**
+ * Split \p text into lowercase words on anything that is not a letter or digit.
+ *
+ * @details Bytes outside of ASCII are kept as part of a word.
+ */
+[[nodiscard]] auto split_search_words(std::string_view text)
+    -> std::vector<std::string>;
+
+} // namespace xen
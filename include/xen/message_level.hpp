@@ -32,6 +32,13 @@ enum class MessageLevel : std::uint8_t
 
 auto operator<<(std::ostream &os, MessageLevel level) -> std::ostream &;
 
+/**
+ * Parse a MessageLevel by name, case insensitive.
+ *
+ * @throws std::invalid_argument If \p str does not name a MessageLevel.
+ */
+[[nodiscard]] auto parse_message_level(std::string const &str) -> MessageLevel;
+
 /**
  * Return a MessageLevel::Debug message pair.
  */
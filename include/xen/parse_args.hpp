@@ -1,19 +1,28 @@
 #pragma once
 
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
 #include <cstddef>
+#include <cstdlib>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <tuple>
 #include <type_traits>
 #include <vector>
 
 #include <juce_core/juce_core.h>
 
+#include <nlohmann/json_fwd.hpp>
+
 #include <sequence/time_signature.hpp>
 
 #include <xen/input_mode.hpp>
+#include <xen/message_level.hpp>
 #include <xen/modulator.hpp>
 #include <xen/signature.hpp>
 #include <xen/string_manip.hpp>
@@ -24,103 +33,106 @@ namespace xen
 
 [[nodiscard]] auto parse_int(std::string const &x) -> std::optional<int>;
 
-template <typename T = std::size_t>
-[[nodiscard]] auto parse_unsigned(std::string const &x) -> std::optional<T>
+/**
+ * Advance \p first past leading whitespace and a single '+' sign.
+ *
+ * @details std::from_chars accepts neither, but the std::sto* functions it replaces
+ * did, and keys.yml relies on arguments like "+1".
+ */
+[[nodiscard]] inline auto skip_number_prefix(char const *first, char const *last)
+    -> char const *
 {
-    static_assert(std::is_unsigned_v<T>, "T must be unsigned.");
-
-    if (x.find('-') != std::string::npos)
+    while (first != last && std::isspace(static_cast<unsigned char>(*first)) != 0)
     {
-        return std::nullopt;
+        ++first;
     }
-
-    try
+    if (last - first > 1 && first[0] == '+' && first[1] != '-' && first[1] != '+')
     {
-        auto pos = std::size_t{0};
-        auto result = T{0};
+        ++first;
+    }
+    return first;
+}
 
-        if constexpr (sizeof(T) == sizeof(unsigned))
-        {
-            result = std::stoul(x, &pos);
-        }
-        else if constexpr (sizeof(T) == sizeof(unsigned short))
-        {
-            result = std::stoul(x, &pos);
-        }
-        else if constexpr (sizeof(T) == sizeof(unsigned long))
-        {
-            result = std::stoul(x, &pos);
-        }
-        else if constexpr (sizeof(T) == sizeof(unsigned long long))
-        {
-            result = std::stoull(x, &pos);
-        }
-        else
-        {
-            static_assert([] { return false; }(), "Unsupported unsigned.");
-        }
+/**
+ * Parse a base 10 integer, the entire string must be consumed.
+ *
+ * @return std::nullopt if the string is not a valid unsigned or is out of range for T.
+ */
+template <typename T = std::size_t>
+[[nodiscard]] auto parse_unsigned(std::string const &x) -> std::optional<T>
+{
+    static_assert(std::is_unsigned_v<T>, "T must be unsigned.");
 
-        // This verifies the entire string was parsed.
-        if (pos != x.size())
-        {
-            return std::nullopt;
-        }
+    auto const *const last = x.data() + x.size();
+    auto const *const first = skip_number_prefix(x.data(), last);
 
-        return result;
-    }
-    catch (std::invalid_argument const &)
-    {
-        return std::nullopt;
-    }
-    catch (std::out_of_range const &)
+    auto result = T{0};
+    auto const [ptr, ec] = std::from_chars(first, last, result);
+
+    // This verifies the entire string was parsed.
+    if (ec != std::errc{} || ptr != last)
     {
         return std::nullopt;
     }
+
+    return result;
 }
 
+/**
+ * Parse a floating point number, the entire string must be consumed.
+ *
+ * @return std::nullopt if the string is not a valid number, is out of range for T, or
+ * is inf or NaN.
+ */
 template <typename T = float>
 [[nodiscard]] auto parse_float(std::string const &x) -> std::optional<T>
 {
     static_assert(std::is_floating_point_v<T>, "T must be floating point.");
 
-    try
-    {
-        auto pos = std::size_t{0};
-        auto result = T{0};
-
-        if constexpr (sizeof(T) == sizeof(float))
-        {
-            result = std::stof(x, &pos);
-        }
-        else if constexpr (sizeof(T) == sizeof(double))
-        {
-            result = std::stod(x, &pos);
-        }
-        else if constexpr (sizeof(T) == sizeof(long double))
-        {
-            result = std::stold(x, &pos);
-        }
-        else
-        {
-            static_assert([] { return false; }(), "Unsupported float.");
-        }
+    auto const *const last = x.data() + x.size();
+    auto const *const first = skip_number_prefix(x.data(), last);
+    auto result = T{0};
 
-        // This verifies the entire string was parsed and is not inf, -inf or NaN.
-        if (pos != x.size() || !std::isfinite(result))
-        {
-            return std::nullopt;
-        }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // Hexadecimal floats need their "0x" prefix removed before std::from_chars.
+    auto const negative = first != last && *first == '-';
+    auto const *const digits = negative ? first + 1 : first;
+    auto const is_hex =
+        last - digits > 1 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X');
 
-        return result;
+    auto const [ptr, ec] =
+        is_hex ? std::from_chars(digits + 2, last, result, std::chars_format::hex)
+               : std::from_chars(first, last, result);
+    auto const ok = ec == std::errc{} && !(is_hex && (ptr == digits + 2 ||
+                                                      *(digits + 2) == '-'));
+    result = (is_hex && negative) ? -result : result;
+#else
+    // Floating point std::from_chars is missing from some standard libraries, the
+    // strto* functions are the closest non-throwing alternative.
+    auto *ptr = const_cast<char *>(first);
+    errno = 0;
+    if constexpr (std::is_same_v<T, float>)
+    {
+        result = std::strtof(first, &ptr);
     }
-    catch (std::invalid_argument const &)
+    else if constexpr (std::is_same_v<T, double>)
     {
-        return std::nullopt;
+        result = std::strtod(first, &ptr);
+    }
+    else
+    {
+        result = std::strtold(first, &ptr);
     }
-    catch (std::out_of_range const &)
+    auto const ok = ptr != first && errno != ERANGE;
+#endif
+
+    // This verifies the entire string was parsed and is not inf, -inf or NaN.
+    if (!ok || ptr != last || !std::isfinite(result))
     {
         return std::nullopt;
     }
+
+    return result;
 }
 
 [[nodiscard]] auto parse_bool(std::string const &x) -> std::optional<bool>;
@@ -142,6 +154,13 @@ template <typename T = float>
 [[nodiscard]]
 auto parse_modulator(std::string const &mod_json) -> Modulator;
 
+/**
+ * Builds a Modulator from already parsed JSON, for callers that hold the JSON object.
+ * @throws std::invalid_argument if the JSON does not describe a Modulator.
+ */
+[[nodiscard]]
+auto modulator_from_json(nlohmann::json const &mod_json) -> Modulator;
+
 // Forward Declation for parse_variant
 template <typename T>
 [[nodiscard]] auto parse(std::string const &x) -> T;
@@ -240,6 +259,10 @@ template <typename T>
     {
         return parse_input_mode(x);
     }
+    else if constexpr (std::is_same_v<T, MessageLevel>)
+    {
+        return parse_message_level(x);
+    }
     else if constexpr (std::is_same_v<T, juce::File>)
     {
         return juce::File{x};
@@ -25,7 +25,19 @@ struct Scale
 };
 
 /**
- * Loads in Scales from library directory's scales.yml and user_scales.yml files.
+ * Returns the built-in Scales, converted from data/scales/scales.yml at build time.
+ */
+[[nodiscard]] auto get_system_scales() -> std::vector<Scale>;
+
+/**
+ * Loads in Scales from the library directory's user_scales.yml file.
+ *
+ * @throws YAML::Exception If the file cannot be parsed.
+ */
+[[nodiscard]] auto load_user_scales() -> std::vector<Scale>;
+
+/**
+ * Returns the built-in Scales followed by those in user_scales.yml.
  */
 [[nodiscard]] auto load_scales_from_files() -> std::vector<Scale>;
 
@@ -82,4 +82,23 @@ namespace xen
  */
 [[nodiscard]] auto deserialize_plugin(std::string const &json_str) -> SequencerState;
 
+/**
+ * Serialize the plugin state saved by the host, with the id of the plugin instance.
+ *
+ * @details The same as serialize_plugin, with an added "instance_id" key. It is
+ * omitted if \p instance_id is empty.
+ */
+[[nodiscard]] auto serialize_host_state(SequencerState const &state,
+                                        std::string const &instance_id) -> std::string;
+
+/**
+ * Deserialize the plugin state saved by the host.
+ *
+ * @return The state, and the instance id, which is empty if the state was saved
+ * without one.
+ * @throw std::invalid_argument If the JSON string is invalid.
+ */
+[[nodiscard]] auto deserialize_host_state(std::string const &json_str)
+    -> std::pair<SequencerState, std::string>;
+
 } // namespace xen
\ No newline at end of file
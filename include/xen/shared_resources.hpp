@@ -0,0 +1,146 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include <xen/chord.hpp>
+#include <xen/gui/themes.hpp>
+#include <xen/scale.hpp>
+
+namespace juce
+{
+class LookAndFeel;
+}
+
+namespace xen
+{
+
+class KeyCore;
+
+/**
+ * Parsed resources read by every plugin instance in the process.
+ *
+ * @details Use through juce::SharedResourcePointer so instances share one copy of each
+ * resource instead of parsing their own. A published resource is never modified, a
+ * reload builds a new one and swaps the pointer, so a snapshot stays valid for as long
+ * as the reader holds it. Reloads compare the modification time and size of the user
+ * file with the last load, and keep the current resource if nothing changed, so only
+ * the first of many instances does the parsing. The user Scales and Chords are first
+ * loaded by a background thread, and a change message is sent once they are published.
+ *
+ * Fonts are created once per process in gui/fonts.hpp and parsed tunings are shared
+ * through the LibraryIndex, so neither are held here.
+ */
+class SharedResources : public juce::ChangeBroadcaster
+{
+  public:
+    using KeyCores = std::unordered_map<std::string, KeyCore>;
+
+  public:
+    /**
+     * Starts with the built-in Scales and Chords, and starts the thread that loads the
+     * user library files.
+     */
+    SharedResources();
+
+    SharedResources(SharedResources const &) = delete;
+    SharedResources(SharedResources &&) = delete;
+    auto operator=(SharedResources const &) -> SharedResources & = delete;
+    auto operator=(SharedResources &&) -> SharedResources & = delete;
+
+    /**
+     * Waits for the user library files to finish loading.
+     */
+    ~SharedResources() override;
+
+  public:
+    [[nodiscard]] auto scales() const -> std::shared_ptr<std::vector<Scale> const>;
+
+    [[nodiscard]] auto chords() const -> std::shared_ptr<std::vector<Chord> const>;
+
+    /**
+     * Publish the built-in Scales followed by those in user_scales.yml, if that file
+     * has changed since it was last read.
+     *
+     * @return True if a new list of Scales was published.
+     * @throws YAML::Exception If the file cannot be parsed, the current Scales are
+     * kept.
+     */
+    auto reload_scales() -> bool;
+
+    /**
+     * Publish the built-in Chords followed by those in user_chords.yml, if that file
+     * has changed since it was last read.
+     *
+     * @return True if a new list of Chords was published.
+     * @throws YAML::Exception If the file cannot be parsed, the current Chords are
+     * kept.
+     */
+    auto reload_chords() -> bool;
+
+    /**
+     * Return the error from the first load of the user Scales and Chords, if any.
+     */
+    [[nodiscard]] auto library_error() const -> std::optional<std::string>;
+
+    /**
+     * Return the KeyCore of each component, from the built-in key bindings with
+     * \p user_keys overlaid.
+     *
+     * @details \p user_keys is only parsed if it is a different file, or has changed,
+     * since the last call. Only call from the message thread.
+     * @throws std::runtime_error If the user key configuration file has errors.
+     */
+    [[nodiscard]] auto key_cores(juce::File const &user_keys)
+        -> std::shared_ptr<KeyCores const>;
+
+    /**
+     * Return a LookAndFeel for \p theme, shared by every editor showing that theme.
+     *
+     * @details Only call from the message thread, as with any LookAndFeel use.
+     */
+    [[nodiscard]] auto look_and_feel(gui::Theme const &theme)
+        -> std::shared_ptr<juce::LookAndFeel>;
+
+  private:
+    struct FileStamp
+    {
+        std::string path;
+        juce::int64 modified;
+        juce::int64 size;
+
+        auto operator==(FileStamp const &) const -> bool = default;
+    };
+
+    [[nodiscard]] static auto stamp(juce::File const &file) -> FileStamp;
+
+  private:
+    // Guards the published pointers, held only to copy or swap them.
+    mutable std::mutex mtx_;
+    std::shared_ptr<std::vector<Scale> const> scales_;
+    std::shared_ptr<std::vector<Chord> const> chords_;
+    std::optional<std::string> library_error_;
+
+    // Held while reading a user file, so concurrent reloads parse it once.
+    std::mutex reload_mtx_;
+    std::optional<FileStamp> scales_stamp_;
+    std::optional<FileStamp> chords_stamp_;
+
+    // Message thread only.
+    std::shared_ptr<KeyCores const> key_cores_;
+    std::optional<FileStamp> key_cores_stamp_;
+    std::shared_ptr<juce::LookAndFeel> laf_;
+    std::optional<gui::Theme> laf_theme_;
+
+    std::thread library_thread_; // Last, so it starts after the members it uses.
+};
+
+} // namespace xen
@@ -17,6 +17,7 @@
 #include <sequence/time_signature.hpp>
 
 #include <xen/input_mode.hpp>
+#include <xen/message_level.hpp>
 #include <xen/modulator.hpp>
 #include <xen/utility.hpp>
 
@@ -210,6 +211,10 @@ auto type_name() -> std::string
     {
         return "InputMode";
     }
+    else if constexpr (std::is_same_v<T, MessageLevel>)
+    {
+        return "MessageLevel";
+    }
     else if constexpr (std::is_same_v<T, juce::File>)
     {
         return "Filepath";
@@ -23,12 +23,16 @@ class LookAndFeel;
 
 #include <signals_light/signal.hpp>
 
+#include <xen/background_worker.hpp>
 #include <xen/chord.hpp>
 #include <xen/clock.hpp>
 #include <xen/command_history.hpp>
 #include <xen/gui/themes.hpp>
 #include <xen/input_mode.hpp>
+#include <xen/library_index.hpp>
+#include <xen/message_level.hpp>
 #include <xen/scale.hpp>
+#include <xen/shared_resources.hpp>
 #include <xen/state.hpp>
 #include <xen/timeline.hpp>
 #include <xen/user_directory.hpp>
@@ -158,19 +162,39 @@ struct PluginState
 
     sl::Signal<void(std::string const &)> on_focus_request{};
     sl::Signal<void(std::string const &)> on_show_request{};
+    sl::Signal<void(std::string const &)> on_search_request{};
+    sl::Signal<void(MessageLevel)> on_message_log_filter_request{};
+    sl::Signal<std::string()> on_message_log_text_request{};
     CommandHistory command_history{};
     XenTimeline timeline;
     inline static SharedState shared{};
-    std::unique_ptr<juce::LookAndFeel> laf{nullptr};
-    std::vector<Scale> scales{};
+
+    // Scales, Chords, key bindings and the LookAndFeel, shared by every instance.
+    juce::SharedResourcePointer<SharedResources> resources{};
+
+    // The sequence and tuning libraries, indexed in the background while held.
+    juce::SharedResourcePointer<LibraryIndex> library_index{};
+    std::shared_ptr<juce::LookAndFeel> laf{nullptr};
     std::optional<std::size_t> scale_shift_index{std::nullopt}; // null is chromatic
-    std::vector<Chord> chords{};
+
+    // Runs expensive commands off of the message thread, see execute_commands.
+    BackgroundWorker worker{};
+
+    // Names this plugin instance's autosave journals, saved with the host state.
+    std::string instance_id{};
+
+    // True if a journal of instance_id left by a crashed session is waiting to be
+    // recovered, set each time the host restores a state.
+    bool recoverable_autosave{false};
 };
 
 struct AudioThreadStateForGUI
 {
     DAWState daw;
     std::array<Clock::time_point, 16> note_start_times;
+
+    // Incremented by the audio thread each time daw or note_start_times change.
+    std::uint64_t generation = 0;
 };
 
 } // namespace xen
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <xen/state.hpp>
+
+namespace xen
+{
+
+/**
+ * Holds the serialized SequencerState of the most recent commit, for the host to save.
+ *
+ * @details Each update() is serialized on a background thread, so that get() is
+ * normally a copy of a ready buffer. Updates that arrive while one is being serialized
+ * replace each other, only the most recent is serialized next. update() must be called
+ * from the message thread, get() may be called from any thread.
+ */
+class StateBlobCache
+{
+  public:
+    StateBlobCache();
+
+    StateBlobCache(StateBlobCache const &) = delete;
+    StateBlobCache(StateBlobCache &&) = delete;
+    auto operator=(StateBlobCache const &) -> StateBlobCache & = delete;
+    auto operator=(StateBlobCache &&) -> StateBlobCache & = delete;
+
+    /**
+     * Stops the background thread, waiting for any serialization in progress.
+     */
+    ~StateBlobCache();
+
+  public:
+    /**
+     * Set the state that get() returns, keyed by the timeline commit that produced it.
+     *
+     * @details Does nothing if \p commit_id and \p instance_id are already the current
+     * state.
+     * @param instance_id Saved with the state, see serialize_host_state.
+     */
+    void update(int commit_id, std::shared_ptr<SequencerState const> state,
+                std::string instance_id);
+
+    /**
+     * Return the serialized state passed to the most recent update() call.
+     *
+     * @details If the background thread has not finished it yet, it is serialized on
+     * the calling thread instead of waiting.
+     * @throws std::logic_error If update() has never been called.
+     * @throws std::exception If serialization fails.
+     */
+    [[nodiscard]] auto get() -> std::shared_ptr<std::string const>;
+
+  private:
+    void run();
+
+  private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    int commit_id_ = -1;
+    std::string instance_id_;
+    std::shared_ptr<SequencerState const> state_;
+    int state_id_ = -1; // Incremented by each update.
+    int blob_id_ = -1;  // The state_id_ that blob_ was serialized from.
+    std::shared_ptr<std::string const> blob_;
+
+    std::thread thread_; // Last, so it starts after the members it uses.
+};
+
+} // namespace xen
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -71,13 +73,110 @@ namespace xen
 [[nodiscard]] auto split(std::string const &input, char delimiter)
     -> std::vector<std::string>;
 
+/**
+ * Thrown when a string cannot be tokenized, records where the problem was found.
+ */
+class ParseError : public std::invalid_argument
+{
+  public:
+    /**
+     * @param message Description of the error, the column is appended to this.
+     * @param position The zero-based offset into the input where the error was found.
+     */
+    ParseError(std::string const &message, std::size_t position);
+
+  public:
+    /**
+     * The zero-based offset into the input where the error was found.
+     */
+    [[nodiscard]] auto position() const -> std::size_t;
+
+  private:
+    std::size_t position_;
+};
+
+/**
+ * A single word within a larger string, as produced by tokenize().
+ *
+ * @details The text is a view into the tokenized string, which must outlive the Token.
+ */
+struct Token
+{
+    std::string_view text; // Surrounding double quotes are not included.
+    std::size_t position;  // Offset of text within the tokenized string.
+    bool has_inner_quotes; // If true, use to_string(Token) to remove them.
+};
+
+/**
+ * A fixed capacity array of Tokens, so tokenizing does not allocate.
+ */
+class TokenList
+{
+  public:
+    static constexpr auto capacity = std::size_t{32};
+
+  public:
+    /**
+     * @throws ParseError If the list is already at capacity.
+     */
+    void push_back(Token const &token);
+
+    [[nodiscard]] auto size() const -> std::size_t
+    {
+        return size_;
+    }
+
+    [[nodiscard]] auto empty() const -> bool
+    {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] auto operator[](std::size_t i) const -> Token const &
+    {
+        return tokens_[i];
+    }
+
+    [[nodiscard]] auto begin() const -> Token const *
+    {
+        return tokens_.data();
+    }
+
+    [[nodiscard]] auto end() const -> Token const *
+    {
+        return tokens_.data() + size_;
+    }
+
+  private:
+    std::array<Token, capacity> tokens_;
+    std::size_t size_{0};
+};
+
+/**
+ * Splits a string into words in a single pass, without allocating.
+ *
+ * @details Words are whitespace delimited, unless within double quotes or curly
+ * braces. Double quotes are removed, curly braces are kept so JSON arguments stay
+ * intact. Empty quoted words are skipped.
+ * @param input The string to tokenize.
+ * @return TokenList Views into \p input, one per word.
+ * @throws ParseError If a double quote or curly brace is not closed, or if there are
+ * more than TokenList::capacity words.
+ */
+[[nodiscard]] auto tokenize(std::string_view input) -> TokenList;
+
+/**
+ * Copies a Token into a std::string, removing any double quotes within the word.
+ */
+[[nodiscard]] auto to_string(Token const &token) -> std::string;
+
 /**
  * Splits a string into a vector of strings based on spaces, unless within double
  * quotes.
  *
- * @details This removes the quotes once split.
+ * @details This removes the quotes once split, see tokenize().
  * @param input The string to split.
  * @return std::vector<std::string> The split string.
+ * @throws ParseError If the string cannot be tokenized.
  */
 [[nodiscard]] auto split_quoted_string(std::string const &input)
     -> std::vector<std::string>;
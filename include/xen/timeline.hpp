@@ -70,6 +70,16 @@ class Timeline
         return stage_;
     }
 
+    /**
+     * Retrieve a reference to the current state, without copying.
+     *
+     * @details The reference is invalidated by any call that modifies the Timeline.
+     */
+    [[nodiscard]] auto peek_state() const -> State const &
+    {
+        return stage_;
+    }
+
     /**
      * Return the unique commit ID for the most recent commit state. Does not change on
      * staged state.
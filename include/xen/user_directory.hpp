@@ -28,11 +28,20 @@ namespace xen
  */
 [[nodiscard]] auto get_tunings_directory() -> juce::File;
 
+/**
+ * Retrieve the location of the autosave journal directory.
+ *
+ * @details If the directory does not exist, it will be created.
+ * @return The filesystem path of the autosave directory.
+ */
+[[nodiscard]] auto get_autosave_directory() -> juce::File;
+
 /**
  * Retrieve the location of the system keys.yml configuration file.
  *
  * @details If the file does not exist, it will be created. If it is outdated, it will
- * be overwritten.
+ * be overwritten. The plugin does not read it, the built-in key bindings are compiled
+ * in from the same file.
  * @return The filesystem path of the keybinding file.
  * @throws std::runtime_error if the file cannot be created.
  */
@@ -51,7 +60,7 @@ namespace xen
  * Retrieve the location of the system scales.yml file.
  *
  * @details If the file does not exist, it will be created. If it is outdated, it will
- * be overwritten.
+ * be overwritten. Kept for reference, see get_system_scales.
  * @return The filesystem path of the system scales file.
  * @throws std::runtime_error if the file cannot be created.
  */
@@ -70,7 +79,7 @@ namespace xen
  * Retrieve the location of the system chords.yml file.
  *
  * @details If the file does not exist, it will be created. If it is outdated, it will
- * be overwritten.
+ * be overwritten. Kept for reference, see get_system_chords.
  * @return The filesystem path of the system chords file.
  * @throws std::runtime_error if the file cannot be created.
  */
@@ -87,7 +96,19 @@ namespace xen
 
 /**
  * Create and populate the demos/ directory with the demo files.
+ *
+ * @details Only files that are missing are written.
  */
 void initialize_demo_files();
 
+/**
+ * Write any missing or outdated demo files, system .yml files and user .yml files to
+ * the library directory.
+ *
+ * @details Only the first call in a process does any work, so instances created after
+ * the first do not touch the disk. If it throws, the next call tries again.
+ * @throws std::runtime_error if a file cannot be created.
+ */
+void initialize_library_files();
+
 } // namespace xen
\ No newline at end of file
@@ -1,11 +1,53 @@
 #pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <xen/background_worker.hpp>
 #include <xen/command.hpp>
+#include <xen/message_level.hpp>
 
 namespace xen
 {
+struct PluginState;
 
 using XenCommandTree = CommandGroup;
 
 [[nodiscard]] auto create_command_tree() -> XenCommandTree;
 
+/**
+ * Execute prepared commands against a PluginState, committing any changes.
+ *
+ * @details Commands are run in order and the timeline is committed once at the end if
+ * any command set the commit flag. If a command throws, staged changes are reverted
+ * (keeping the current selection) and the error is returned as the status. An 'again'
+ * command runs \p previous_commands, which is replaced by \p commands, with 'again'
+ * expanded, whenever they commit or start a background task. While ps.worker is busy
+ * only commands that do not modify state are run, anything else is an error. Commands
+ * after one that starts a task are run after its result is applied, see
+ * BackgroundWorker::then. A task started by a command list that fails is cancelled.
+ * @param tree The command tree to dispatch on, it must outlive any task started.
+ * @param ps The state to execute commands against.
+ * @param commands The commands to execute, in order.
+ * @param previous_commands The commands to run for 'again'.
+ * @return The status of the last command run, or the error if one was thrown.
+ */
+[[nodiscard]] auto execute_commands(XenCommandTree const &tree, PluginState &ps,
+                                    std::vector<PreparedCommand> const &commands,
+                                    std::vector<PreparedCommand> &previous_commands)
+    -> std::pair<MessageLevel, std::string>;
+
+/**
+ * Apply the result of a finished background task and commit any changes.
+ *
+ * @details If the result throws, staged changes are reverted and the error is
+ * returned as the status.
+ * @param ps The state to apply the result to.
+ * @param result The result taken from ps.worker.
+ * @return The status reported by the result.
+ */
+[[nodiscard]] auto apply_task_result(PluginState &ps, TaskResult const &result)
+    -> std::pair<MessageLevel, std::string>;
+
 } // namespace xen
@@ -3,12 +3,15 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <juce_core/juce_core.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
+#include <xen/command.hpp>
 #include <xen/gui/plugin_window.hpp>
 #include <xen/key_core.hpp>
+#include <xen/message_level.hpp>
 #include <xen/state.hpp>
 #include <xen/xen_processor.hpp>
 
@@ -32,13 +35,23 @@ class XenEditor : public juce::AudioProcessorEditor
     /**
      * Set or Update the key listeners for the plugin window.
      *
-     * @param default_keys The path to the default key configuration file
+     * @details The built-in key bindings are overlaid with \p user_keys. Bindings with
+     * an invalid command are skipped and reported as warnings.
      * @param user_keys The path to the user key configuration file
-     * @throws std::runtime_error if the key configuration files cannot be read or have
-     * errors
+     * @throws std::runtime_error if the key configuration file cannot be read or
+     * parsed
      */
-    void update_key_listeners(juce::File const &default_keys,
-                              juce::File const &user_keys);
+    void update_key_listeners(juce::File const &user_keys);
+
+    /**
+     * Update the GUI and report the status of an executed command.
+     */
+    void report_status(MessageLevel level, std::string const &message);
+
+    /**
+     * Report that an autosave left by a crashed session can be recovered.
+     */
+    void warn_recoverable_autosave();
 
   public:
     void resized() override;
@@ -56,6 +69,14 @@ class XenEditor : public juce::AudioProcessorEditor
      */
     void execute_command_string(std::string const &command_string);
 
+    /**
+     * Execute prepared commands in the plugin window.
+     *
+     * @details Identical to execute_command_string, without the parsing step.
+     * @param commands The commands to execute
+     */
+    void execute_commands(std::vector<PreparedCommand> const &commands);
+
     /**
      * Set the key listeners for the plugin window.
      *
@@ -1,30 +1,42 @@
 #pragma once
 
 #include <cstdint>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_events/juce_events.h>
 
+#include <xen/autosave.hpp>
 #include <xen/command.hpp>
 #include <xen/command_history.hpp>
+#include <xen/completion_index.hpp>
+#include <xen/copy_paste.hpp>
 #include <xen/double_buffer.hpp>
 #include <xen/gui/themes.hpp>
 #include <xen/lock_free_optional.hpp>
 #include <xen/message_level.hpp>
 #include <xen/midi_engine.hpp>
 #include <xen/state.hpp>
+#include <xen/state_blob_cache.hpp>
 #include <xen/xen_command_tree.hpp>
 
 namespace xen
 {
 
-class XenProcessor : public juce::AudioProcessor
+class XenProcessor : public juce::AudioProcessor,
+                     private juce::Timer,
+                     private juce::ChangeListener,
+                     private juce::AsyncUpdater
 {
   public:
     PluginState plugin_state;
     XenCommandTree command_tree;
+    CompletionIndex completion_index;
     int editor_width{1200};
     int editor_height{300};
 
@@ -35,7 +47,7 @@ class XenProcessor : public juce::AudioProcessor
   public:
     XenProcessor();
 
-    ~XenProcessor() override = default;
+    ~XenProcessor() override;
 
   public:
     void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
@@ -58,6 +70,22 @@ class XenProcessor : public juce::AudioProcessor
     auto execute_command_string(std::string const &command_string)
         -> std::pair<MessageLevel, std::string>;
 
+    /**
+     * Execute commands that have already been prepared, using the command tree.
+     *
+     * @details This skips normalizing and splitting, it is otherwise identical to
+     * execute_command_string.
+     * @param commands The commands to execute, in order.
+     */
+    auto execute_commands(std::vector<PreparedCommand> const &commands)
+        -> std::pair<MessageLevel, std::string>;
+
+    /**
+     * Returns true if an autosave of this instance, from a session that crashed, was
+     * found when the host restored its state and has not been recovered since.
+     */
+    [[nodiscard]] auto has_recoverable_autosave() const -> bool;
+
   public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -78,6 +106,37 @@ class XenProcessor : public juce::AudioProcessor
     auto getProgramName(int index) -> juce::String const override;
     void changeProgramName(int index, juce::String const &newName) override;
 
+  private:
+    /**
+     * Polls plugin_state.worker, applying its result once finished.
+     */
+    void timerCallback() override;
+
+    /**
+     * Updates the editor once SharedResources has loaded the user Scales and Chords.
+     */
+    void changeListenerCallback(juce::ChangeBroadcaster *) override;
+
+    /**
+     * Warns the active editor if the search for this instance's autosave, started by
+     * setStateInformation, found one.
+     */
+    void handleAsyncUpdate() override;
+
+    /**
+     * Send the current state to the audio thread, the cache read by
+     * getStateInformation and the autosave journal, if it has been committed since the
+     * last call.
+     *
+     * @param change Description of what made the commit, recorded in the journal.
+     */
+    void send_state_update(std::string const &change);
+
+    /**
+     * Report the status of a finished background task to the active editor, if any.
+     */
+    void report_task_status(std::pair<MessageLevel, std::string> const &status);
+
   private:
     struct AudioThreadState
     {
@@ -85,10 +144,30 @@ class XenProcessor : public juce::AudioProcessor
         SequencerState sequencer{};
         SampleCount accumulated_sample_count{0};
         MidiEngine midi_engine;
+
+        // The last state written to audio_thread_state_for_gui.
+        AudioThreadStateForGUI published_for_gui{};
     } audio_thread_state_;
 
     int previous_commit_id_{-1};
-    std::string previous_command_string_{""};
+    std::vector<PreparedCommand> previous_commands_{};
+
+    // Hosts can call getStateInformation often and from any thread.
+    StateBlobCache state_blob_cache_;
+
+    // The latest result of Autosave::find_recoverable, set from the Autosave's
+    // background thread so it is declared before autosave_.
+    struct AutosaveSearch
+    {
+        std::mutex mtx;
+        std::optional<std::string> instance_id{std::nullopt}; // Set until handled.
+        bool found{false};
+    } autosave_search_;
+
+    Autosave autosave_;
+
+    // Keeps the copy history alive while any plugin instance is open.
+    juce::SharedResourcePointer<Clipboard> clipboard_;
 
   public:
     DoubleBuffer<AudioThreadStateForGUI> audio_thread_state_for_gui;
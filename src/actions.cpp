@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <iterator>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -19,11 +20,42 @@
 #include <sequence/time_signature.hpp>
 #include <sequence/utility.hpp>
 
+#include <xen/binary_serialize.hpp>
 #include <xen/copy_paste.hpp>
 #include <xen/serialize.hpp>
 #include <xen/state.hpp>
 #include <xen/utility.hpp>
 
+namespace
+{
+
+/**
+ * Evaluate \p mod once over every Cell in \p seq selected by \p pattern.
+ *
+ * @details Each Cell's input is its position in the Sequence, in [0, 1).
+ * @return The index of each selected Cell and its modulated value.
+ */
+[[nodiscard]] auto modulate_selected(sequence::Sequence const &seq,
+                                     sequence::Pattern const &pattern,
+                                     xen::Modulator const &mod)
+    -> std::pair<std::vector<std::size_t>, std::vector<float>>
+{
+    auto indices = std::vector<std::size_t>{};
+    auto values = std::vector<float>{};
+    for (auto i = std::size_t{0}; i < seq.cells.size(); ++i)
+    {
+        if (sequence::pattern_contains(pattern, i))
+        {
+            indices.push_back(i);
+            values.push_back((float)i / (float)seq.cells.size());
+        }
+    }
+    mod(values, values);
+    return {std::move(indices), std::move(values)};
+}
+
+} // namespace
+
 namespace xen::action
 {
 
@@ -74,13 +106,14 @@ auto cut(XenTimeline const &tl) -> SequencerState
     return state;
 }
 
-auto paste(XenTimeline const &tl) -> SequencerState
+auto paste(XenTimeline const &tl, std::size_t history) -> SequencerState
 {
-    auto const cell = read_copy_buffer();
+    auto const cell = read_copy_buffer(history);
 
     if (!cell.has_value())
     {
-        throw std::runtime_error{"Copy Buffer Is Empty"};
+        throw std::runtime_error{history == 0 ? "Copy Buffer Is Empty"
+                                              : "Copy Buffer History Is Too Short"};
     }
 
     auto [state, aux] = tl.get_state();
@@ -205,6 +238,18 @@ auto save_sequence_bank(SequenceBank const &bank,
     filepath.replaceWithText(serialize_sequence_bank(bank, sequence_names));
 }
 
+auto save_sequence_bank_binary(SequenceBank const &bank,
+                               std::array<std::string, 16> const &sequence_names,
+                               juce::File const &filepath) -> void
+{
+    auto const bytes = serialize_sequence_bank_binary(bank, sequence_names);
+    if (!filepath.replaceWithData(bytes.data(), bytes.size()))
+    {
+        throw std::runtime_error{"Could not write file: " +
+                                 filepath.getFullPathName().toStdString()};
+    }
+}
+
 auto load_sequence_bank(juce::File const &filepath)
     -> std::pair<SequenceBank, std::array<std::string, 16>>
 {
@@ -212,6 +257,22 @@ auto load_sequence_bank(juce::File const &filepath)
     {
         throw std::runtime_error{"Sequence Bank file size exceeds 128MB"};
     }
+
+    // Binary banks are read in place from the mapping, JSON banks are parsed from a
+    // string. Empty files can't be mapped and fall through to the JSON error.
+    auto const mapped =
+        juce::MemoryMappedFile{filepath, juce::MemoryMappedFile::readOnly};
+    if (mapped.getData() != nullptr)
+    {
+        auto const bytes = std::span{static_cast<std::byte const *>(mapped.getData()),
+                                     mapped.getSize()};
+        if (is_binary_sequence_bank(bytes))
+        {
+            return deserialize_sequence_bank_binary(bytes);
+        }
+        return deserialize_sequence_bank(
+            std::string{reinterpret_cast<char const *>(bytes.data()), bytes.size()});
+    }
     return deserialize_sequence_bank(filepath.loadFileAsString().toStdString());
 }
 
@@ -352,13 +413,11 @@ auto set_weights(sequence::Cell cell, sequence::Pattern const &pattern,
     {
         auto &seq = std::get<sequence::Sequence>(cell.element);
 
-        for (auto i = std::size_t{0}; i < seq.cells.size(); ++i)
+        auto const [indices, values] = modulate_selected(seq, pattern, mod);
+        for (auto i = std::size_t{0}; i < indices.size(); ++i)
         {
-            if (sequence::pattern_contains(pattern, i))
-            {
-                auto &c = seq.cells[i];
-                c.weight = mod((float)i / (float)seq.cells.size());
-            }
+            auto &c = seq.cells[indices[i]];
+            c.weight = values[i];
         }
     }
     return cell;
@@ -393,14 +452,11 @@ auto set_velocities(sequence::Cell cell, sequence::Pattern const &pattern,
     {
         auto &seq = std::get<sequence::Sequence>(cell.element);
 
-        for (auto i = std::size_t{0}; i < seq.cells.size(); ++i)
+        auto const [indices, values] = modulate_selected(seq, pattern, mod);
+        for (auto i = std::size_t{0}; i < indices.size(); ++i)
         {
-            if (sequence::pattern_contains(pattern, i))
-            {
-                auto &c = seq.cells[i];
-                c = sequence::modify::set_velocity(
-                    c, pattern, mod((float)i / (float)seq.cells.size()));
-            }
+            auto &c = seq.cells[indices[i]];
+            c = sequence::modify::set_velocity(c, pattern, values[i]);
         }
     }
     return cell;
@@ -413,14 +469,11 @@ auto set_delays(sequence::Cell cell, sequence::Pattern const &pattern,
     {
         auto &seq = std::get<sequence::Sequence>(cell.element);
 
-        for (auto i = std::size_t{0}; i < seq.cells.size(); ++i)
+        auto const [indices, values] = modulate_selected(seq, pattern, mod);
+        for (auto i = std::size_t{0}; i < indices.size(); ++i)
         {
-            if (sequence::pattern_contains(pattern, i))
-            {
-                auto &c = seq.cells[i];
-                c = sequence::modify::set_delay(
-                    c, pattern, mod((float)i / (float)seq.cells.size()));
-            }
+            auto &c = seq.cells[indices[i]];
+            c = sequence::modify::set_delay(c, pattern, values[i]);
         }
     }
     return cell;
@@ -433,14 +486,11 @@ auto set_gates(sequence::Cell cell, sequence::Pattern const &pattern,
     {
         auto &seq = std::get<sequence::Sequence>(cell.element);
 
-        for (auto i = std::size_t{0}; i < seq.cells.size(); ++i)
+        auto const [indices, values] = modulate_selected(seq, pattern, mod);
+        for (auto i = std::size_t{0}; i < indices.size(); ++i)
         {
-            if (sequence::pattern_contains(pattern, i))
-            {
-                auto &c = seq.cells[i];
-                c = sequence::modify::set_gate(c, pattern,
-                                               mod((float)i / (float)seq.cells.size()));
-            }
+            auto &c = seq.cells[indices[i]];
+            c = sequence::modify::set_gate(c, pattern, values[i]);
         }
     }
     return cell;
@@ -0,0 +1,481 @@
+#include <xen/autosave.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include <nlohmann/json.hpp>
+
+#include <xen/serialize.hpp>
+#include <xen/state.hpp>
+#include <xen/user_directory.hpp>
+
+namespace
+{
+
+/**
+ * The journals opened by Autosave instances in this process.
+ *
+ * @details InterProcessLock only excludes other processes, and releasing a second
+ * lock on the same name would release the owner's lock as well, so journals owned by
+ * this process are checked here first.
+ */
+struct OpenJournals
+{
+    std::mutex mtx;
+    std::set<std::string> names;
+};
+
+[[nodiscard]] auto open_journals() -> OpenJournals &
+{
+    static auto instance = OpenJournals{};
+    return instance;
+}
+
+[[nodiscard]] auto journal_lock_name(juce::File const &journal) -> juce::String
+{
+    return "XenSequencer_autosave_" + journal.getFileNameWithoutExtension();
+}
+
+/**
+ * Journals are named "<instance id>.<session id>.journal".
+ */
+[[nodiscard]] auto journal_filename(std::string const &instance_id,
+                                    juce::String const &session_id) -> juce::String
+{
+    return juce::String{instance_id} + "." + session_id + ".journal";
+}
+
+[[nodiscard]] auto journal_instance_id(juce::File const &journal) -> std::string
+{
+    return journal.getFileNameWithoutExtension()
+        .upToFirstOccurrenceOf(".", false, false)
+        .toStdString();
+}
+
+[[nodiscard]] auto to_json_string(std::string const &text) -> std::string
+{
+    return nlohmann::json(text).dump(-1, ' ', false,
+                                     nlohmann::json::error_handler_t::replace);
+}
+
+[[nodiscard]] auto snapshot_line(std::string const &command,
+                                 xen::SequencerState const &state) -> std::string
+{
+    return R"({"command":)" + to_json_string(command) +
+           R"(,"state":)" + xen::serialize_plugin(state) + "}\n";
+}
+
+/**
+ * A line recording only the measures and names that differ from \p previous.
+ */
+[[nodiscard]] auto delta_line(std::string const &command,
+                              xen::SequencerState const &previous,
+                              xen::SequencerState const &state) -> std::string
+{
+    auto line = R"({"command":)" + to_json_string(command) + R"(,"measures":{)";
+    auto separator = "";
+    for (auto i = std::size_t{0}; i < state.sequence_bank.size(); ++i)
+    {
+        if (state.sequence_bank[i] != previous.sequence_bank[i])
+        {
+            line += separator;
+            line += '"' + std::to_string(i) + R"(":)";
+            line += xen::serialize_measure(state.sequence_bank[i]);
+            separator = ",";
+        }
+    }
+    line += R"(},"names":{)";
+    separator = "";
+    for (auto i = std::size_t{0}; i < state.sequence_names.size(); ++i)
+    {
+        if (state.sequence_names[i] != previous.sequence_names[i])
+        {
+            line += separator;
+            line += '"' + std::to_string(i) + R"(":)";
+            line += to_json_string(state.sequence_names[i]);
+            separator = ",";
+        }
+    }
+    line += "}}\n";
+    return line;
+}
+
+/**
+ * Returns true if a delta line from \p previous can record \p state.
+ */
+[[nodiscard]] auto differs_only_in_bank(xen::SequencerState const &previous,
+                                        xen::SequencerState const &state) -> bool
+{
+    // Copy the bank across and compare the rest, so new fields are never missed.
+    auto rest = previous;
+    rest.sequence_bank = state.sequence_bank;
+    rest.sequence_names = state.sequence_names;
+    return rest == state;
+}
+
+[[nodiscard]] auto parse_index(std::string const &key, std::size_t size) -> std::size_t
+{
+    auto const index = std::stoul(key);
+    if (index >= size)
+    {
+        throw std::out_of_range{"Journal Index Out Of Range: " + key};
+    }
+    return index;
+}
+
+} // namespace
+
+namespace xen
+{
+
+Autosave::Autosave() : Autosave{get_autosave_directory}
+{
+}
+
+Autosave::Autosave(std::function<juce::File()> directory)
+    : directory_{std::move(directory)}, thread_{[this] { this->run(); }}
+{
+}
+
+Autosave::~Autosave()
+{
+    {
+        auto const lock = std::lock_guard{mtx_};
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void Autosave::append(std::string command, std::shared_ptr<SequencerState const> state,
+                      std::string instance_id)
+{
+    {
+        auto const lock = std::lock_guard{mtx_};
+        pending_.push_back({
+            .command = std::move(command),
+            .state = std::move(state),
+            .instance_id = std::move(instance_id),
+        });
+    }
+    cv_.notify_one();
+}
+
+void Autosave::find_recoverable(std::string instance_id,
+                                std::function<void(bool)> on_done)
+{
+    {
+        auto const lock = std::lock_guard{mtx_};
+        pending_searches_.push_back({
+            .instance_id = std::move(instance_id),
+            .on_done = std::move(on_done),
+        });
+    }
+    cv_.notify_one();
+}
+
+void Autosave::run()
+{
+    auto lock = std::unique_lock{mtx_};
+    while (true)
+    {
+        cv_.wait(lock, [this] {
+            return stop_ || !pending_.empty() || !pending_searches_.empty();
+        });
+
+        if (!pending_.empty())
+        {
+            // Wait for any commits that closely follow, so they share one flush.
+            cv_.wait_for(lock, batch_interval, [this] { return stop_; });
+        }
+
+        auto const batch = std::move(pending_);
+        pending_.clear();
+        auto const searches = std::move(pending_searches_);
+        pending_searches_.clear();
+        auto const stop = stop_;
+        lock.unlock();
+
+        this->write_batch(batch);
+
+        if (stop)
+        {
+            this->close_journal();
+            return;
+        }
+
+        for (auto const &search : searches)
+        {
+            this->run_search(search);
+        }
+        lock.lock();
+    }
+}
+
+void Autosave::open_journal(std::string const &instance_id)
+{
+    journal_instance_id_ = instance_id;
+    written_ = Entry{};
+    line_count_ = 0;
+    byte_count_ = 0;
+
+    try
+    {
+        auto const journal =
+            directory_().getChildFile(journal_filename(instance_id, session_id_));
+
+        {
+            auto const lock = std::lock_guard{open_journals().mtx};
+            open_journals().names.insert(journal.getFullPathName().toStdString());
+        }
+        journal_ = journal;
+
+        // Locked before the file exists, so other processes never see it unowned.
+        journal_lock_ = std::make_unique<juce::InterProcessLock>(
+            journal_lock_name(journal));
+        if (!journal_lock_->enter(0))
+        {
+            return;
+        }
+
+        auto out = std::make_unique<juce::FileOutputStream>(journal);
+        if (out->failedToOpen())
+        {
+            return;
+        }
+        out_ = std::move(out);
+    }
+    catch (std::exception const &)
+    {
+        // Autosave is unavailable, commits are discarded.
+    }
+}
+
+void Autosave::write_batch(std::vector<Entry> const &batch)
+{
+    for (auto const &entry : batch)
+    {
+        if (entry.instance_id != journal_instance_id_)
+        {
+            // The host restored another instance's state into this one, the work
+            // journaled so far belongs to the previous id and is not needed.
+            this->close_journal();
+            this->open_journal(entry.instance_id);
+        }
+        if (out_ == nullptr)
+        {
+            continue;
+        }
+
+        try
+        {
+            auto const line =
+                written_.state != nullptr &&
+                        differs_only_in_bank(*written_.state, *entry.state)
+                    ? delta_line(entry.command, *written_.state, *entry.state)
+                    : snapshot_line(entry.command, *entry.state);
+            out_->write(line.data(), line.size());
+            written_ = entry;
+            line_count_ += 1;
+            byte_count_ += line.size();
+        }
+        catch (std::exception const &)
+        {
+            // Skipped, the next line is a snapshot so the journal stays consistent.
+            written_ = Entry{};
+        }
+    }
+
+    if (out_ == nullptr)
+    {
+        return;
+    }
+
+    // FileOutputStream::flush() also syncs the file to disk, with fsync or
+    // FlushFileBuffers, so this is the one sync for the batch.
+    out_->flush();
+    if (out_->getStatus().failed())
+    {
+        // What reached the disk is unknown, start again from a snapshot.
+        written_ = Entry{};
+    }
+
+    if (written_.state != nullptr &&
+        (line_count_ >= compact_line_count || byte_count_ >= compact_byte_count))
+    {
+        this->compact();
+    }
+}
+
+void Autosave::run_search(Search const &search) const
+{
+    auto found = false;
+    try
+    {
+        found = !find_recoverable_journals(directory_(), search.instance_id).empty();
+    }
+    catch (std::exception const &)
+    {
+        // The directory can't be read, there is nothing to recover from it.
+    }
+    search.on_done(found);
+}
+
+void Autosave::compact()
+{
+    try
+    {
+        auto const line = snapshot_line(written_.command, *written_.state);
+
+        // replaceWithData writes a temporary file first, the old journal is kept if
+        // this is interrupted.
+        out_ = nullptr;
+        if (journal_.replaceWithData(line.data(), line.size()))
+        {
+            line_count_ = 1;
+            byte_count_ = line.size();
+        }
+    }
+    catch (std::exception const &)
+    {
+        // The journal is left as it is, compaction is tried again after the next batch.
+    }
+
+    if (out_ == nullptr)
+    {
+        auto out = std::make_unique<juce::FileOutputStream>(journal_);
+        if (!out->failedToOpen())
+        {
+            out_ = std::move(out);
+        }
+    }
+}
+
+void Autosave::close_journal()
+{
+    if (out_ != nullptr)
+    {
+        out_ = nullptr;
+        journal_.deleteFile();
+    }
+    journal_lock_ = nullptr;
+
+    auto const lock = std::lock_guard{open_journals().mtx};
+    open_journals().names.erase(journal_.getFullPathName().toStdString());
+}
+
+auto find_recoverable_journals(juce::File const &directory,
+                               std::string const &instance_id)
+    -> std::vector<juce::File>
+{
+    auto const expired = juce::Time::getCurrentTime() - juce::RelativeTime::days(30);
+    auto journals = std::vector<juce::File>{};
+
+    for (auto const &journal :
+         directory.findChildFiles(juce::File::findFiles, false, "*.journal"))
+    {
+        {
+            auto const lock = std::lock_guard{open_journals().mtx};
+            if (open_journals().names.contains(journal.getFullPathName().toStdString()))
+            {
+                continue;
+            }
+        }
+
+        auto lock = juce::InterProcessLock{journal_lock_name(journal)};
+        if (!lock.enter(0))
+        {
+            continue; // In use by another process.
+        }
+
+        if (journal.getLastModificationTime() < expired || journal.getSize() == 0)
+        {
+            journal.deleteFile();
+            continue;
+        }
+        if (journal_instance_id(journal) == instance_id)
+        {
+            journals.push_back(journal);
+        }
+    }
+
+    std::ranges::sort(journals, [](juce::File const &a, juce::File const &b) {
+        return a.getLastModificationTime() > b.getLastModificationTime();
+    });
+    return journals;
+}
+
+auto read_journal(juce::File const &journal) -> RecoveredSession
+{
+    auto data = juce::MemoryBlock{};
+    if (!journal.loadFileAsData(data))
+    {
+        throw std::runtime_error{"Unable To Read Journal: " +
+                                 journal.getFullPathName().toStdString()};
+    }
+    auto const text =
+        std::string_view{static_cast<char const *>(data.getData()), data.getSize()};
+
+    auto session = std::optional<RecoveredSession>{};
+    for (auto begin = std::size_t{0}, end = text.find('\n');
+         end != std::string_view::npos; begin = end + 1, end = text.find('\n', begin))
+    {
+        auto const line =
+            nlohmann::json::parse(text.substr(begin, end - begin), nullptr, false);
+        if (!line.is_object() || (!session.has_value() && !line.contains("state")))
+        {
+            break;
+        }
+
+        try
+        {
+            auto next = RecoveredSession{
+                .state = line.contains("state")
+                             ? deserialize_plugin(line.at("state").dump())
+                             : session->state,
+                .last_command = line.at("command").get<std::string>(),
+            };
+            if (line.contains("measures"))
+            {
+                auto &bank = next.state.sequence_bank;
+                for (auto const &[key, measure] : line.at("measures").items())
+                {
+                    bank[parse_index(key, bank.size())] =
+                        deserialize_measure(measure.dump());
+                }
+                auto &names = next.state.sequence_names;
+                for (auto const &[key, name] : line.at("names").items())
+                {
+                    names[parse_index(key, names.size())] = name.get<std::string>();
+                }
+            }
+            session = std::move(next);
+        }
+        catch (std::exception const &)
+        {
+            break; // Damaged, the previous line is the last known good state.
+        }
+    }
+
+    if (!session.has_value())
+    {
+        throw std::runtime_error{"Journal Has No Snapshot: " +
+                                 journal.getFullPathName().toStdString()};
+    }
+    return std::move(*session);
+}
+
+} // namespace xen
@@ -0,0 +1,139 @@
+#include <xen/background_worker.hpp>
+
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <xen/message_level.hpp>
+
+namespace xen
+{
+
+void TaskContext::cancel()
+{
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+auto TaskContext::is_cancelled() const -> bool
+{
+    return cancelled_.load(std::memory_order_relaxed);
+}
+
+// -------------------------------------------------------------------------------------
+
+BackgroundWorker::~BackgroundWorker()
+{
+    if (task_ != nullptr)
+    {
+        task_->context.cancel();
+        task_->thread.join();
+    }
+}
+
+void BackgroundWorker::start(std::string description, TaskWork work)
+{
+    if (task_ != nullptr)
+    {
+        throw std::runtime_error{"Busy: " + task_->description + " in progress"};
+    }
+
+    task_ = std::make_unique<Task>();
+    task_->description = std::move(description);
+
+    // The thread only touches the Task it was given, which outlives it.
+    task_->thread = std::thread{[task = task_.get(), work = std::move(work)] {
+        auto result = TaskResult{};
+        try
+        {
+            result = work(task->context);
+        }
+        catch (std::exception const &e)
+        {
+            result = [message = std::string{e.what()}](PluginState &) {
+                return merror(message);
+            };
+        }
+        catch (...)
+        {
+            result = [](PluginState &) { return merror("Unknown error"); };
+        }
+
+        task->result = std::move(result);
+        task->finished.store(true, std::memory_order_release);
+    }};
+}
+
+void BackgroundWorker::then(TaskResult next)
+{
+    if (task_ == nullptr)
+    {
+        throw std::logic_error{"No task to continue"};
+    }
+    task_->next = std::move(next);
+}
+
+auto BackgroundWorker::is_busy() const -> bool
+{
+    return task_ != nullptr;
+}
+
+auto BackgroundWorker::description() const -> std::string
+{
+    return task_ == nullptr ? std::string{} : task_->description;
+}
+
+auto BackgroundWorker::cancel() -> bool
+{
+    if (task_ == nullptr)
+    {
+        return false;
+    }
+    task_->context.cancel();
+    return true;
+}
+
+auto BackgroundWorker::take_result() -> std::optional<TaskResult>
+{
+    if (task_ == nullptr || !task_->finished.load(std::memory_order_acquire))
+    {
+        return std::nullopt;
+    }
+    return this->wait();
+}
+
+auto BackgroundWorker::wait() -> std::optional<TaskResult>
+{
+    if (task_ == nullptr)
+    {
+        return std::nullopt;
+    }
+    task_->thread.join();
+
+    // Checked after joining so a cancel that lands after the work has finished, but
+    // before its result is taken, still discards the result.
+    auto result = task_->context.is_cancelled()
+                      ? TaskResult{[message = task_->description + " cancelled"](
+                                       PluginState &) { return mwarning(message); }}
+                      : std::move(task_->result);
+    if (!task_->context.is_cancelled() && task_->next)
+    {
+        result = [first = std::move(result),
+                  next = std::move(task_->next)](PluginState &ps) {
+            auto const status = first(ps);
+            if (status.first == MessageLevel::Error)
+            {
+                return status;
+            }
+            auto const next_status = next(ps);
+            return next_status.first > status.first ? next_status : status;
+        };
+    }
+    task_.reset();
+    return result;
+}
+
+} // namespace xen
@@ -0,0 +1,463 @@
+#include <xen/binary_serialize.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <sequence/sequence.hpp>
+
+#include <xen/state.hpp>
+
+namespace
+{
+
+using namespace xen;
+
+enum class NodeType : std::uint8_t
+{
+    Rest = 0,
+    Note = 1,
+    Sequence = 2,
+};
+
+constexpr auto header_size = std::size_t{16};
+constexpr auto section_entry_size = std::size_t{16};
+constexpr auto node_size = std::size_t{24};
+constexpr auto measure_size = std::size_t{12};
+
+// Deeper nesting than this is treated as a corrupt file, not a stack overflow.
+constexpr auto max_depth = 512;
+
+constexpr auto node_section = std::array<char, 4>{'N', 'O', 'D', 'E'};
+constexpr auto measure_section = std::array<char, 4>{'M', 'E', 'A', 'S'};
+constexpr auto string_section = std::array<char, 4>{'S', 'T', 'R', 'S'};
+
+/**
+ * Appends little-endian values to a byte string.
+ */
+class Writer
+{
+  public:
+    std::string bytes;
+
+  public:
+    void u8(std::uint8_t x)
+    {
+        bytes.push_back(static_cast<char>(x));
+    }
+
+    void u16(std::uint16_t x)
+    {
+        this->u8(static_cast<std::uint8_t>(x));
+        this->u8(static_cast<std::uint8_t>(x >> 8));
+    }
+
+    void u32(std::uint32_t x)
+    {
+        this->u16(static_cast<std::uint16_t>(x));
+        this->u16(static_cast<std::uint16_t>(x >> 16));
+    }
+
+    void i32(std::int32_t x)
+    {
+        this->u32(static_cast<std::uint32_t>(x));
+    }
+
+    void f32(float x)
+    {
+        this->u32(std::bit_cast<std::uint32_t>(x));
+    }
+
+    void tag(std::array<char, 4> const &id)
+    {
+        bytes.append(id.data(), id.size());
+    }
+
+    void patch_u32(std::size_t at, std::uint32_t x)
+    {
+        for (auto i = std::size_t{0}; i < 4; ++i)
+        {
+            bytes[at + i] = static_cast<char>(x >> (8 * i));
+        }
+    }
+};
+
+/**
+ * Reads little-endian values from a byte span, with bounds checks.
+ */
+class Reader
+{
+  public:
+    explicit Reader(std::span<std::byte const> bytes) : bytes_{bytes}
+    {
+    }
+
+  public:
+    [[nodiscard]] auto size() const -> std::size_t
+    {
+        return bytes_.size();
+    }
+
+    [[nodiscard]] auto u8(std::size_t at) const -> std::uint8_t
+    {
+        this->check(at, 1);
+        return static_cast<std::uint8_t>(bytes_[at]);
+    }
+
+    [[nodiscard]] auto u16(std::size_t at) const -> std::uint16_t
+    {
+        this->check(at, 2);
+        return static_cast<std::uint16_t>(static_cast<unsigned>(bytes_[at]) |
+                                          static_cast<unsigned>(bytes_[at + 1]) << 8);
+    }
+
+    [[nodiscard]] auto u32(std::size_t at) const -> std::uint32_t
+    {
+        this->check(at, 4);
+        return static_cast<std::uint32_t>(this->u16(at)) |
+               static_cast<std::uint32_t>(this->u16(at + 2)) << 16;
+    }
+
+    [[nodiscard]] auto i32(std::size_t at) const -> std::int32_t
+    {
+        return static_cast<std::int32_t>(this->u32(at));
+    }
+
+    [[nodiscard]] auto f32(std::size_t at) const -> float
+    {
+        return std::bit_cast<float>(this->u32(at));
+    }
+
+    [[nodiscard]] auto tag(std::size_t at) const -> std::array<char, 4>
+    {
+        this->check(at, 4);
+        auto result = std::array<char, 4>{};
+        for (auto i = std::size_t{0}; i < 4; ++i)
+        {
+            result[i] = static_cast<char>(bytes_[at + i]);
+        }
+        return result;
+    }
+
+    [[nodiscard]] auto string(std::size_t at, std::size_t size) const -> std::string
+    {
+        this->check(at, size);
+        return std::string(reinterpret_cast<char const *>(bytes_.data() + at), size);
+    }
+
+    /**
+     * Return a Reader over \p size bytes starting at \p at.
+     */
+    [[nodiscard]] auto sub(std::size_t at, std::size_t size) const -> Reader
+    {
+        this->check(at, size);
+        return Reader{bytes_.subspan(at, size)};
+    }
+
+  private:
+    void check(std::size_t at, std::size_t size) const
+    {
+        if (at > bytes_.size() || size > bytes_.size() - at)
+        {
+            throw std::invalid_argument{"Binary sequence bank is truncated"};
+        }
+    }
+
+  private:
+    std::span<std::byte const> bytes_;
+};
+
+// -------------------------------------------------------------------------------------
+
+[[nodiscard]] auto count_nodes(sequence::Cell const &cell) -> std::size_t
+{
+    auto count = std::size_t{1};
+    if (auto const *seq = std::get_if<sequence::Sequence>(&cell.element))
+    {
+        for (auto const &child : seq->cells)
+        {
+            count += count_nodes(child);
+        }
+    }
+    return count;
+}
+
+void write_node(Writer &w, sequence::Cell const &cell)
+{
+    auto const *const note = std::get_if<sequence::Note>(&cell.element);
+    auto const *const seq = std::get_if<sequence::Sequence>(&cell.element);
+    auto const type = (note != nullptr)  ? NodeType::Note
+                      : (seq != nullptr) ? NodeType::Sequence
+                                         : NodeType::Rest;
+
+    w.u8(static_cast<std::uint8_t>(type));
+    w.u8(0);
+    w.u16(0);
+    w.f32(cell.weight);
+
+    if (note != nullptr)
+    {
+        w.i32(note->pitch);
+        w.f32(note->velocity);
+        w.f32(note->delay);
+        w.f32(note->gate);
+    }
+    else if (seq != nullptr)
+    {
+        w.u32(static_cast<std::uint32_t>(seq->cells.size()));
+        w.u32(0);
+        w.u32(0);
+        w.u32(0);
+        for (auto const &child : seq->cells)
+        {
+            write_node(w, child);
+        }
+    }
+    else
+    {
+        w.u32(0);
+        w.u32(0);
+        w.u32(0);
+        w.u32(0);
+    }
+}
+
+/**
+ * Build the Cell tree rooted at node \p index, advancing \p index past it.
+ */
+[[nodiscard]] auto read_node(Reader const &nodes, std::size_t count, std::size_t &index,
+                             int depth) -> sequence::Cell
+{
+    if (index >= count)
+    {
+        throw std::invalid_argument{"Binary sequence bank node index out of range"};
+    }
+    if (depth > max_depth)
+    {
+        throw std::invalid_argument{"Binary sequence bank nesting is too deep"};
+    }
+
+    auto const at = index++ * node_size;
+    auto const weight = nodes.f32(at + 4);
+
+    switch (static_cast<NodeType>(nodes.u8(at)))
+    {
+    case NodeType::Rest:
+        return {.element = sequence::Rest{}, .weight = weight};
+
+    case NodeType::Note:
+        return {
+            .element =
+                sequence::Note{
+                    .pitch = nodes.i32(at + 8),
+                    .velocity = nodes.f32(at + 12),
+                    .delay = nodes.f32(at + 16),
+                    .gate = nodes.f32(at + 20),
+                },
+            .weight = weight,
+        };
+
+    case NodeType::Sequence: {
+        auto const child_count = std::size_t{nodes.u32(at + 8)};
+
+        // Each child is at least one node, this rejects corrupt counts before
+        // allocating for them.
+        if (child_count > count - index)
+        {
+            throw std::invalid_argument{"Binary sequence bank child count is invalid"};
+        }
+
+        auto seq = sequence::Sequence{};
+        seq.cells.reserve(child_count);
+        for (auto i = std::size_t{0}; i < child_count; ++i)
+        {
+            seq.cells.push_back(read_node(nodes, count, index, depth + 1));
+        }
+        return {.element = std::move(seq), .weight = weight};
+    }
+    }
+
+    throw std::invalid_argument{"Binary sequence bank has an unknown node type"};
+}
+
+} // namespace
+
+namespace xen
+{
+
+auto is_binary_sequence_bank(std::span<std::byte const> bytes) -> bool
+{
+    return bytes.size() >= binary_bank::magic.size() &&
+           std::equal(std::cbegin(binary_bank::magic), std::cend(binary_bank::magic),
+                      std::cbegin(bytes), [](char a, std::byte b) {
+                          return static_cast<std::byte>(a) == b;
+                      });
+}
+
+auto serialize_sequence_bank_binary(SequenceBank const &bank,
+                                    std::array<std::string, 16> const &sequence_names)
+    -> std::string
+{
+    auto node_count = std::size_t{0};
+    auto string_bytes = std::size_t{0};
+    for (auto const &measure : bank)
+    {
+        node_count += count_nodes(measure.cell);
+    }
+    for (auto const &name : sequence_names)
+    {
+        string_bytes += name.size();
+    }
+
+    auto w = Writer{};
+    w.bytes.reserve(header_size + 3 * section_entry_size + 4 + node_count * node_size +
+                    bank.size() * measure_size + 4 + 8 * sequence_names.size() +
+                    string_bytes);
+
+    // Header
+    w.tag(binary_bank::magic);
+    w.u16(binary_bank::version);
+    w.u16(0);
+    w.u32(3);
+    w.u32(0);
+
+    // Section table, offsets and sizes are patched once each section is written.
+    auto const table_at = w.bytes.size();
+    for (auto const &id : {node_section, measure_section, string_section})
+    {
+        w.tag(id);
+        w.u32(0);
+        w.u32(0);
+        w.u32(0);
+    }
+    auto const begin_section = [&](std::size_t section) {
+        w.patch_u32(table_at + section * section_entry_size + 8,
+                    static_cast<std::uint32_t>(w.bytes.size()));
+        return w.bytes.size();
+    };
+    auto const end_section = [&](std::size_t section, std::size_t begin) {
+        w.patch_u32(table_at + section * section_entry_size + 12,
+                    static_cast<std::uint32_t>(w.bytes.size() - begin));
+    };
+
+    // Nodes
+    auto const nodes_at = begin_section(0);
+    w.u32(static_cast<std::uint32_t>(node_count));
+    auto roots = std::array<std::uint32_t, 16>{};
+    auto next_root = std::size_t{0};
+    for (auto i = std::size_t{0}; i < bank.size(); ++i)
+    {
+        roots[i] = static_cast<std::uint32_t>(next_root);
+        next_root += count_nodes(bank[i].cell);
+        write_node(w, bank[i].cell);
+    }
+    end_section(0, nodes_at);
+
+    // Measures
+    auto const measures_at = begin_section(1);
+    for (auto i = std::size_t{0}; i < bank.size(); ++i)
+    {
+        w.u32(roots[i]);
+        w.u32(static_cast<std::uint32_t>(bank[i].time_signature.numerator));
+        w.u32(static_cast<std::uint32_t>(bank[i].time_signature.denominator));
+    }
+    end_section(1, measures_at);
+
+    // Strings
+    auto const strings_at = begin_section(2);
+    w.u32(static_cast<std::uint32_t>(sequence_names.size()));
+    auto offset = std::uint32_t{0};
+    for (auto const &name : sequence_names)
+    {
+        w.u32(offset);
+        w.u32(static_cast<std::uint32_t>(name.size()));
+        offset += static_cast<std::uint32_t>(name.size());
+    }
+    for (auto const &name : sequence_names)
+    {
+        w.bytes += name;
+    }
+    end_section(2, strings_at);
+
+    return std::move(w.bytes);
+}
+
+auto deserialize_sequence_bank_binary(std::span<std::byte const> bytes)
+    -> std::pair<SequenceBank, std::array<std::string, 16>>
+{
+    if (!is_binary_sequence_bank(bytes))
+    {
+        throw std::invalid_argument{"Not a binary sequence bank"};
+    }
+
+    auto const file = Reader{bytes};
+    if (auto const version = file.u16(4); version > binary_bank::version)
+    {
+        throw std::invalid_argument{"Binary sequence bank version " +
+                                    std::to_string(version) + " is not supported"};
+    }
+
+    // Sections can be in any order and unknown sections are skipped.
+    auto nodes = std::optional<Reader>{};
+    auto measures = std::optional<Reader>{};
+    auto strings = std::optional<Reader>{};
+    auto const section_count = std::size_t{file.u32(8)};
+    for (auto i = std::size_t{0}; i < section_count; ++i)
+    {
+        auto const at = header_size + i * section_entry_size;
+        auto const id = file.tag(at);
+        auto const section = file.sub(file.u32(at + 8), file.u32(at + 12));
+        if (id == node_section)
+        {
+            nodes = section;
+        }
+        else if (id == measure_section)
+        {
+            measures = section;
+        }
+        else if (id == string_section)
+        {
+            strings = section;
+        }
+    }
+    if (!nodes || !measures || !strings)
+    {
+        throw std::invalid_argument{"Binary sequence bank is missing a section"};
+    }
+
+    auto result = std::pair<SequenceBank, std::array<std::string, 16>>{};
+    auto &[bank, names] = result;
+
+    auto const node_count = std::size_t{nodes->u32(0)};
+    auto const node_table = nodes->sub(4, node_count * node_size);
+    for (auto i = std::size_t{0}; i < bank.size(); ++i)
+    {
+        auto const at = i * measure_size;
+        auto index = std::size_t{measures->u32(at)};
+        bank[i].cell = read_node(node_table, node_count, index, 0);
+        bank[i].time_signature.numerator = measures->u32(at + 4);
+        bank[i].time_signature.denominator = measures->u32(at + 8);
+    }
+
+    auto const string_count = std::size_t{strings->u32(0)};
+    auto const string_data = 4 + string_count * 8;
+    for (auto i = std::size_t{0}; i < std::min(string_count, names.size()); ++i)
+    {
+        auto const at = 4 + i * 8;
+        names[i] =
+            strings->string(string_data + strings->u32(at), strings->u32(at + 4));
+    }
+
+    return result;
+}
+
+} // namespace xen
@@ -8,6 +8,8 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <embed_tables.hpp>
+
 #include <xen/constants.hpp>
 #include <xen/user_directory.hpp>
 
@@ -32,23 +34,38 @@ struct convert<::xen::Chord>
 namespace xen
 {
 
-auto load_chords_from_files() -> std::vector<Chord>
+auto get_system_chords() -> std::vector<Chord>
+{
+    auto chords = std::vector<Chord>{};
+    chords.reserve(embed_tables::chords.size());
+    for (auto const &entry : embed_tables::chords)
+    {
+        chords.push_back({
+            .name = std::string{entry.name},
+            .intervals = {std::cbegin(entry.intervals), std::cend(entry.intervals)},
+        });
+    }
+    return chords;
+}
+
+auto load_user_chords() -> std::vector<Chord>
 {
-    auto const system_node =
-        YAML::LoadFile(get_system_chords_file().getFullPathName().toStdString());
     auto const user_node =
         YAML::LoadFile(get_user_chords_file().getFullPathName().toStdString());
-
-    auto system_chords = system_node["chords"].as<std::vector<Chord>>();
-    auto user_chords = std::vector<Chord>{};
     if (user_node["chords"])
     {
-        user_chords = user_node["chords"].as<std::vector<Chord>>();
+        return user_node["chords"].as<std::vector<Chord>>();
     }
-    system_chords.insert(std::end(system_chords),
-                         std::make_move_iterator(std::begin(user_chords)),
-                         std::make_move_iterator(std::end(user_chords)));
-    return system_chords;
+    return {};
+}
+
+auto load_chords_from_files() -> std::vector<Chord>
+{
+    auto chords = get_system_chords();
+    auto user_chords = load_user_chords();
+    chords.insert(std::end(chords), std::make_move_iterator(std::begin(user_chords)),
+                  std::make_move_iterator(std::end(user_chords)));
+    return chords;
 }
 
 auto find_chord(std::vector<Chord> const &chords, std::string const &name) -> Chord
@@ -1,11 +1,17 @@
 #include <xen/command.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include <sequence/pattern.hpp>
 
 #include <xen/string_manip.hpp>
 
-#include <string>
-
 namespace xen
 {
 
@@ -27,6 +33,26 @@ auto split_input(std::string input) -> SplitInput
     return split_input;
 }
 
+auto prepare_command_string(std::string const &command_string)
+    -> std::vector<PreparedCommand>
+{
+    auto result = std::vector<PreparedCommand>{};
+    for (auto &command : split(command_string, ';'))
+    {
+        command = minimize_spaces(command);
+        if (command.empty())
+        {
+            continue;
+        }
+        auto input = split_input(command);
+        result.push_back(PreparedCommand{
+            .text = std::move(command),
+            .input = std::move(input),
+        });
+    }
+    return result;
+}
+
 // -------------------------------------------------------------------------------------
 
 CommandGroup::CommandGroup(std::string_view id) : id_{id}
@@ -35,6 +61,23 @@ CommandGroup::CommandGroup(std::string_view id) : id_{id}
 
 void CommandGroup::add(std::unique_ptr<CommandBase> cmd)
 {
+    auto lowered = to_lower(cmd->id());
+
+    auto const at = std::lower_bound(
+        std::begin(index_), std::end(index_), lowered,
+        [](IndexEntry const &entry, std::string const &x) { return entry.lowered_id < x; });
+
+    if (at != std::end(index_) && at->lowered_id == lowered)
+    {
+        throw std::invalid_argument{"Duplicate command id in group " +
+                                    single_quote(std::string{id_}) + ": " +
+                                    single_quote(std::string{cmd->id()})};
+    }
+
+    index_.insert(at, IndexEntry{
+                          .lowered_id = std::move(lowered),
+                          .order = commands_.size(),
+                      });
     commands_.push_back(std::move(cmd));
 }
 
@@ -51,14 +94,11 @@ auto CommandGroup::execute(PluginState &ps, SplitInput input) const
         return {MessageLevel::Error, "No command given."};
     }
 
-    auto const front = to_lower(input.words.front());
-    for (auto const &command_ptr : commands_)
+    if (CommandBase *const command = this->find_exact(to_lower(input.words.front()));
+        command != nullptr)
     {
-        if (front == to_lower(command_ptr->id()))
-        {
-            input.words.erase(input.words.begin());
-            return command_ptr->execute(ps, input);
-        }
+        input.words.erase(input.words.begin());
+        return command->execute(ps, std::move(input));
     }
 
     return {MessageLevel::Error, "Command not found: " + input.words.front()};
@@ -71,34 +111,58 @@ auto CommandGroup::complete_text(SplitInput input) const -> std::string
         return "[next command]";
     }
 
+    auto const lowered = to_lower(input.words.front());
+
     // Search for a complete match.
-    for (auto const &command_ptr : commands_)
+    if (CommandBase *const command = this->find_exact(lowered); command != nullptr)
     {
-        CommandBase &cmd = *command_ptr;
-
-        if (to_lower(cmd.id()) == to_lower(input.words.front()))
-        {
-            input.words.erase(input.words.begin());
-            return cmd.complete_text(input);
-        }
+        input.words.erase(input.words.begin());
+        return command->complete_text(std::move(input));
     }
 
     // If no complete match, search for first partial match.
-    for (auto const &command_ptr : commands_)
+    if (CommandBase const *const command = this->find_prefix(lowered);
+        command != nullptr)
     {
-        CommandBase const &cmd = *command_ptr;
-
-        if (to_lower(cmd.id().substr(0, input.words.front().size())) ==
-            to_lower(input.words.front()))
-        {
-            return std::string{cmd.id().substr(input.words.front().size())};
-        }
+        return std::string{command->id().substr(lowered.size())};
     }
 
     return "";
 }
 
-auto CommandGroup::generate_docs() -> std::vector<Documentation>
+auto CommandGroup::find_exact(std::string_view lowered_id) const -> CommandBase *
+{
+    auto const at = std::lower_bound(std::cbegin(index_), std::cend(index_), lowered_id,
+                                     [](IndexEntry const &entry, std::string_view x) {
+                                         return entry.lowered_id < x;
+                                     });
+
+    if (at == std::cend(index_) || at->lowered_id != lowered_id)
+    {
+        return nullptr;
+    }
+    return commands_[at->order].get();
+}
+
+auto CommandGroup::find_prefix(std::string_view lowered_prefix) const -> CommandBase *
+{
+    // All ids sharing the prefix are contiguous in the sorted index, the earliest added
+    // among them wins so that completion is stable with respect to tree construction.
+    auto at = std::lower_bound(std::cbegin(index_), std::cend(index_), lowered_prefix,
+                               [](IndexEntry const &entry, std::string_view x) {
+                                   return entry.lowered_id < x;
+                               });
+
+    auto best = commands_.size();
+    for (; at != std::cend(index_) && at->lowered_id.starts_with(lowered_prefix); ++at)
+    {
+        best = std::min(best, at->order);
+    }
+
+    return best == commands_.size() ? nullptr : commands_[best].get();
+}
+
+auto CommandGroup::generate_docs() const -> std::vector<Documentation>
 {
     auto result = std::vector<Documentation>{};
     for (auto &command : commands_)
@@ -0,0 +1,369 @@
+#include <xen/completion_index.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <xen/command.hpp>
+#include <xen/string_manip.hpp>
+
+namespace
+{
+
+/**
+ * Match \p lowered_abbreviation as an in-order subsequence of \p id that begins with
+ * its first character.
+ *
+ * @return The number of matched characters that begin a word within \p id, the first
+ * character or an uppercase letter, or std::nullopt if there is no match.
+ */
+[[nodiscard]] auto abbreviation_score(std::string_view lowered_abbreviation,
+                                      std::string_view id, std::string_view lowered_id)
+    -> std::optional<std::size_t>
+{
+    if (lowered_abbreviation.empty() || lowered_id.empty() ||
+        lowered_abbreviation.front() != lowered_id.front())
+    {
+        return std::nullopt;
+    }
+
+    auto score = std::size_t{0};
+    auto at = std::size_t{0};
+    for (auto const ch : lowered_abbreviation)
+    {
+        at = lowered_id.find(ch, at);
+        if (at == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+        if (at == 0 || std::isupper(static_cast<unsigned char>(id[at])))
+        {
+            ++score;
+        }
+        ++at;
+    }
+    return score;
+}
+
+[[nodiscard]] auto join_from(std::vector<std::string> const &words, std::size_t begin)
+    -> std::string
+{
+    auto result = std::string{};
+    for (auto i = begin; i < words.size(); ++i)
+    {
+        if (!result.empty())
+        {
+            result += ' ';
+        }
+        result += words[i];
+    }
+    return result;
+}
+
+} // namespace
+
+namespace xen
+{
+
+CompletionIndex::CompletionIndex(CommandBase const &tree)
+    : nodes_{Node{
+          .id = "",
+          .lowered_id = "",
+          .order = 0,
+          .children = {},
+          .arguments = std::nullopt,
+      }}
+{
+    // Documentation ids are the full, space separated, path to each Command.
+    for (auto &doc : tree.generate_docs())
+    {
+        auto parent = std::size_t{0};
+        for (auto const &word : xen::split(doc.signature.id, ' '))
+        {
+            auto const lowered = to_lower(word);
+            if (auto const child = this->find_exact(parent, lowered); child.has_value())
+            {
+                parent = *child;
+                continue;
+            }
+
+            auto const index = nodes_.size();
+            nodes_.push_back(Node{
+                .id = word,
+                .lowered_id = lowered,
+                .order = nodes_[parent].children.size(),
+                .children = {},
+                .arguments = std::nullopt,
+            });
+
+            auto &children = nodes_[parent].children;
+            auto const at = std::ranges::lower_bound(
+                children, lowered, {}, [this](std::size_t i) -> std::string const & {
+                    return nodes_[i].lowered_id;
+                });
+            children.insert(at, index);
+            parent = index;
+        }
+        nodes_[parent].arguments = std::move(doc.signature.arguments);
+    }
+}
+
+auto CompletionIndex::guide_text(std::string const &input) -> std::string
+{
+    auto const split = this->split(input);
+    if (!split.has_value())
+    {
+        return "";
+    }
+
+    auto const &resolved = this->resolve(split->complete);
+    if (!resolved.node.has_value())
+    {
+        return "";
+    }
+
+    auto const &node = nodes_[*resolved.node];
+    if (node.arguments.has_value())
+    {
+        auto const count = resolved.argument_count + (split->partial.empty() ? 0 : 1);
+        return join_from(*node.arguments, count);
+    }
+
+    if (split->partial.empty())
+    {
+        return "[next command]";
+    }
+
+    auto const lowered = to_lower(split->partial);
+    if (auto const child = this->find_exact(*resolved.node, lowered); child.has_value())
+    {
+        auto const &arguments = nodes_[*child].arguments;
+        return arguments.has_value() ? join_from(*arguments, 0) : "[next command]";
+    }
+
+    auto const match = this->find_best(*resolved.node, lowered);
+    if (!match.has_value())
+    {
+        return "";
+    }
+    auto const &id = nodes_[match->node].id;
+    return match->is_prefix ? id.substr(lowered.size()) : " (" + id + ")";
+}
+
+auto CompletionIndex::complete(std::string const &input) -> std::optional<std::string>
+{
+    auto const split = this->split(input);
+    if (!split.has_value() || split->partial.empty())
+    {
+        return std::nullopt;
+    }
+
+    auto const &resolved = this->resolve(split->complete);
+    if (!resolved.node.has_value() || nodes_[*resolved.node].arguments.has_value())
+    {
+        return std::nullopt;
+    }
+
+    auto const lowered = to_lower(split->partial);
+    if (this->find_exact(*resolved.node, lowered).has_value())
+    {
+        return std::nullopt;
+    }
+
+    auto const match = this->find_best(*resolved.node, lowered);
+    if (!match.has_value())
+    {
+        return std::nullopt;
+    }
+
+    // The partial word runs from the end of the complete words to the end of input.
+    auto const kept = static_cast<std::size_t>(split->complete.data() - input.data()) +
+                      split->complete.size();
+    return input.substr(0, kept) + nodes_[match->node].id + " ";
+}
+
+void CompletionIndex::record_use(std::string const &command_string)
+{
+    try
+    {
+        for (auto const &command : prepare_command_string(command_string))
+        {
+            auto node = std::size_t{0};
+            for (auto const &word : command.input.words)
+            {
+                if (nodes_[node].arguments.has_value())
+                {
+                    break;
+                }
+                auto const child = this->find_exact(node, to_lower(word));
+                if (!child.has_value())
+                {
+                    break;
+                }
+                node = *child;
+                ++nodes_[node].uses;
+            }
+        }
+    }
+    catch (std::exception const &)
+    {
+        // Unparsable input has nothing to record.
+    }
+}
+
+auto CompletionIndex::split(std::string_view input) const -> std::optional<Split>
+{
+    // Only the last command is being typed.
+    if (auto const semicolon = input.rfind(';'); semicolon != std::string_view::npos)
+    {
+        input.remove_prefix(semicolon + 1);
+    }
+
+    if (input.find_first_not_of(" \t\n\v\f\r") == std::string_view::npos)
+    {
+        return std::nullopt;
+    }
+
+    if (std::isspace(static_cast<unsigned char>(input.back())))
+    {
+        return Split{.complete = input, .partial = ""};
+    }
+
+    // Fast path, the input only grew or shrank within an unquoted last word.
+    if (last_resolved_.has_value() && input.starts_with(last_resolved_->text))
+    {
+        auto const rest = input.substr(last_resolved_->text.size());
+        if (!rest.empty() && rest.find_first_of(" \t\n\v\f\r\"{}") == std::string::npos)
+        {
+            return Split{
+                .complete = input.substr(0, last_resolved_->text.size()),
+                .partial = std::string{rest},
+            };
+        }
+    }
+
+    try
+    {
+        auto const tokens = tokenize(input);
+        if (tokens.empty())
+        {
+            return std::nullopt;
+        }
+        auto const &last = tokens[tokens.size() - 1];
+
+        // A fully quoted token's position is one past its opening quote.
+        auto begin = last.position;
+        if (begin > 0 && input[begin - 1] == '"')
+        {
+            --begin;
+        }
+        return Split{.complete = input.substr(0, begin), .partial = to_string(last)};
+    }
+    catch (ParseError const &)
+    {
+        // Input is mid-edit, such as an open quote, nothing to suggest yet.
+        return std::nullopt;
+    }
+}
+
+auto CompletionIndex::resolve(std::string_view complete) -> Resolved const &
+{
+    if (last_resolved_.has_value() && last_resolved_->text == complete)
+    {
+        return *last_resolved_;
+    }
+
+    auto resolved = Resolved{.text = std::string{complete}, .node = std::size_t{0}};
+    try
+    {
+        for (auto const &word : split_input(resolved.text).words)
+        {
+            if (nodes_[*resolved.node].arguments.has_value())
+            {
+                ++resolved.argument_count;
+                continue;
+            }
+            resolved.node = this->find_exact(*resolved.node, to_lower(word));
+            if (!resolved.node.has_value())
+            {
+                break;
+            }
+        }
+    }
+    catch (ParseError const &)
+    {
+        resolved.node = std::nullopt;
+    }
+
+    last_resolved_ = std::move(resolved);
+    return *last_resolved_;
+}
+
+auto CompletionIndex::find_exact(std::size_t parent, std::string_view lowered_id) const
+    -> std::optional<std::size_t>
+{
+    auto const &children = nodes_[parent].children;
+    auto const at = std::ranges::lower_bound(
+        children, lowered_id, {},
+        [this](std::size_t i) -> std::string_view { return nodes_[i].lowered_id; });
+
+    if (at == std::cend(children) || nodes_[*at].lowered_id != lowered_id)
+    {
+        return std::nullopt;
+    }
+    return *at;
+}
+
+auto CompletionIndex::find_best(std::size_t parent, std::string_view lowered_id) const
+    -> std::optional<Match>
+{
+    auto const &children = nodes_[parent].children;
+
+    // Higher is better, order is negated so that earlier additions win ties.
+    auto const rank = [this](std::size_t i, std::size_t score) {
+        auto const &node = nodes_[i];
+        return std::tuple{node.uses, score, -static_cast<std::ptrdiff_t>(node.order)};
+    };
+
+    // Ids sharing the prefix are contiguous in the sorted children.
+    auto best = std::optional<Match>{};
+    auto at = std::ranges::lower_bound(
+        children, lowered_id, {},
+        [this](std::size_t i) -> std::string_view { return nodes_[i].lowered_id; });
+    for (; at != std::cend(children) && nodes_[*at].lowered_id.starts_with(lowered_id);
+         ++at)
+    {
+        if (!best.has_value() || rank(*at, 0) > rank(best->node, 0))
+        {
+            best = Match{.node = *at, .is_prefix = true};
+        }
+    }
+    if (best.has_value())
+    {
+        return best;
+    }
+
+    auto best_score = std::size_t{0};
+    for (auto const i : children)
+    {
+        auto const score =
+            abbreviation_score(lowered_id, nodes_[i].id, nodes_[i].lowered_id);
+        if (score.has_value() &&
+            (!best.has_value() || rank(i, *score) > rank(best->node, best_score)))
+        {
+            best = Match{.node = i, .is_prefix = false};
+            best_score = *score;
+        }
+    }
+    return best;
+}
+
+} // namespace xen
@@ -1,8 +1,12 @@
 #include <xen/copy_paste.hpp>
 
-#include <exception>
+#include <functional>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <utility>
+
+#include <juce_core/juce_core.h>
 
 #include <sequence/sequence.hpp>
 
@@ -25,36 +29,165 @@ namespace
 namespace xen
 {
 
-void write_copy_buffer(sequence::Cell const &cell)
+Clipboard::Clipboard() : Clipboard{copy_buffer_filepath}
+{
+}
+
+Clipboard::Clipboard(std::function<juce::File()> filepath)
+    : filepath_{std::move(filepath)}, thread_{[this] { this->run(); }}
 {
-    auto const filepath = copy_buffer_filepath();
-    auto const json_str = serialize_cell(cell);
+}
 
-    if (!filepath.create()) // Does not overwrite.
+Clipboard::~Clipboard()
+{
     {
-        throw std::runtime_error{"Failed to create copy buffer"};
+        auto const lock = std::lock_guard{mtx_};
+        stop_ = true;
     }
+    cv_.notify_all();
+    thread_.join();
+}
 
-    // Shared amongst multiple processes, but replaceWithText is 'safe' and atomic.
-    if (!filepath.replaceWithText(json_str))
+void Clipboard::write(sequence::Cell cell)
+{
     {
-        throw std::runtime_error{"Failed to write copy buffer"};
+        auto const lock = std::lock_guard{mtx_};
+        history_.push_front(cell);
+        if (history_.size() > history_size)
+        {
+            history_.pop_back();
+        }
+        pending_write_ = std::move(cell);
     }
+    cv_.notify_all();
 }
 
-auto read_copy_buffer() -> std::optional<sequence::Cell>
+auto Clipboard::read(std::size_t age) -> std::optional<sequence::Cell>
 {
-    auto const filepath = copy_buffer_filepath();
-    auto const json_str = filepath.loadFileAsString().toStdString();
-
-    if (json_str.empty()) // If file does not exist or other error.
+    auto lock = std::unique_lock{mtx_};
+    cv_.wait(lock, [this] { return file_read_; });
+    if (age >= history_.size())
     {
         return std::nullopt;
     }
-    else
+    return history_[age];
+}
+
+void Clipboard::run()
+{
+    auto lock = std::unique_lock{mtx_};
+    this->import_file_if_changed(lock);
+    while (true)
+    {
+        cv_.wait_for(lock, poll_interval,
+                     [this] { return stop_ || pending_write_.has_value(); });
+
+        if (pending_write_.has_value())
+        {
+            auto const cell = std::move(*pending_write_);
+            pending_write_ = std::nullopt;
+            this->write_file(lock, cell);
+        }
+        else if (stop_)
+        {
+            return;
+        }
+        else
+        {
+            this->import_file_if_changed(lock);
+        }
+    }
+}
+
+void Clipboard::import_file_if_changed(std::unique_lock<std::mutex> &lock)
+{
+    lock.unlock();
+    auto stamp = std::optional<FileStamp>{};
+    auto cell = std::optional<sequence::Cell>{};
+    try
     {
-        return deserialize_cell(json_str);
+        auto const filepath = filepath_();
+        stamp = FileStamp{
+            .modified = filepath.getLastModificationTime().toMilliseconds(),
+            .size = filepath.existsAsFile() ? filepath.getSize() : -1,
+        };
+        if (*stamp != known_stamp_)
+        {
+            if (auto const json_str = filepath.loadFileAsString().toStdString();
+                !json_str.empty())
+            {
+                cell = deserialize_cell(json_str);
+            }
+        }
     }
+    catch (...)
+    {
+        // No user library, or the file is partially written or from an incompatible
+        // version. Skip it, paste must not wait on a read that will never finish.
+    }
+    lock.lock();
+
+    if (stamp.has_value())
+    {
+        known_stamp_ = *stamp;
+    }
+    if (cell.has_value())
+    {
+        // A copy made here while the file was first being read is more recent.
+        if (file_read_)
+        {
+            history_.push_front(std::move(*cell));
+        }
+        else
+        {
+            history_.push_back(std::move(*cell));
+        }
+        if (history_.size() > history_size)
+        {
+            history_.pop_back();
+        }
+    }
+    file_read_ = true;
+    cv_.notify_all();
+}
+
+void Clipboard::write_file(std::unique_lock<std::mutex> &lock,
+                           sequence::Cell const &cell)
+{
+    lock.unlock();
+    auto stamp = std::optional<FileStamp>{};
+    try
+    {
+        // Shared with other processes, replaceWithText writes to a temp file first.
+        auto const filepath = filepath_();
+        if (filepath.replaceWithText(serialize_cell(cell)))
+        {
+            stamp = FileStamp{
+                .modified = filepath.getLastModificationTime().toMilliseconds(),
+                .size = filepath.getSize(),
+            };
+        }
+    }
+    catch (...)
+    {
+        // The copy is still available in this process.
+    }
+    lock.lock();
+
+    if (stamp.has_value())
+    {
+        known_stamp_ = *stamp;
+    }
+}
+
+void write_copy_buffer(sequence::Cell const &cell)
+{
+    juce::SharedResourcePointer<Clipboard>{}->write(cell);
+}
+
+auto read_copy_buffer(std::size_t age) -> std::optional<sequence::Cell>
+{
+    return juce::SharedResourcePointer<Clipboard>{}->read(age);
 }
 
-} // namespace xen
\ No newline at end of file
+} // namespace xen
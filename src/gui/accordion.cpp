@@ -12,7 +12,7 @@ namespace xen::gui
 
 VLabel::VLabel(juce::String text)
     : text_{std::move(text)}, letter_spacing_{0.f},
-      font_{fonts::monospaced().regular.withHeight(15.f)}
+      font_{fonts::monospaced().regular().withHeight(15.f)}
 {
 }
 
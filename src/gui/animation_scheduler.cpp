@@ -0,0 +1,163 @@
+#include <xen/gui/animation_scheduler.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <xen/clock.hpp>
+#include <xen/double_buffer.hpp>
+#include <xen/state.hpp>
+
+namespace
+{
+
+// How often an idle scheduler checks for a new audio thread state generation.
+constexpr auto idle_check_interval_ms = 100;
+
+template <typename T>
+void push_unique(std::vector<T> &items, T item)
+{
+    if (std::ranges::find(items, item) == items.end())
+    {
+        items.push_back(item);
+    }
+}
+
+} // namespace
+
+namespace xen::gui
+{
+
+AnimationScheduler::AnimationScheduler(
+    juce::Component &host,
+    DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state)
+    : host_{host}, audio_thread_state_{audio_thread_state},
+      generation_{audio_thread_state.read().generation}
+{
+}
+
+AnimationScheduler::~AnimationScheduler()
+{
+    this->stopTimer();
+    this->cancelPendingUpdate();
+    vblank_ = nullptr;
+}
+
+void AnimationScheduler::add(Client &client)
+{
+    push_unique(clients_, &client);
+    this->start(client);
+}
+
+void AnimationScheduler::remove(Client &client)
+{
+    std::erase(clients_, &client);
+    std::erase(animating_, &client);
+    if (clients_.empty())
+    {
+        this->stopTimer();
+        this->cancelPendingUpdate();
+        vblank_ = nullptr;
+    }
+}
+
+void AnimationScheduler::start(Client &client)
+{
+    push_unique(animating_, &client);
+    if (host_.isShowing())
+    {
+        this->attach();
+    }
+    else if (vblank_ == nullptr)
+    {
+        // Picked up by timerCallback once the host is showing.
+        this->startTimer(idle_check_interval_ms);
+    }
+}
+
+void AnimationScheduler::timerCallback()
+{
+    if (!host_.isShowing())
+    {
+        return;
+    }
+
+    this->wake_if_changed(audio_thread_state_.read().generation);
+    if (!animating_.empty())
+    {
+        this->attach();
+    }
+}
+
+void AnimationScheduler::handleAsyncUpdate()
+{
+    if (animating_.empty() || !host_.isShowing())
+    {
+        this->detach();
+    }
+}
+
+void AnimationScheduler::on_frame()
+{
+    if (!host_.isShowing())
+    {
+        this->triggerAsyncUpdate();
+        return;
+    }
+
+    auto const state = audio_thread_state_.read();
+    auto const now = Clock::now();
+    this->wake_if_changed(state.generation);
+
+    for (auto *const client : std::exchange(animating_, {}))
+    {
+        // A client can remove another from its animate().
+        if (std::ranges::find(clients_, client) != clients_.end() &&
+            client->animate(state, now))
+        {
+            push_unique(animating_, client);
+        }
+    }
+
+    if (animating_.empty())
+    {
+        this->triggerAsyncUpdate();
+    }
+}
+
+void AnimationScheduler::wake_if_changed(std::uint64_t generation)
+{
+    if (generation != generation_)
+    {
+        generation_ = generation;
+        for (auto *const client : clients_)
+        {
+            push_unique(animating_, client);
+        }
+    }
+}
+
+void AnimationScheduler::attach()
+{
+    this->stopTimer();
+    if (vblank_ == nullptr)
+    {
+        vblank_ = std::make_unique<juce::VBlankAttachment>(
+            &host_, [this] { this->on_frame(); });
+    }
+}
+
+void AnimationScheduler::detach()
+{
+    vblank_ = nullptr;
+    if (!clients_.empty())
+    {
+        this->startTimer(idle_check_interval_ms);
+    }
+}
+
+} // namespace xen::gui
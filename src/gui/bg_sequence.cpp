@@ -18,6 +18,7 @@
 #include <sequence/utility.hpp>
 
 #include <xen/gui/cell.hpp>
+#include <xen/gui/staff.hpp>
 #include <xen/utility.hpp>
 
 namespace xen::gui
@@ -135,7 +136,8 @@ auto get_bg_trigger_offset(Clock::time_point fg_start, Clock::time_point bg_star
 
 void paint_bg_active_sequence(IR const &ir, juce::Graphics &g,
                               juce::Rectangle<int> const &bounds,
-                              std::size_t tuning_length, juce::Colour color)
+                              std::size_t tuning_length, PitchRange pitch_range,
+                              juce::Colour color)
 {
     g.setColour(color);
 
@@ -148,7 +150,12 @@ void paint_bg_active_sequence(IR const &ir, juce::Graphics &g,
             bounds.getHeight(),
         };
 
-        auto note_bounds = compute_note_bounds(cell_bounds, note_ir.note, tuning_length);
+        auto note_bounds = compute_note_bounds(cell_bounds, note_ir.note, tuning_length,
+                                               pitch_range);
+        if (note_bounds.isEmpty())
+        {
+            continue;
+        }
 
         auto const height_percent = 0.75f;
         auto const corner_percent = 0.2f;
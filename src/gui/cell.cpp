@@ -18,7 +18,8 @@
 #include <sequence/sequence.hpp>
 #include <sequence/tuning.hpp>
 
-#include <xen/gui/fonts.hpp>
+#include <xen/gui/glyph_atlas.hpp>
+#include <xen/gui/staff.hpp>
 #include <xen/gui/themes.hpp>
 #include <xen/scale.hpp>
 #include <xen/utility.hpp>
@@ -99,6 +100,20 @@ auto generate_note_color(juce::Colour const &base_color, sequence::Note const &n
         .withMultipliedBrightness(std::lerp(1.f, 1.1f, ratio));
 }
 
+/**
+ * Creates a gui::Cell component from a sequence::Cell, including its weight.
+ */
+[[nodiscard]]
+auto create_cell_component(
+    sequence::Cell const &cell,
+    xen::gui::BuildAndAllocateCell const &build_and_allocate_cell)
+    -> std::unique_ptr<xen::gui::Cell>
+{
+    auto ui = std::visit(build_and_allocate_cell, cell.element);
+    ui->weight = cell.weight;
+    return ui;
+}
+
 /**
  * Creates a list of gui::Cell components from a sequence::Sequence.
  * @param seq The sequence to create cells from.
@@ -114,14 +129,31 @@ auto create_cells_components(
     cells.reserve(seq.cells.size());
 
     std::ranges::transform(seq.cells, std::back_inserter(cells), [&](auto const &cell) {
-        auto ui = std::visit(build_and_allocate_cell, cell.element);
-        ui->weight = cell.weight;
-        return ui;
+        return create_cell_component(cell, build_and_allocate_cell);
     });
 
     return cells;
 }
 
+/**
+ * Reconcile the child at index \p at of \p row, replacing it if it is a different kind
+ * of Cell.
+ */
+void reconcile_child(xen::gui::HomogenousRow<xen::gui::Cell> &row, std::size_t at,
+                     sequence::Cell const &previous, sequence::Cell const &next,
+                     xen::gui::BuildAndAllocateCell const &build, bool restyle)
+{
+    auto &child = row.at(at);
+    if (child.reconcile(previous, next, build, restyle))
+    {
+        child.weight = next.weight;
+    }
+    else
+    {
+        row.exchange(at, create_cell_component(next, build));
+    }
+}
+
 } // namespace
 
 // -------------------------------------------------------------------------------------
@@ -131,7 +163,21 @@ namespace xen::gui
 
 void Cell::make_selected()
 {
-    selected_ = true;
+    if (!selected_)
+    {
+        selected_ = true;
+        this->repaint();
+    }
+}
+
+void Cell::clear_selection()
+{
+    if (selected_ || !emphasized_)
+    {
+        selected_ = false;
+        emphasized_ = true;
+        this->repaint();
+    }
 }
 
 void Cell::emphasize_selection(bool emphasized)
@@ -148,6 +194,12 @@ auto Cell::find_child(std::vector<std::size_t> const &indices) -> Cell *
     return indices.empty() ? this : nullptr;
 }
 
+auto Cell::reconcile(sequence::Cell const &, sequence::Cell const &,
+                     BuildAndAllocateCell const &, bool) -> bool
+{
+    return false;
+}
+
 void Cell::paintOverChildren(juce::Graphics &g)
 {
     if (selected_)
@@ -171,6 +223,23 @@ Rest::Rest(sequence::Rest, std::optional<Scale> const &scale,
 {
 }
 
+auto Rest::reconcile(sequence::Cell const &, sequence::Cell const &next,
+                     BuildAndAllocateCell const &build, bool restyle) -> bool
+{
+    if (!std::holds_alternative<sequence::Rest>(next.element))
+    {
+        return false;
+    }
+    if (restyle)
+    {
+        // Not painted, no repaint needed.
+        scale_ = build.scale();
+        tuning_ = build.tuning();
+        scale_translate_direction_ = build.scale_translate_direction();
+    }
+    return true;
+}
+
 void Rest::paint(juce::Graphics &g)
 {
     paint_cell_border(g, this->getLocalBounds(),
@@ -180,12 +249,33 @@ void Rest::paint(juce::Graphics &g)
 // -------------------------------------------------------------------------------------
 
 Note::Note(sequence::Note note, std::optional<Scale> const &scale,
-           sequence::Tuning const &tuning, TranslateDirection scale_translate_direction)
+           sequence::Tuning const &tuning, TranslateDirection scale_translate_direction,
+           PitchRange pitch_range)
     : note_{note}, scale_{scale}, tuning_{tuning},
-      scale_translate_direction_{scale_translate_direction}
+      scale_translate_direction_{scale_translate_direction}, pitch_range_{pitch_range}
 {
 }
 
+auto Note::reconcile(sequence::Cell const &, sequence::Cell const &next,
+                     BuildAndAllocateCell const &build, bool restyle) -> bool
+{
+    auto const *const note = std::get_if<sequence::Note>(&next.element);
+    if (note == nullptr)
+    {
+        return false;
+    }
+    if (restyle || note_ != *note)
+    {
+        note_ = *note;
+        scale_ = build.scale();
+        tuning_ = build.tuning();
+        scale_translate_direction_ = build.scale_translate_direction();
+        pitch_range_ = build.pitch_range();
+        this->repaint();
+    }
+    return true;
+}
+
 void Note::paint(juce::Graphics &g)
 {
     auto const bounds = this->getLocalBounds().reduced(2, 7);
@@ -195,7 +285,18 @@ void Note::paint(juce::Graphics &g)
         generate_note_color(this->findColour(ColorID::ForegroundMedium), note_);
     g.setColour(note_color);
 
-    auto pitch_bounds = compute_note_bounds(bounds, note_, tuning_.intervals.size());
+    auto pitch_bounds =
+        compute_note_bounds(bounds, note_, tuning_.intervals.size(), pitch_range_);
+
+    if (pitch_bounds.isEmpty())
+    {
+        // Outside of the displayed pitches, mark the edge it is beyond.
+        auto const above = pitch_bounds.getY() == bounds.getY();
+        g.fillRect(pitch_bounds.withHeight(2).translated(0, above ? 0 : -2));
+        paint_cell_border(g, this->getLocalBounds(),
+                          this->findColour(ColorID::BackgroundHigh));
+        return;
+    }
 
     g.fillRect(pitch_bounds);
 
@@ -205,14 +306,12 @@ void Note::paint(juce::Graphics &g)
 
     // Octave Text
     g.setColour(this->findColour(ColorID::BackgroundLow));
-    g.setFont(
-        fonts::monospaced().bold.withHeight(std::max(pitch_bounds.getHeight() - 2, 1)));
     auto const octave =
         ::xen::utility::get_octave(note_.pitch, tuning_.intervals.size());
-    g.drawText(
-        generate_octave_display(octave),
-        pitch_bounds.translated(0.f, 1.f + (float)pitch_bounds.getHeight() / 25.f),
-        juce::Justification::centred, false);
+    glyph_atlas_->draw(
+        g, generate_octave_display(octave), std::max(pitch_bounds.getHeight() - 2, 1),
+        pitch_bounds.translated(0.f, 1.f + (float)pitch_bounds.getHeight() / 25.f)
+            .toFloat());
 
     // Cell Border
     paint_cell_border(g, this->getLocalBounds(),
@@ -223,11 +322,13 @@ void Note::paint(juce::Graphics &g)
 
 Sequence::Sequence(sequence::Sequence const &seq, std::optional<Scale> const &scale,
                    sequence::Tuning const &tuning,
-                   TranslateDirection scale_translate_direction)
+                   TranslateDirection scale_translate_direction,
+                   PitchRange pitch_range)
     : cells_{create_cells_components(seq, BuildAndAllocateCell{
                                               scale,
                                               tuning,
                                               scale_translate_direction,
+                                              pitch_range,
                                           })}
 {
     this->addAndMakeVisible(cells_);
@@ -241,6 +342,15 @@ void Sequence::make_selected()
     }
 }
 
+void Sequence::clear_selection()
+{
+    this->Cell::clear_selection();
+    for (auto &cell_ptr : cells_.get_children())
+    {
+        cell_ptr->Cell::clear_selection();
+    }
+}
+
 void Sequence::update_pattern(sequence::Pattern const &pattern)
 {
     for (auto &cell : cells_.get_children())
@@ -272,6 +382,74 @@ auto Sequence::find_child(std::vector<std::size_t> const &indices) -> Cell *
         std::vector(std::next(indices.cbegin()), indices.cend()));
 }
 
+auto Sequence::reconcile(sequence::Cell const &previous, sequence::Cell const &next,
+                         BuildAndAllocateCell const &build, bool restyle) -> bool
+{
+    auto const *const previous_seq = std::get_if<sequence::Sequence>(&previous.element);
+    auto const *const next_seq = std::get_if<sequence::Sequence>(&next.element);
+    if (next_seq == nullptr || previous_seq == nullptr ||
+        previous_seq->cells.size() != cells_.size())
+    {
+        return false;
+    }
+
+    auto const &old_cells = previous_seq->cells;
+    auto const &new_cells = next_seq->cells;
+    auto const shared = std::min(old_cells.size(), new_cells.size());
+
+    auto prefix = std::size_t{0};
+    while (prefix < shared && old_cells[prefix] == new_cells[prefix])
+    {
+        ++prefix;
+    }
+    auto suffix = std::size_t{0};
+    while (suffix < shared - prefix && old_cells[old_cells.size() - 1 - suffix] ==
+                                           new_cells[new_cells.size() - 1 - suffix])
+    {
+        ++suffix;
+    }
+
+    if (restyle)
+    {
+        for (auto i = std::size_t{0}; i < prefix; ++i)
+        {
+            reconcile_child(cells_, i, old_cells[i], new_cells[i], build, true);
+        }
+        for (auto i = std::size_t{1}; i <= suffix; ++i)
+        {
+            reconcile_child(cells_, cells_.size() - i, old_cells[old_cells.size() - i],
+                            new_cells[new_cells.size() - i], build, true);
+        }
+    }
+
+    auto const old_end = old_cells.size() - suffix;
+    auto const new_end = new_cells.size() - suffix;
+    auto at = prefix;
+    auto weight_changed = false;
+    for (; at < old_end && at < new_end; ++at)
+    {
+        if (std::not_equal_to{}(old_cells[at].weight, new_cells[at].weight))
+        {
+            weight_changed = true;
+        }
+        reconcile_child(cells_, at, old_cells[at], new_cells[at], build, restyle);
+    }
+    for (auto i = at; i < old_end; ++i)
+    {
+        cells_.erase(at);
+    }
+    for (; at < new_end; ++at)
+    {
+        cells_.insert(at, create_cell_component(new_cells[at], build));
+    }
+
+    if (weight_changed) // Inserting and erasing lay out the row already.
+    {
+        cells_.update_layout();
+    }
+    return true;
+}
+
 void Sequence::resized()
 {
     cells_.setBounds(this->getLocalBounds());
@@ -281,9 +459,10 @@ void Sequence::resized()
 
 BuildAndAllocateCell::BuildAndAllocateCell(std::optional<Scale> const &scale,
                                            sequence::Tuning const &tuning,
-                                           TranslateDirection scale_translate_direction)
+                                           TranslateDirection scale_translate_direction,
+                                           PitchRange pitch_range)
     : scale_{scale}, tuning_{tuning},
-      scale_translate_direction_{scale_translate_direction}
+      scale_translate_direction_{scale_translate_direction}, pitch_range_{pitch_range}
 {
 }
 
@@ -294,17 +473,20 @@ auto BuildAndAllocateCell::operator()(sequence::Rest r) const -> std::unique_ptr
 
 auto BuildAndAllocateCell::operator()(sequence::Note n) const -> std::unique_ptr<Cell>
 {
-    return std::make_unique<Note>(n, scale_, tuning_, scale_translate_direction_);
+    return std::make_unique<Note>(n, scale_, tuning_, scale_translate_direction_,
+                                  pitch_range_);
 }
 
 auto BuildAndAllocateCell::operator()(sequence::Sequence s) const
     -> std::unique_ptr<Cell>
 {
-    return std::make_unique<Sequence>(s, scale_, tuning_, scale_translate_direction_);
+    return std::make_unique<Sequence>(s, scale_, tuning_, scale_translate_direction_,
+                                      pitch_range_);
 }
 
 auto compute_note_bounds(juce::Rectangle<int> const &bounds, sequence::Note note,
-                         std::size_t tuning_length) -> juce::Rectangle<int>
+                         std::size_t tuning_length, PitchRange pitch_range)
+    -> juce::Rectangle<int>
 {
     if (tuning_length == 0)
     {
@@ -314,21 +496,22 @@ auto compute_note_bounds(juce::Rectangle<int> const &bounds, sequence::Note note
     auto const normalized = xen::utility::normalize_pitch(note.pitch, tuning_length);
     assert(normalized < tuning_length);
 
-    auto const total_height = bounds.getHeight();
-    auto const int_height = total_height / static_cast<int>(tuning_length);
-    auto const remainder = total_height % static_cast<int>(tuning_length);
-
-    auto const row = static_cast<int>(tuning_length - 1 - normalized);
-    auto const y = bounds.getY() + row * int_height + std::min(row, remainder);
-    auto const h = int_height + (row < remainder ? 1 : 0);
-
     auto const x =
         bounds.getX() + static_cast<int>((bounds.getWidth() - 1) * note.delay);
     auto const remaining = bounds.getWidth() - (x - bounds.getX());
     auto const w = std::max(static_cast<int>(remaining * note.gate), 4);
 
+    pitch_range = clamp_pitch_range(pitch_range, tuning_length);
+    auto const row = pitch_row(bounds, pitch_range, normalized);
+    if (!row.has_value())
+    {
+        auto const above = normalized >= pitch_range.first + pitch_range.count;
+        return {x, above ? bounds.getY() : bounds.getBottom(), w, 0};
+    }
+
     // Leave room for staff lines (1 pixel at top)
-    return juce::Rectangle<int>{x, y + 1, w, h - 1};
+    return juce::Rectangle<int>{x, row->getStart() + 1, w,
+                                std::max(row->getLength() - 1, 2)};
 }
 
 } // namespace xen::gui
\ No newline at end of file
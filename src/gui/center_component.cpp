@@ -1,5 +1,6 @@
 #include <xen/gui/center_component.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
@@ -25,13 +26,14 @@
 #include <signals_light/signal.hpp>
 
 #include <xen/clock.hpp>
-#include <xen/double_buffer.hpp>
 #include <xen/gui/accordion.hpp>
+#include <xen/gui/animation_scheduler.hpp>
 #include <xen/gui/bg_sequence.hpp>
 #include <xen/gui/cell.hpp>
 #include <xen/gui/fonts.hpp>
 #include <xen/gui/library_view.hpp>
 #include <xen/gui/sequence_bank.hpp>
+#include <xen/gui/staff.hpp>
 #include <xen/gui/themes.hpp>
 #include <xen/scale.hpp>
 #include <xen/selection.hpp>
@@ -78,14 +80,13 @@ std::array<juce::Colour, 16> const bg_colors = [] {
 }();
 
 [[nodiscard]]
-auto generate_bg_state(sequence::Cell const &cell, Clock::time_point fg_start,
+auto generate_bg_state(xen::gui::IR const &ir, Clock::time_point fg_start,
                        Clock::duration fg_duration, Clock::time_point bg_start,
-                       Clock::duration bg_duration, Clock::time_point now,
-                       std::size_t tuning_length) -> xen::gui::MeasureView::BGCurrentState
+                       Clock::duration bg_duration, Clock::time_point now)
+    -> xen::gui::MeasureView::BGCurrentState
 {
     using namespace xen::gui;
     auto const trigger_offset = get_bg_trigger_offset(fg_start, bg_start, bg_duration);
-    auto const ir = generate_ir(cell, tuning_length);
     auto const window = generate_window(fg_duration, bg_start, bg_duration, now);
     auto const windowed_ir = apply_window(ir, window, trigger_offset);
     return {
@@ -94,8 +95,15 @@ auto generate_bg_state(sequence::Cell const &cell, Clock::time_point fg_start,
     };
 }
 
+/**
+ * Fill in \p bg_current for each triggered background measure.
+ *
+ * @details Only measures missing from \p ir_cache have their IR generated, the rest is
+ * windowing the cached IR.
+ */
 void update_all_bg_state(
     std::array<std::optional<xen::gui::MeasureView::BGCurrentState>, 16> &bg_current,
+    std::array<std::optional<xen::gui::IR>, 16> &ir_cache,
     xen::SequenceBank const &sequences,
     std::array<Clock::time_point, 16> const &trigger_starts, std::size_t tuning_length,
     std::size_t fg_index, xen::DAWState const &daw, Clock::time_point now)
@@ -118,9 +126,13 @@ void update_all_bg_state(
             bg_current[i] = std::nullopt;
             continue;
         }
+        if (!ir_cache[i].has_value())
+        {
+            ir_cache[i] = xen::gui::generate_ir(sequences[i].cell, tuning_length);
+        }
         auto const bg_duration = xen::gui::calculate_duration(sequences[i], daw);
-        bg_current[i] = generate_bg_state(sequences[i].cell, fg_start, fg_duration,
-                                          bg_start, bg_duration, now, tuning_length);
+        bg_current[i] = generate_bg_state(*ir_cache[i], fg_start, fg_duration, bg_start,
+                                          bg_duration, now);
     }
 }
 
@@ -138,6 +150,24 @@ auto get_playhead_location(Clock::time_point trigger_start, Clock::time_point no
            (float)measure_duration.count();
 }
 
+/**
+ * Returns the smallest of 1, 2, 5, 10, 20, 50... where that many rows of
+ * \p row_height have room for a label, stopping once it reaches \p count.
+ *
+ * @details \p row_height is fractional, there can be more rows than pixels.
+ */
+[[nodiscard]]
+auto label_step(float row_height, std::size_t count) -> std::size_t
+{
+    constexpr auto min_label_height = 14.f;
+    auto step = std::size_t{1};
+    for (auto i = 0; step < count && (float)step * row_height < min_label_height; ++i)
+    {
+        step = (i % 3 == 1) ? step * 5 / 2 : step * 2;
+    }
+    return step;
+}
+
 /**
  * Initiates the UI cell building process for the top level cell. It's weight is ignored
  * because it is alone.
@@ -146,13 +176,15 @@ auto get_playhead_location(Clock::time_point trigger_start, Clock::time_point no
 auto make_top_level_cell(sequence::Cell const &cell,
                          std::optional<xen::Scale> const &scale,
                          sequence::Tuning const &tuning,
-                         xen::TranslateDirection scale_translate_direction)
+                         xen::TranslateDirection scale_translate_direction,
+                         xen::gui::PitchRange pitch_range)
     -> std::unique_ptr<xen::gui::Cell>
 {
     auto const builder = xen::gui::BuildAndAllocateCell{
         scale,
         tuning,
         scale_translate_direction,
+        pitch_range,
     };
     return std::visit(builder, cell.element);
 }
@@ -178,80 +210,6 @@ auto gather_all_pitches(sequence::Cell const &cell) -> std::set<int>
         cell.element);
 }
 
-/**
- * Returns list of background colors for each pitch in tuning, starting with pitch 0.
- */
-[[nodiscard]]
-auto generate_staff_line_colors(std::optional<xen::Scale> const &scale,
-                                juce::Colour light, std::size_t tuning_length,
-                                xen::TranslateDirection scale_translate_direction)
-    -> std::vector<juce::Colour>
-{
-    auto colors = std::vector<juce::Colour>{};
-    if (scale.has_value())
-    {
-        auto const pitches = xen::generate_valid_pitches(*scale);
-        juce::Colour current_color = light;
-        int previous_pitch = 0;
-
-        for (auto i = 0; i < (int)tuning_length; ++i)
-        {
-            auto const mapped_pitch =
-                map_pitch_to_scale(i, pitches, tuning_length, scale_translate_direction);
-
-            if (mapped_pitch != previous_pitch)
-            {
-                current_color = current_color == light ? light.darker(0.2f) : light;
-            }
-            colors.push_back(current_color);
-            previous_pitch = mapped_pitch;
-        }
-    }
-    else
-    {
-        for (std::size_t i = 0; i < tuning_length; ++i)
-        {
-            colors.push_back((i % 2 == 0) ? light : light.darker(0.2f));
-        }
-    }
-    return colors;
-}
-
-void draw_staff(juce::Graphics &g, juce::Rectangle<int> bounds,
-                juce::Colour lighter_color, std::optional<xen::Scale> const &scale,
-                std::size_t tuning_length,
-                xen::TranslateDirection scale_translate_direction)
-{
-    auto const colors = generate_staff_line_colors(scale, lighter_color, tuning_length,
-                                                   scale_translate_direction);
-    assert(tuning_length == colors.size());
-
-    auto const total_height = bounds.getHeight();
-    auto const int_height = total_height / (int)tuning_length;
-    auto const remainder = total_height % (int)tuning_length;
-
-    // Rectangles
-    auto y = bounds.getY();
-    for (auto i = std::size_t{0}; i < tuning_length; ++i)
-    {
-        auto const extra = (static_cast<int>(i) < remainder) ? 1 : 0;
-        auto const h = int_height + extra;
-
-        auto const color_index = tuning_length - 1 - i;
-        g.setColour(colors[color_index]);
-        if (i == 0)
-        {
-            g.fillRect(bounds.getX(), y, bounds.getWidth(), h);
-        }
-        else // leave space for dividing line
-        {
-            g.fillRect(bounds.getX(), y + 1, bounds.getWidth(), h - 1);
-        }
-
-        y += h;
-    }
-}
-
 } // namespace
 
 // -------------------------------------------------------------------------------------
@@ -308,11 +266,7 @@ void FieldEdit::resized()
     auto flex_box = juce::FlexBox{};
     flex_box.flexDirection = juce::FlexBox::Direction::row;
 
-    auto const width = [&]() {
-        auto glyph_arrangement = juce::GlyphArrangement{};
-        glyph_arrangement.addLineOfText(key_.getFont(), key_.getText(), 0.f, 0.f);
-        return glyph_arrangement.getBoundingBox(0, -1, true).getWidth() + 6.f;
-    }();
+    auto const width = fonts::text_width(key_.getFont(), key_.getText()) + 6.f;
 
     flex_box.items.add(juce::FlexItem{key_}.withWidth(width));
     flex_box.items.add(juce::FlexItem{value_}.withFlex(1));
@@ -339,7 +293,7 @@ MeasureInfo::MeasureInfo()
     this->addAndMakeVisible(measure_name_);
 
     {
-        auto const font = fonts::monospaced().regular.withHeight(17.f);
+        auto const font = fonts::monospaced().regular().withHeight(17.f);
 
         time_signature_.set_font(font);
         key_.set_font(font);
@@ -446,49 +400,100 @@ void MeasureInfo::paintOverChildren(juce::Graphics &g)
 
 // -------------------------------------------------------------------------------------
 
-PitchColumn::PitchColumn(std::size_t size) : size_{size}
+PitchColumn::PitchColumn(PitchRange range) : range_{range}
 {
 }
 
-void PitchColumn::update(std::size_t new_size)
+void PitchColumn::update(PitchRange range)
 {
-    size_ = new_size;
-    this->repaint();
+    if (range_ != range)
+    {
+        range_ = range;
+        this->repaint();
+    }
 }
 
 void PitchColumn::paint(juce::Graphics &g)
+{
+    auto const pixel_scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    auto key = LabelsKey{
+        .width = this->getWidth(),
+        .height = this->getHeight(),
+        .pixel_scale = pixel_scale,
+        .range = range_,
+        .background_color = this->findColour(ColorID::BackgroundHigh).getARGB(),
+        .text_color = this->findColour(ColorID::ForegroundLow).getARGB(),
+    };
+
+    if (labels_key_ != key)
+    {
+        auto const width =
+            std::max(juce::roundToInt((float)key.width * pixel_scale), 1);
+        auto const height =
+            std::max(juce::roundToInt((float)key.height * pixel_scale), 1);
+        labels_image_ = juce::Image{juce::Image::ARGB, width, height, true};
+
+        auto image_graphics = juce::Graphics{labels_image_};
+        image_graphics.addTransform(juce::AffineTransform::scale(pixel_scale));
+        this->paint_labels(image_graphics);
+
+        labels_key_ = std::move(key);
+    }
+
+    g.drawImage(labels_image_, this->getLocalBounds().toFloat());
+}
+
+void PitchColumn::paint_labels(juce::Graphics &g) const
 {
     g.fillAll(this->findColour(ColorID::BackgroundHigh));
 
-    auto const bounds = this->getLocalBounds().toFloat().reduced(0.f, 4.f);
-    auto const item_height = bounds.getHeight() / (float)size_;
+    if (range_.count == 0)
+    {
+        return;
+    }
+
+    // Lined up with the staff in MeasureView.
+    auto const bounds = this->getLocalBounds().reduced(0, 7);
+    auto const row_height = (float)bounds.getHeight() / (float)range_.count;
+    auto const step = label_step(row_height, range_.count);
+    auto const label_height = std::min(17, (int)((float)step * row_height));
+    if (label_height <= 0)
+    {
+        return;
+    }
 
     g.setColour(this->findColour(ColorID::ForegroundLow));
-    g.setFont(fonts::monospaced().regular.withHeight(17.f));
-    for (std::size_t i = 0; i < size_; ++i)
-    {
-        float y = bounds.getBottom() - ((float)i + 1.f) * item_height;
-        auto const text = juce::String(i).paddedLeft('0', 2);
+    g.setFont(fonts::monospaced().regular().withHeight((float)label_height));
 
-        g.drawText(text, bounds.withY(y).withHeight(item_height),
-                   juce::Justification::centred, true);
+    // Labels are multiples of step, so they keep their place while scrolling.
+    auto const last = range_.first + range_.count;
+    for (auto p = (range_.first + step - 1) / step * step; p < last; p += step)
+    {
+        auto const row = *pitch_row(bounds, range_, p);
+        auto const y = row.getStart() + (row.getLength() - label_height) / 2;
+        g.drawFittedText(juce::String(p).paddedLeft('0', 2),
+                         {bounds.getX(), y, bounds.getWidth(), label_height},
+                         juce::Justification::centred, 1, 0.5f);
     }
 }
 
 // -------------------------------------------------------------------------------------
 
-MeasureView::MeasureView(DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state)
-    : cell_ptr_{make_top_level_cell({sequence::Rest{}}, std::nullopt,
-                                    {.intervals = {0}, .octave = 1, .description = ""},
-                                    TranslateDirection::Up)},
-      audio_thread_state_{audio_thread_state}
+MeasureView::MeasureView(AnimationScheduler &scheduler) : scheduler_{scheduler}
 {
-    this->startTimer(34);
+    // Built from sequencer_state_, update() diffs against it.
+    cell_ptr_ = make_top_level_cell(
+        sequencer_state_.sequence_bank[selected_state_.measure].cell,
+        sequencer_state_.scale, sequencer_state_.tuning,
+        sequencer_state_.scale_translate_direction, pitch_range_);
+    this->addAndMakeVisible(*cell_ptr_);
+
+    scheduler_.add(*this);
 }
 
 MeasureView::~MeasureView()
 {
-    this->stopTimer();
+    scheduler_.remove(*this);
 }
 
 auto MeasureView::get_cell() -> Cell &
@@ -503,31 +508,143 @@ auto MeasureView::get_cell() const -> Cell const &
 
 void MeasureView::update(SequencerState const &state, AuxState const &aux)
 {
-    if (selected_state_ != aux.selected || sequencer_state_ != state)
+    if (selected_state_ != aux.selected || sequencer_state_ != state ||
+        preview_.has_value())
     {
+        for (auto i = std::size_t{0}; i < bg_ir_cache_.size(); ++i)
+        {
+            if (state.sequence_bank[i] != sequencer_state_.sequence_bank[i] ||
+                state.tuning != sequencer_state_.tuning)
+            {
+                bg_ir_cache_[i] = std::nullopt;
+            }
+        }
+
+        if (auto const child_ptr = this->get_selected_child(); child_ptr != nullptr)
+        {
+            child_ptr->clear_selection();
+        }
+
+        // The existing Cell components are diffed against the new measure, so only
+        // the Cells that changed are rebuilt or repainted.
+        auto const &previous =
+            preview_.has_value()
+                ? *preview_
+                : sequencer_state_.sequence_bank[selected_state_.measure].cell;
+        auto const &next = state.sequence_bank[aux.selected.measure];
+        auto const restyle = state.scale != sequencer_state_.scale ||
+                             state.tuning != sequencer_state_.tuning ||
+                             state.scale_translate_direction !=
+                                 sequencer_state_.scale_translate_direction;
+        auto const build = BuildAndAllocateCell{
+            state.scale,
+            state.tuning,
+            state.scale_translate_direction,
+            pitch_range_,
+        };
+        if (!cell_ptr_->reconcile(previous, next.cell, build, restyle))
+        {
+            cell_ptr_ = make_top_level_cell(next.cell, state.scale, state.tuning,
+                                            state.scale_translate_direction,
+                                            pitch_range_);
+            this->addAndMakeVisible(*cell_ptr_);
+            this->resized();
+        }
+
         selected_state_ = aux.selected;
         sequencer_state_ = state;
-
-        cell_ptr_.reset();
-        auto &measure = state.sequence_bank[selected_state_.measure];
-        cell_ptr_ = make_top_level_cell(measure.cell, state.scale, state.tuning,
-                                        state.scale_translate_direction);
-        this->addAndMakeVisible(*cell_ptr_);
+        preview_ = std::nullopt;
 
         if (auto const child_ptr = this->get_selected_child(); child_ptr != nullptr)
         {
             child_ptr->make_selected();
         }
+
+        // The background and playhead depend on the measure and tuning.
+        scheduler_.start(*this);
+    }
+}
+
+void MeasureView::set_pitch_range(PitchRange range)
+{
+    if (pitch_range_ == range)
+    {
+        return;
+    }
+    pitch_range_ = range;
+
+    // Same measure, restyled only to move each Note to its new row.
+    auto const &current = sequencer_state_.sequence_bank[selected_state_.measure].cell;
+    auto const &cell = preview_.has_value() ? *preview_ : current;
+    auto const build = BuildAndAllocateCell{
+        sequencer_state_.scale,
+        sequencer_state_.tuning,
+        sequencer_state_.scale_translate_direction,
+        pitch_range_,
+    };
+    [[maybe_unused]] auto const reconciled =
+        cell_ptr_->reconcile(cell, cell, build, true);
+    assert(reconciled);
+
+    this->repaint();
+}
+
+void MeasureView::preview(ModulationPane::Preview const &modify)
+{
+    auto &current = sequencer_state_.sequence_bank[selected_state_.measure].cell;
+
+    // Applied to the last update() state rather than the last preview. Only the
+    // selected measure is copied.
+    auto next = current;
+    auto *selected = &next;
+    for (auto const index : selected_state_.cell)
+    {
+        selected = &std::get<sequence::Sequence>(selected->element).cells[index];
+    }
+    *selected = modify(*selected);
+
+    if (auto const child_ptr = this->get_selected_child(); child_ptr != nullptr)
+    {
+        child_ptr->clear_selection();
+    }
+
+    auto const &displayed = preview_.has_value() ? *preview_ : current;
+    auto const build = BuildAndAllocateCell{
+        sequencer_state_.scale,
+        sequencer_state_.tuning,
+        sequencer_state_.scale_translate_direction,
+        pitch_range_,
+    };
+    if (!cell_ptr_->reconcile(displayed, next, build, false))
+    {
+        cell_ptr_ = make_top_level_cell(next, sequencer_state_.scale,
+                                        sequencer_state_.tuning,
+                                        sequencer_state_.scale_translate_direction,
+                                        pitch_range_);
+        this->addAndMakeVisible(*cell_ptr_);
         this->resized();
     }
+    preview_ = std::move(next);
+
+    if (auto const child_ptr = this->get_selected_child(); child_ptr != nullptr)
+    {
+        child_ptr->make_selected();
+    }
 }
 
 void MeasureView::set_playhead(std::optional<float> percent)
 {
     if (playhead_ != percent)
     {
+        if (playhead_.has_value())
+        {
+            this->repaint(this->playhead_column(*playhead_));
+        }
         playhead_ = percent;
-        this->repaint();
+        if (playhead_.has_value())
+        {
+            this->repaint(this->playhead_column(*playhead_));
+        }
     }
 }
 
@@ -542,14 +659,64 @@ void MeasureView::resized()
 }
 
 void MeasureView::paint(juce::Graphics &g)
+{
+    auto const pixel_scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    auto key = StaffKey{
+        .width = this->getWidth(),
+        .height = this->getHeight(),
+        .pixel_scale = pixel_scale,
+        .tuning_length = sequencer_state_.tuning.intervals.size(),
+        .scale = sequencer_state_.scale,
+        .scale_translate_direction = sequencer_state_.scale_translate_direction,
+        .pitch_range = pitch_range_,
+        .staff_color = this->findColour(ColorID::ForegroundLow).getARGB(),
+    };
+
+    if (staff_key_ != key)
+    {
+        auto const width =
+            std::max(juce::roundToInt((float)key.width * pixel_scale), 1);
+        auto const height =
+            std::max(juce::roundToInt((float)key.height * pixel_scale), 1);
+        staff_image_ = juce::Image{juce::Image::ARGB, width, height, true};
+
+        auto image_graphics = juce::Graphics{staff_image_};
+        image_graphics.addTransform(juce::AffineTransform::scale(pixel_scale));
+        this->paint_staff(image_graphics);
+
+        staff_key_ = std::move(key);
+    }
+
+    g.drawImage(staff_image_, this->getLocalBounds().toFloat());
+    this->paint_bg_sequences(g);
+}
+
+void MeasureView::paintOverChildren(juce::Graphics &g)
+{
+    if (playhead_.has_value())
+    {
+        auto const bounds = this->getLocalBounds().reduced(2, 7).toFloat();
+        auto const x = this->playhead_x(*playhead_);
+
+        g.setColour(this->findColour(ColorID::ForegroundMedium));
+        auto const thickness = 1.f;
+        g.fillRect(x - thickness / 2.f, bounds.getY(), thickness, bounds.getHeight());
+    }
+}
+
+void MeasureView::paint_staff(juce::Graphics &g) const
+{
+    draw_staff(g, this->getLocalBounds().reduced(2, 7),
+               this->findColour(ColorID::ForegroundLow), sequencer_state_.scale,
+               sequencer_state_.tuning.intervals.size(),
+               sequencer_state_.scale_translate_direction, pitch_range_);
+}
+
+void MeasureView::paint_bg_sequences(juce::Graphics &g) const
 {
     auto const bounds = this->getLocalBounds().reduced(2, 7);
     auto const tuning_length = sequencer_state_.tuning.intervals.size();
 
-    draw_staff(g, bounds, this->findColour(ColorID::ForegroundLow),
-               sequencer_state_.scale, tuning_length,
-               sequencer_state_.scale_translate_direction);
-
     auto fg_index = selected_state_.measure;
     for (auto i = std::size_t{0}; i < bg_current_.size(); ++i)
     {
@@ -557,31 +724,30 @@ void MeasureView::paint(juce::Graphics &g)
         {
             auto const color = bg_colors[i];
             paint_bg_active_sequence(bg_current_[i]->windowed_ir, g, bounds,
-                                     tuning_length, color);
+                                     tuning_length, pitch_range_, color);
             paint_trigger_line(g, bg_current_[i]->trigger_x_percent, color);
         }
     }
 }
 
-void MeasureView::paintOverChildren(juce::Graphics &g)
+auto MeasureView::playhead_x(float percent) const -> float
 {
-    if (playhead_.has_value())
-    {
-        auto const bounds = this->getLocalBounds().reduced(2, 7).toFloat();
-        auto const x = bounds.getX() + playhead_.value() * bounds.getWidth();
+    auto const bounds = this->getLocalBounds().reduced(2, 7).toFloat();
+    return bounds.getX() + percent * bounds.getWidth();
+}
 
-        g.setColour(this->findColour(ColorID::ForegroundMedium));
-        auto const thickness = 1.f;
-        g.fillRect(x - thickness / 2.f, bounds.getY(), thickness, bounds.getHeight());
-    }
+auto MeasureView::playhead_column(float percent) const -> juce::Rectangle<int>
+{
+    auto const bounds = this->getLocalBounds().reduced(2, 7);
+    auto const x = (int)std::floor(this->playhead_x(percent));
+    return {x - 1, bounds.getY(), 3, bounds.getHeight()};
 }
 
-void MeasureView::timerCallback()
+auto MeasureView::animate(AudioThreadStateForGUI const &state, Clock::time_point now)
+    -> bool
 {
-    auto const now = Clock::now();
-    auto const audio_thread_state = audio_thread_state_.read();
-    auto const &trigger_starts = audio_thread_state.note_start_times;
-    auto const &daw = audio_thread_state.daw;
+    auto const &trigger_starts = state.note_start_times;
+    auto const &daw = state.daw;
     auto const &sequences = sequencer_state_.sequence_bank;
     auto const fg_index = selected_state_.measure;
     auto const fg_trigger_start = trigger_starts[fg_index];
@@ -600,21 +766,26 @@ void MeasureView::timerCallback()
     if (state_changed)
     {
         auto const tuning_length = sequencer_state_.tuning.intervals.size();
-        update_all_bg_state(bg_current_, sequences, trigger_starts, tuning_length,
-                            fg_index, daw, now);
+        update_all_bg_state(bg_current_, bg_ir_cache_, sequences, trigger_starts,
+                            tuning_length, fg_index, daw, now);
         this->repaint();
         bg_previous_.tuning = sequencer_state_.tuning;
         bg_previous_.bank_measure_selected = selected_state_.measure;
         bg_previous_.note_start_times = trigger_starts;
         bg_previous_.windows = stored_windows_;
     }
+
+    // With no triggers there is nothing left to move, a new generation restarts it.
+    return std::ranges::any_of(trigger_starts, [](Clock::time_point start) {
+        return start != Clock::time_point{};
+    });
 }
 
 // -------------------------------------------------------------------------------------
 
-SequenceView::SequenceView(
-    DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state)
-    : pitch_column{12}, measure_view{audio_thread_state}
+SequenceView::SequenceView(AnimationScheduler &scheduler)
+    : pitch_column{PitchRange{.first = 0, .count = 12}}, measure_view{scheduler},
+      modulation_pane_accordion{"Modulation", scheduler}
 {
     this->setComponentID("SequenceView");
     this->setWantsKeyboardFocus(true);
@@ -630,6 +801,10 @@ SequenceView::SequenceView(
 
     modulation_pane.on_change.connect(
         [this](std::string const &command) { this->on_command(command); });
+
+    modulation_pane.on_preview.connect([this](ModulationPane::Preview const &modify) {
+        measure_view.preview(modify);
+    });
 }
 
 void SequenceView::update(SequencerState const &state, AuxState const &aux)
@@ -638,7 +813,12 @@ void SequenceView::update(SequencerState const &state, AuxState const &aux)
 
     measure_view.update(state, aux);
 
-    pitch_column.update(state.tuning.intervals.size());
+    if (auto const length = state.tuning.intervals.size(); length != tuning_length_)
+    {
+        tuning_length_ = length;
+        this->set_pitch_range({});
+    }
+
     // std::ranges::equal_to to avoid float comparison warning
     if (std::ranges::equal_to{}(state.tuning.octave, 1'200.f))
     {
@@ -701,12 +881,58 @@ void SequenceView::paintOverChildren(juce::Graphics &g)
     g.fillRect(bounds.withX(bounds.getRight() - thickness).withWidth(thickness));
 }
 
+void SequenceView::mouseWheelMove(juce::MouseEvent const &event,
+                                  juce::MouseWheelDetails const &wheel)
+{
+    auto const position = event.getEventRelativeTo(this).getPosition();
+    if (tuning_length_ == 0 || std::ranges::equal_to{}(wheel.deltaY, 0.f) ||
+        (!pitch_column.getBounds().contains(position) &&
+         !measure_view.getBounds().contains(position)))
+    {
+        this->Component::mouseWheelMove(event, wheel);
+        return;
+    }
+
+    auto const range = pitch_range_;
+    auto const up = wheel.deltaY > 0.f;
+
+    if (event.mods.isCommandDown())
+    {
+        // Keep the pitch under the mouse at the same height while zooming.
+        auto const staff = measure_view.getBounds().reduced(2, 7);
+        auto const anchor = pitch_at(staff, range, position.y);
+        auto const count = up ? std::max(range.count * 4 / 5, std::size_t{1})
+                              : std::max(range.count * 5 / 4, range.count + 1);
+        auto const below = (anchor - range.first) * count / range.count;
+        this->set_pitch_range({
+            .first = anchor > below ? anchor - below : 0,
+            .count = count,
+        });
+    }
+    else
+    {
+        auto const distance = std::max(range.count / 8, std::size_t{1});
+        this->set_pitch_range({
+            .first = up ? range.first + distance
+                        : range.first - std::min(range.first, distance),
+            .count = range.count,
+        });
+    }
+}
+
+void SequenceView::set_pitch_range(PitchRange range)
+{
+    pitch_range_ = clamp_pitch_range(range, tuning_length_);
+    measure_view.set_pitch_range(pitch_range_);
+    pitch_column.update(pitch_range_);
+}
+
 // -------------------------------------------------------------------------------------
 
 CenterComponent::CenterComponent(
     juce::File const &sequence_library_dir, juce::File const &tuning_library_dir,
-    DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state)
-    : sequence_view{audio_thread_state},
+    AnimationScheduler &scheduler)
+    : sequence_view{scheduler},
       library_view{sequence_library_dir, tuning_library_dir}
 {
     this->addAndMakeVisible(sequence_view);
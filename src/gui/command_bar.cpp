@@ -108,7 +108,7 @@ CommandBar::CommandBar(CommandHistory &cmd_history) : command_history_{cmd_histo
         this->on_command("show StatusBar"); 
         };
 
-    auto const font = fonts::monospaced().regular.withHeight(18.f);
+    auto const font = fonts::monospaced().regular().withHeight(18.f);
     command_input_.setFont(font);
     ghost_text_.setFont(font);
 }
@@ -170,6 +170,7 @@ void CommandBar::do_send_command()
 {
     auto const command = command_input_.getText().toStdString();
     command_history_.add_command(command);
+    this->on_command_entered(command);
     this->on_command(command);
 }
 
@@ -193,11 +194,10 @@ void CommandBar::do_tab_press()
     }
 
     auto const input = command_input_.getText().toStdString();
-    auto const id = this->on_complete_id_request(input);
-    if (id.has_value())
+    auto const completed = this->on_complete_request(input);
+    if (completed.has_value() && !completed->empty())
     {
-        auto const completed_text = input + *id + (id->empty() ? "" : " ");
-        command_input_.setText(completed_text,
+        command_input_.setText(*completed,
                                juce::NotificationType::dontSendNotification);
         ghost_text_.clear();
         this->add_guide_text();
@@ -1,6 +1,9 @@
 #include <xen/gui/directory_list_box.hpp>
 
 #include <cassert>
+#include <exception>
+#include <string>
+#include <utility>
 
 #include <xen/gui/fonts.hpp>
 #include <xen/gui/themes.hpp>
@@ -16,16 +19,24 @@ DirectoryListBox::DirectoryListBox(juce::File const &initial_directory,
     this->on_directory_change(initial_directory);
     directory_contents_list_.addChangeListener(this);
     dcl_thread_.startThread(juce::Thread::Priority::low);
+
+    library_index_->add_directory(initial_directory);
+    library_index_->addChangeListener(this);
 }
 
 DirectoryListBox::~DirectoryListBox()
 {
+    library_index_->removeChangeListener(this);
     assert(dcl_thread_.stopThread(3'000)); // Allow some time for thread to finish
     directory_contents_list_.removeChangeListener(this);
 }
 
 auto DirectoryListBox::getNumRows() -> int
 {
+    if (!filter_.empty())
+    {
+        return (int)filter_results_.size();
+    }
     return directory_contents_list_.getNumFiles() + 1;
 }
 
@@ -35,10 +46,28 @@ void DirectoryListBox::changeListenerCallback(juce::ChangeBroadcaster *source)
     {
         this->updateContent();
     }
+    else if (source == &library_index_.getObject())
+    {
+        if (filter_.empty())
+        {
+            this->repaint(); // Rows may have new index entries to display.
+        }
+        else
+        {
+            this->update_filter_results();
+        }
+    }
 }
 
 auto DirectoryListBox::get_row_display(std::size_t index) -> juce::String
 {
+    if (!filter_.empty())
+    {
+        return index < filter_results_.size()
+                   ? juce::File{juce::String{filter_results_[index]->path}}
+                         .getFileNameWithoutExtension()
+                   : juce::String{};
+    }
     if (index == 0)
     {
         return juce::String{".."} + juce::File::getSeparatorChar();
@@ -50,11 +79,30 @@ auto DirectoryListBox::get_row_display(std::size_t index) -> juce::String
 
 void DirectoryListBox::item_selected(std::size_t index)
 {
+    if (!filter_.empty())
+    {
+        if (index >= filter_results_.size())
+        {
+            return;
+        }
+        // Results can be in any directory, file selection is relative to the current.
+        auto const file = juce::File{juce::String{filter_results_[index]->path}};
+        auto const parent = file.getParentDirectory();
+        if (parent != directory_contents_list_.getDirectory())
+        {
+            directory_contents_list_.setDirectory(parent, true, true);
+            library_index_->add_directory(parent);
+            this->on_directory_change(parent);
+        }
+        this->on_file_selected(file);
+        return;
+    }
     if (index == 0) // Parent Directory
     {
         auto const parent =
             directory_contents_list_.getDirectory().getParentDirectory();
         directory_contents_list_.setDirectory(parent, true, true);
+        library_index_->add_directory(parent);
         this->on_directory_change(parent);
         this->ListBox::selectRow(0);
         return;
@@ -63,6 +111,7 @@ void DirectoryListBox::item_selected(std::size_t index)
              file.isDirectory())
     {
         directory_contents_list_.setDirectory(file, true, true);
+        library_index_->add_directory(file);
         this->on_directory_change(file);
         this->ListBox::selectRow(0);
     }
@@ -74,7 +123,15 @@ void DirectoryListBox::item_selected(std::size_t index)
 
 auto DirectoryListBox::get_file(std::size_t index) -> std::optional<juce::File>
 {
-    auto const file = directory_contents_list_.getFile((int)index - 1);
+    auto file = juce::File{};
+    if (filter_.empty())
+    {
+        file = directory_contents_list_.getFile((int)index - 1);
+    }
+    else if (index < filter_results_.size())
+    {
+        file = juce::File{juce::String{filter_results_[index]->path}};
+    }
     if (file.exists() && !file.isDirectory())
     {
         return file;
@@ -85,4 +142,50 @@ auto DirectoryListBox::get_file(std::size_t index) -> std::optional<juce::File>
     }
 }
 
+auto DirectoryListBox::get_entry(std::size_t index) const
+    -> std::shared_ptr<LibraryEntry const>
+{
+    if (!filter_.empty())
+    {
+        return index < filter_results_.size() ? filter_results_[index] : nullptr;
+    }
+    if (index == 0)
+    {
+        return nullptr;
+    }
+    return library_index_->find(directory_contents_list_.getFile((int)index - 1));
+}
+
+void DirectoryListBox::set_filter(std::string query)
+{
+    if (query == filter_)
+    {
+        return;
+    }
+    filter_ = std::move(query);
+    this->update_filter_results();
+    this->ListBox::selectRow(0);
+}
+
+void DirectoryListBox::update_filter_results()
+{
+    filter_results_.clear();
+    if (!filter_.empty())
+    {
+        try
+        {
+            filter_results_ = library_index_->search(filter_);
+        }
+        catch (std::exception const &)
+        {
+            // Invalid query, likely still being typed.
+        }
+        std::erase_if(filter_results_, [this](auto const &entry) {
+            return !file_filter_.isFileSuitable(juce::File{juce::String{entry->path}});
+        });
+    }
+    this->updateContent();
+    this->repaint();
+}
+
 } // namespace xen::gui
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include <xen/gui/fonts.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <embed_fonts.hpp>
+
+namespace
+{
+
+/**
+ * Take embedded binary data and create a juce::Font.
+ */
+[[nodiscard]] auto binary_to_font(char const *data, int size) -> juce::Font
+{
+    return juce::Font{
+        juce::FontOptions{
+            juce::Typeface::createSystemTypefaceFor(data, (std::size_t)size),
+        },
+    };
+}
+
+struct TextWidthKey
+{
+    std::uintptr_t typeface_id;
+    float height;
+    float horizontal_scale;
+    float extra_kerning;
+    int style_flags;
+    juce::String text;
+
+    // Held so the id is not reused by another typeface while cached.
+    juce::Typeface::Ptr typeface;
+
+    [[nodiscard]] auto operator<(TextWidthKey const &other) const -> bool
+    {
+        auto const tied = [](TextWidthKey const &key) {
+            return std::tie(key.typeface_id, key.height, key.horizontal_scale,
+                            key.extra_kerning, key.style_flags, key.text);
+        };
+        return tied(*this) < tied(other);
+    }
+};
+
+// Enough for every label on screen, cleared in full when reached.
+constexpr auto max_cached_text_widths = std::size_t{1'024};
+
+} // namespace
+
+namespace xen::gui::fonts
+{
+
+auto SourceCodePro::extra_light() const -> juce::Font const &
+{
+    static auto const font =
+        binary_to_font(embed_fonts::SourceCodeProExtraLight_ttf,
+                       embed_fonts::SourceCodeProExtraLight_ttfSize);
+    return font;
+}
+
+auto SourceCodePro::light() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::SourceCodeProLight_ttf,
+                                            embed_fonts::SourceCodeProLight_ttfSize);
+    return font;
+}
+
+auto SourceCodePro::regular() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::SourceCodeProRegular_ttf,
+                                            embed_fonts::SourceCodeProRegular_ttfSize);
+    return font;
+}
+
+auto SourceCodePro::medium() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::SourceCodeProMedium_ttf,
+                                            embed_fonts::SourceCodeProMedium_ttfSize);
+    return font;
+}
+
+auto SourceCodePro::semi_bold() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::SourceCodeProSemiBold_ttf,
+                                            embed_fonts::SourceCodeProSemiBold_ttfSize);
+    return font;
+}
+
+auto SourceCodePro::bold() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::SourceCodeProBold_ttf,
+                                            embed_fonts::SourceCodeProBold_ttfSize);
+    return font;
+}
+
+auto SourceCodePro::extra_bold() const -> juce::Font const &
+{
+    static auto const font =
+        binary_to_font(embed_fonts::SourceCodeProExtraBold_ttf,
+                       embed_fonts::SourceCodeProExtraBold_ttfSize);
+    return font;
+}
+
+auto SourceCodePro::black() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::SourceCodeProBlack_ttf,
+                                            embed_fonts::SourceCodeProBlack_ttfSize);
+    return font;
+}
+
+auto RobotoMono::thin() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::RobotoMonoThin_ttf,
+                                            embed_fonts::RobotoMonoThin_ttfSize);
+    return font;
+}
+
+auto RobotoMono::extra_light() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::RobotoMonoExtraLight_ttf,
+                                            embed_fonts::RobotoMonoExtraLight_ttfSize);
+    return font;
+}
+
+auto RobotoMono::light() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::RobotoMonoLight_ttf,
+                                            embed_fonts::RobotoMonoLight_ttfSize);
+    return font;
+}
+
+auto RobotoMono::regular() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::RobotoMonoRegular_ttf,
+                                            embed_fonts::RobotoMonoRegular_ttfSize);
+    return font;
+}
+
+auto RobotoMono::medium() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::RobotoMonoMedium_ttf,
+                                            embed_fonts::RobotoMonoMedium_ttfSize);
+    return font;
+}
+
+auto RobotoMono::semi_bold() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::RobotoMonoSemiBold_ttf,
+                                            embed_fonts::RobotoMonoSemiBold_ttfSize);
+    return font;
+}
+
+auto RobotoMono::bold() const -> juce::Font const &
+{
+    static auto const font = binary_to_font(embed_fonts::RobotoMonoBold_ttf,
+                                            embed_fonts::RobotoMonoBold_ttfSize);
+    return font;
+}
+
+auto symbols() -> juce::Font const &
+{
+    static auto const font =
+        binary_to_font(embed_fonts::NotoSansSymbols2Regular_ttf,
+                       embed_fonts::NotoSansSymbols2Regular_ttfSize);
+    return font;
+}
+
+auto text_width(juce::Font const &font, juce::String const &text) -> float
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    static auto cache = std::map<TextWidthKey, float>{};
+
+    auto typeface = font.getTypefacePtr();
+    auto key = TextWidthKey{
+        .typeface_id = reinterpret_cast<std::uintptr_t>(typeface.get()),
+        .height = font.getHeight(),
+        .horizontal_scale = font.getHorizontalScale(),
+        .extra_kerning = font.getExtraKerningFactor(),
+        .style_flags = font.getStyleFlags(),
+        .text = text,
+        .typeface = std::move(typeface),
+    };
+
+    if (auto const at = cache.find(key); at != cache.end())
+    {
+        return at->second;
+    }
+
+    if (cache.size() >= max_cached_text_widths)
+    {
+        cache.clear();
+    }
+
+    auto glyph_arrangement = juce::GlyphArrangement{};
+    glyph_arrangement.addLineOfText(font, text, 0.f, 0.f);
+    auto const width = glyph_arrangement.getBoundingBox(0, -1, true).getWidth();
+
+    cache.emplace(std::move(key), width);
+    return width;
+}
+
+} // namespace xen::gui::fonts
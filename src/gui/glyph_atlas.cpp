@@ -0,0 +1,113 @@
+#include <xen/gui/glyph_atlas.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <xen/gui/fonts.hpp>
+
+namespace xen::gui
+{
+
+void GlyphAtlas::draw(juce::Graphics &g, juce::String const &text, int font_height,
+                      juce::Rectangle<float> area)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    auto const in_atlas = [&] {
+        for (auto const c : text)
+        {
+            if (c > 127 || characters.find((char)c) == std::string_view::npos)
+            {
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    if (!in_atlas || font_height > max_font_height)
+    {
+        g.setFont(fonts::monospaced().bold().withHeight((float)font_height));
+        g.drawText(text, area, juce::Justification::centred, false);
+        return;
+    }
+
+    auto const pixel_scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    auto const &p = this->page(font_height, pixel_scale);
+
+    // Monospaced, so the width is known without laying the text out.
+    auto const width = p.advance * (float)text.length();
+    auto x = area.getCentreX() - width / 2.f;
+    auto const y = area.getCentreY() - (float)font_height / 2.f;
+
+    // Snapped to physical pixels so glyphs are copied without resampling.
+    auto const snap = [&](float v) {
+        return std::round(v * pixel_scale) / pixel_scale;
+    };
+
+    for (auto const c : text)
+    {
+        auto const &glyph = p.glyphs[characters.find((char)c)];
+        auto const transform = juce::AffineTransform::scale(1.f / pixel_scale)
+                                   .translated(snap(x), snap(y));
+        g.drawImageTransformed(glyph, transform, true);
+        x += p.advance;
+    }
+}
+
+auto GlyphAtlas::page(int font_height, float pixel_scale) -> Page const &
+{
+    auto const key = std::pair{font_height, pixel_scale};
+    if (auto const at = pages_.find(key); at != pages_.end())
+    {
+        return at->second;
+    }
+
+    if (pages_.size() >= max_pages)
+    {
+        pages_.clear();
+    }
+
+    auto const font = fonts::monospaced().bold().withHeight((float)font_height);
+    auto const advance = fonts::text_width(font, "0");
+
+    auto const glyph_width = std::max((int)std::ceil(advance * pixel_scale), 1);
+    auto const glyph_height =
+        std::max((int)std::ceil((float)font_height * pixel_scale), 1);
+
+    auto p = Page{
+        .image = juce::Image{juce::Image::SingleChannel,
+                             glyph_width * (int)characters.size(), glyph_height, true},
+        .glyphs = {},
+        .advance = advance,
+    };
+
+    {
+        auto ig = juce::Graphics{p.image};
+        ig.addTransform(juce::AffineTransform::scale(pixel_scale));
+        ig.setColour(juce::Colours::white);
+        ig.setFont(font);
+        auto const cell_width = (float)glyph_width / pixel_scale;
+        auto const cell_height = (float)glyph_height / pixel_scale;
+        for (auto i = std::size_t{0}; i < characters.size(); ++i)
+        {
+            ig.drawText(juce::String::charToString((juce::juce_wchar)characters[i]),
+                        juce::Rectangle<float>{(float)i * cell_width, 0.f, cell_width,
+                                               cell_height},
+                        juce::Justification::centred, false);
+        }
+    }
+
+    for (auto i = std::size_t{0}; i < characters.size(); ++i)
+    {
+        p.glyphs[i] = p.image.getClippedImage(
+            {(int)i * glyph_width, 0, glyph_width, glyph_height});
+    }
+
+    return pages_.emplace(key, std::move(p)).first->second;
+}
+
+} // namespace xen::gui
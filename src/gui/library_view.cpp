@@ -1,16 +1,14 @@
 #include <xen/gui/library_view.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
-#include <iterator>
-#include <map>
+#include <string>
 #include <vector>
 
 #include <juce_core/juce_core.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
-#include <sequence/tuning.hpp>
-
 #include <xen/gui/fonts.hpp>
 #include <xen/gui/themes.hpp>
 #include <xen/scale.hpp>
@@ -37,6 +35,90 @@ namespace
 namespace xen::gui
 {
 
+SequencesList::SequencesList(juce::File const &sequences_dir)
+    : DirectoryListBox{sequences_dir,
+                       juce::WildcardFileFilter{"*.xss", "*", "XenSeq filter"},
+                       "SequencesList"}
+{
+}
+
+void SequencesList::paintListBoxItem(int row_number, juce::Graphics &g, int width,
+                                     int height, bool row_is_selected)
+{
+    auto const entry = this->get_entry((std::size_t)row_number);
+    if (entry == nullptr || !entry->readable || entry->measures.empty())
+    {
+        this->XenListBox::paintListBoxItem(row_number, g, width, height,
+                                           row_is_selected);
+        return;
+    }
+
+    // Name on the left half, one slot per measure on the right half.
+    auto const preview_width = width / 2;
+    this->XenListBox::paintListBoxItem(row_number, g, width - preview_width, height,
+                                       row_is_selected);
+
+    auto const area =
+        juce::Rectangle<int>{width - preview_width, 0, preview_width, height}
+            .reduced(2, 3)
+            .toFloat();
+    auto const slot_width = area.getWidth() / (float)entry->measures.size();
+    auto const note_height = 2.f;
+
+    for (auto i = std::size_t{0}; i < entry->measures.size(); ++i)
+    {
+        auto const slot = juce::Rectangle<float>{area.getX() + slot_width * (float)i,
+                                                 area.getY(), slot_width - 1.f,
+                                                 area.getHeight()};
+
+        g.setColour(this->findColour(ColorID::ForegroundLow));
+        g.fillRect(slot.withTop(slot.getBottom() - 1.f));
+
+        g.setColour(this->findColour(ColorID::ForegroundMedium));
+        for (auto const &note : entry->measures[i].preview)
+        {
+            g.fillRect(slot.getX() + slot.getWidth() * (float)note.x / 255.f,
+                       slot.getBottom() - note_height -
+                           (slot.getHeight() - note_height) * (float)note.y / 255.f,
+                       std::max(slot.getWidth() * (float)note.width / 255.f, 1.f),
+                       note_height);
+        }
+    }
+}
+
+auto SequencesList::getTooltipForRow(int row) -> juce::String
+{
+    auto const entry = this->get_entry((std::size_t)row);
+    if (entry == nullptr)
+    {
+        return "";
+    }
+    if (!entry->readable)
+    {
+        return "Error Reading " + juce::File{juce::String{entry->path}}.getFileName();
+    }
+
+    auto result = juce::String{};
+    for (auto i = std::size_t{0}; i < entry->measures.size(); ++i)
+    {
+        auto const &measure = entry->measures[i];
+        if (measure.note_count == 0 && measure.name.empty())
+        {
+            continue;
+        }
+        result += result.isEmpty() ? "" : "\n";
+        result += juce::String{(int)i} + ": ";
+        result += measure.name.empty() ? juce::String{}
+                                       : juce::String{measure.name} + " ";
+        result += "[" + juce::String{measure.numerator} + "/" +
+                  juce::String{measure.denominator} + "] " +
+                  juce::String{measure.note_count} + " notes";
+    }
+    return result.isEmpty() ? "Empty" : result;
+}
+
+// -------------------------------------------------------------------------------------
+
 TuningsList::TuningsList(juce::File const &tunings_dir)
     : DirectoryListBox{tunings_dir,
                        juce::WildcardFileFilter{"*.scl", "*", "scala filter"},
@@ -46,37 +128,16 @@ TuningsList::TuningsList(juce::File const &tunings_dir)
 
 auto TuningsList::getTooltipForRow(int row) -> juce::String
 {
-    auto const file = this->get_file((std::size_t)row);
-    try
+    auto const entry = this->get_entry((std::size_t)row);
+    if (entry == nullptr)
     {
-        if (file.has_value() && file->exists())
-        {
-            auto const at = tooltip_cache_.find(file->hashCode());
-            if (at != std::cend(tooltip_cache_))
-            {
-                return at->second;
-            }
-            else if (file->getSize() < (1024 * 1'024))
-            {
-                auto const tuning =
-                    sequence::from_scala(file->getFullPathName().toStdString());
-                tooltip_cache_.emplace(file->hashCode(), tuning.description);
-                return tuning.description;
-            }
-            else
-            {
-                return "File Too Large";
-            }
-        }
-        else
-        {
-            return "";
-        }
+        return "";
     }
-    catch (...)
+    if (!entry->readable)
     {
-        return "Error Reading " + file->getFileName();
+        return "Error Reading " + juce::File{juce::String{entry->path}}.getFileName();
     }
+    return juce::String{entry->tuning.description};
 }
 
 // -------------------------------------------------------------------------------------
@@ -131,13 +192,22 @@ void LibraryView::Divider::paint(juce::Graphics &g)
 
 LibraryView::LibraryView(juce::File const &sequence_library_dir,
                          juce::File const &tuning_library_dir)
-    : sequences{"Sequences", sequence_library_dir,
-                juce::WildcardFileFilter{"*.xss", "*", "XenSeq filter"},
-                "SequencesList"},
+    : sequences{"Sequences", sequence_library_dir},
       tunings{"Tunings", tuning_library_dir}, scales{"Scales"}
 {
     this->setComponentID("LibraryView");
 
+    this->addAndMakeVisible(filter_box);
+    filter_box.setMultiLine(false, false);
+    filter_box.setFont(fonts::monospaced().regular().withHeight(16.f));
+    filter_box.onTextChange = [this] {
+        auto const query = filter_box.getText().toStdString();
+        sequences_list.set_filter(query);
+        tunings_list.set_filter(query);
+    };
+    filter_box.onReturnKey = [this] { sequences_list.grabKeyboardFocus(); };
+    filter_box.onEscapeKey = [this] { this->set_filter(""); };
+
     this->addAndMakeVisible(sequences);
     this->addAndMakeVisible(divider_1);
 
@@ -147,8 +217,18 @@ LibraryView::LibraryView(juce::File const &sequence_library_dir,
     this->addAndMakeVisible(scales);
 }
 
+void LibraryView::set_filter(std::string const &query)
+{
+    filter_box.setText(query, juce::dontSendNotification);
+    sequences_list.set_filter(query);
+    tunings_list.set_filter(query);
+}
+
 void LibraryView::resized()
 {
+    auto bounds = this->getLocalBounds();
+    filter_box.setBounds(bounds.removeFromTop(24));
+
     auto fb = juce::FlexBox{};
     fb.flexDirection = juce::FlexBox::Direction::row;
 
@@ -160,7 +240,20 @@ void LibraryView::resized()
 
     fb.items.add(juce::FlexItem{scales}.withFlex(1.f));
 
-    fb.performLayout(this->getLocalBounds());
+    fb.performLayout(bounds);
+}
+
+void LibraryView::lookAndFeelChanged()
+{
+    auto const outline = this->findColour(ColorID::ForegroundLow);
+    filter_box.setColour(juce::TextEditor::backgroundColourId,
+                         this->findColour(ColorID::BackgroundMedium));
+    filter_box.setColour(juce::TextEditor::textColourId,
+                         this->findColour(ColorID::ForegroundHigh));
+    filter_box.setColour(juce::TextEditor::focusedOutlineColourId, outline);
+    filter_box.setColour(juce::TextEditor::outlineColourId, outline);
+    filter_box.setTextToShowWhenEmpty("Search",
+                                      this->findColour(ColorID::ForegroundLow));
 }
 
 } // namespace xen::gui
\ No newline at end of file
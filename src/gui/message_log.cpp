@@ -2,22 +2,27 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include <xen/gui/xen_list_box.hpp>
 #include <xen/message_level.hpp>
-namespace xen::gui
-{
 
-MessageLog::MessageLog() : XenListBox{"MessageLog"}
+namespace
 {
-}
 
-void MessageLog::add_message(juce::String const &text, ::xen::MessageLevel level)
+[[nodiscard]] auto format_row(juce::int64 time, xen::MessageLevel level,
+                              std::string const &text, bool include_date)
+    -> juce::String
 {
     auto oss = std::ostringstream{};
     oss << level;
@@ -26,24 +31,95 @@ void MessageLog::add_message(juce::String const &text, ::xen::MessageLevel level
     auto const max_level_length = 7;
     assert(level_str.length() <= max_level_length);
 
-    auto const time_str = juce::Time::getCurrentTime().toString(false, true, true);
+    auto const time_str = juce::Time{time}.toString(include_date, true, true);
 
-    messages_.emplace_back(
-        time_str + " | " + level_str +
-        std::string((std::size_t)(max_level_length - level_str.length()), ' ') + " | " +
-        text);
+    return time_str + " | " + level_str +
+           std::string((std::size_t)(max_level_length - level_str.length()), ' ') +
+           " | " + juce::String{text};
+}
 
-    this->updateContent();
+} // namespace
+
+namespace xen::gui
+{
+
+MessageLog::MessageLog() : XenListBox{"MessageLog"}
+{
+    entries_.reserve(capacity);
+}
+
+void MessageLog::add_message(std::string_view text, ::xen::MessageLevel level)
+{
+    auto new_entry = Entry{
+        .time = juce::Time::currentTimeMillis(),
+        .level = level,
+        .text = this->intern(text),
+    };
+
+    if (entries_.size() < capacity)
+    {
+        entries_.push_back(std::move(new_entry));
+    }
+    else
+    {
+        // Overwrites the oldest message.
+        auto const dropped = next_id_ - capacity;
+        if (!visible_.empty() && visible_.front() == dropped)
+        {
+            visible_.pop_front();
+        }
+        entries_[next_id_ % capacity] = std::move(new_entry);
+    }
+
+    if (level >= level_filter_)
+    {
+        visible_.push_back(next_id_);
+    }
+    ++next_id_;
+
+    this->triggerAsyncUpdate();
+}
+
+void MessageLog::set_level_filter(::xen::MessageLevel level)
+{
+    level_filter_ = level;
+    visible_.clear();
+    auto const first = next_id_ - entries_.size();
+    for (auto id = first; id < next_id_; ++id)
+    {
+        if (this->entry(id).level >= level_filter_)
+        {
+            visible_.push_back(id);
+        }
+    }
+    this->triggerAsyncUpdate();
+}
+
+auto MessageLog::to_text() const -> std::string
+{
+    auto text = juce::String{};
+    auto const first = next_id_ - entries_.size();
+    for (auto id = first; id < next_id_; ++id)
+    {
+        auto const &e = this->entry(id);
+        text << format_row(e.time, e.level, *e.text, true) << '\n';
+    }
+    return text.toStdString();
 }
 
 auto MessageLog::getNumRows() -> int
 {
-    return static_cast<int>(messages_.size());
+    return static_cast<int>(visible_.size());
 }
 
 auto MessageLog::get_row_display(std::size_t index) -> juce::String
 {
-    return (index < messages_.size()) ? messages_[index] : "";
+    if (index >= visible_.size())
+    {
+        return "";
+    }
+    auto const &e = this->entry(visible_[index]);
+    return format_row(e.time, e.level, *e.text, false);
 }
 
 void MessageLog::item_selected(std::size_t)
@@ -51,4 +127,36 @@ void MessageLog::item_selected(std::size_t)
     // Do nothing.
 }
 
-} // namespace xen::gui
\ No newline at end of file
+void MessageLog::handleAsyncUpdate()
+{
+    this->updateContent();
+    this->repaint();
+}
+
+auto MessageLog::intern(std::string_view text) -> std::shared_ptr<std::string const>
+{
+    if (auto const at = interned_.find(text); at != interned_.end())
+    {
+        return at->second;
+    }
+
+    // At most capacity are still in the ring, so this runs at most once every
+    // capacity calls.
+    if (interned_.size() >= 2 * capacity)
+    {
+        // Only the map holds it, the message has left the ring.
+        std::erase_if(interned_,
+                      [](auto const &item) { return item.second.use_count() == 1; });
+    }
+
+    auto stored = std::make_shared<std::string const>(text);
+    interned_.emplace(std::string_view{*stored}, stored);
+    return stored;
+}
+
+auto MessageLog::entry(std::uint64_t id) const -> Entry const &
+{
+    return entries_[id % capacity];
+}
+
+} // namespace xen::gui
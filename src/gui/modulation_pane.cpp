@@ -1,6 +1,11 @@
 #include <xen/gui/modulation_pane.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <optional>
 #include <stdexcept>
 #include <string_view>
 #include <utility>
@@ -9,22 +14,40 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 
+#include <sequence/pattern.hpp>
+#include <sequence/sequence.hpp>
+
 #include <signals_light/signal.hpp>
 
+#include <xen/actions.hpp>
+#include <xen/clock.hpp>
+#include <xen/gui/animation_scheduler.hpp>
 #include <xen/gui/themes.hpp>
+#include <xen/modulator.hpp>
+#include <xen/parse_args.hpp>
+#include <xen/state.hpp>
 
 namespace
 {
 
 using namespace xen::gui;
 
-// {display name, command prefix}
-auto COMMANDS = std::vector<std::pair<std::string, std::string>>{
-    {"None", ""},
-    {"Weight", "set weights "},
-    {"Velocity", "set velocity "},
-    {"Delay", "set delay "},
-    {"Gate", "set gate "},
+using ModulateFn = auto (*)(sequence::Cell, sequence::Pattern const &,
+                            xen::Modulator const &) -> sequence::Cell;
+
+struct TargetCommand
+{
+    std::string display_name;
+    std::string command_prefix;
+    ModulateFn modulate; // Applies the same change as the command, for previews.
+};
+
+auto COMMANDS = std::vector<TargetCommand>{
+    {"None", "", nullptr},
+    {"Weight", "set weights ", &xen::action::set_weights},
+    {"Velocity", "set velocity ", &xen::action::set_velocities},
+    {"Delay", "set delay ", &xen::action::set_delays},
+    {"Gate", "set gate ", &xen::action::set_gates},
 };
 
 // TODO when min/max are set invalid/backwards, it throws, and the user can easily do
@@ -333,6 +356,16 @@ auto ModulationParameters::get_json() -> nlohmann::json
     return j;
 }
 
+auto ModulationParameters::get_args() const -> std::array<float, 4>
+{
+    auto args = std::array<float, 4>{};
+    for (auto i = std::size_t{0}; i < sliders_.size(); ++i)
+    {
+        args[i] = static_cast<float>(sliders_[i]->slider.getValue());
+    }
+    return args;
+}
+
 auto ModulationParameters::empty() -> bool
 {
     return type_.empty();
@@ -363,7 +396,7 @@ void ModulationParameters::resized()
 
 // -------------------------------------------------------------------------------------
 
-ModulationPane::ModulationPane()
+ModulationPane::ModulationPane(AnimationScheduler &scheduler) : scheduler_{scheduler}
 {
     std::generate(std::begin(parameter_uis_), std::end(parameter_uis_), [] {
         return std::make_unique<ModulationParameters>("", std::get<2>(MODULATORS[0]));
@@ -386,12 +419,12 @@ ModulationPane::ModulationPane()
         auto const mod_index = (std::size_t)modulator_dropdown_.getSelectedId() - 1;
         ui_ptr = std::make_unique<ModulationParameters>(
             std::get<1>(MODULATORS[mod_index]), std::get<2>(MODULATORS[mod_index]));
-        ui_ptr->on_change.connect([this] {
-            auto const cmd_str = this->generate_command_string(false);
-            if (!cmd_str.empty())
-            {
-                this->on_change(cmd_str);
-            }
+        preview_modulator_ = std::nullopt;
+        ui_ptr->on_change.connect([this, index = current_selection_] {
+            // Coalesced, animate() sends one preview for the frame.
+            changed_parameters_.set(index);
+            preview_pending_ = true;
+            scheduler_.start(*this);
         });
         ui_ptr->on_commit.connect([this] {
             auto const cmd_str = this->generate_command_string(true);
@@ -412,7 +445,7 @@ ModulationPane::ModulationPane()
 
     for (auto i = std::size_t{0}; i < COMMANDS.size(); ++i)
     {
-        auto const &name = COMMANDS[i].first;
+        auto const &name = COMMANDS[i].display_name;
         target_command_dropdown_.addItem(name, (int)i + 1);
     }
     target_command_dropdown_.setSelectedId(1, juce::dontSendNotification);
@@ -442,6 +475,13 @@ ModulationPane::ModulationPane()
         }
         this->resized();
     });
+
+    scheduler_.add(*this);
+}
+
+ModulationPane::~ModulationPane()
+{
+    scheduler_.remove(*this);
 }
 
 void ModulationPane::resized()
@@ -465,7 +505,28 @@ void ModulationPane::resized()
     outer_fb.performLayout(this->getLocalBounds());
 }
 
-auto ModulationPane::generate_json() -> std::string
+auto ModulationPane::animate(AudioThreadStateForGUI const &, Clock::time_point) -> bool
+{
+    if (!std::exchange(preview_pending_, false))
+    {
+        return false;
+    }
+
+    try
+    {
+        if (auto const preview = this->generate_preview(); preview.has_value())
+        {
+            this->on_preview(*preview);
+        }
+    }
+    catch (std::exception const &)
+    {
+        // Not previewed, the command sent on release reports the error.
+    }
+    return false;
+}
+
+auto ModulationPane::generate_json() -> nlohmann::json
 {
     auto j = nlohmann::json{};
     j["type"] = "blend";
@@ -498,7 +559,7 @@ auto ModulationPane::generate_json() -> std::string
                         }()}},
     };
 
-    return j.dump();
+    return j;
 }
 
 auto ModulationPane::generate_command_string(bool commit) -> std::string
@@ -512,9 +573,65 @@ auto ModulationPane::generate_command_string(bool commit) -> std::string
     {
         auto const cmd_index =
             (std::size_t)target_command_dropdown_.getSelectedId() - 1;
-        return COMMANDS[cmd_index].second + this->generate_json() +
+        return COMMANDS[cmd_index].command_prefix + this->generate_json().dump() +
                (commit ? " true" : " false");
     }
 }
 
+void ModulationPane::compile_preview_modulator()
+{
+    preview_modulator_ = modulator_from_json(this->generate_json());
+    changed_parameters_.reset();
+
+    // generate_json() blends two chains of 8 parameter UIs, which each compile to one
+    // instruction. blend() puts a BeginBlend or Accumulate, then a LoadInput, before
+    // each chain, and an empty chain compiles to a single Constant.
+    auto index = std::size_t{0};
+    for (auto const first : {std::size_t{0}, std::size_t{8}})
+    {
+        index += 2;
+        auto const chain_begin = index;
+        for (auto i = first; i < first + 8; ++i)
+        {
+            if (!parameter_uis_[i]->empty())
+            {
+                instruction_indices_[i] = index++;
+            }
+        }
+        index = std::max(index, chain_begin + 1);
+    }
+    assert(index + 2 == preview_modulator_->program().size()); // Accumulate, EndBlend
+}
+
+auto ModulationPane::generate_preview() -> std::optional<Preview>
+{
+    if (target_command_dropdown_.getSelectedId() == 1 ||
+        modulator_dropdown_.getSelectedId() == 1)
+    {
+        return std::nullopt;
+    }
+
+    if (!preview_modulator_.has_value())
+    {
+        this->compile_preview_modulator();
+    }
+    for (auto i = std::size_t{0}; i < parameter_uis_.size(); ++i)
+    {
+        if (changed_parameters_.test(i))
+        {
+            preview_modulator_->set_args(instruction_indices_[i],
+                                         parameter_uis_[i]->get_args());
+        }
+    }
+    changed_parameters_.reset();
+
+    auto const cmd_index = (std::size_t)target_command_dropdown_.getSelectedId() - 1;
+    auto const modulate = COMMANDS[cmd_index].modulate;
+
+    // The default Pattern of a command without a pattern prefix.
+    return [modulate, mod = *preview_modulator_](sequence::Cell const &cell) {
+        return modulate(cell, sequence::Pattern{0, {1}}, mod);
+    };
+}
+
 } // namespace xen::gui
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 #include <xen/command_history.hpp>
 #include <xen/double_buffer.hpp>
+#include <xen/gui/animation_scheduler.hpp>
 #include <xen/gui/bottom_bar.hpp>
 #include <xen/gui/command_bar.hpp>
 #include <xen/scale.hpp>
@@ -21,7 +22,8 @@ PluginWindow::PluginWindow(
     juce::File const &sequence_library_dir, juce::File const &tuning_library_dir,
     CommandHistory &cmd_history,
     DoubleBuffer<AudioThreadStateForGUI> const &audio_thread_state)
-    : center_component{sequence_library_dir, tuning_library_dir, audio_thread_state},
+    : animation_scheduler{*this, audio_thread_state},
+      center_component{sequence_library_dir, tuning_library_dir, animation_scheduler},
       bottom_bar{cmd_history}
 {
     this->addAndMakeVisible(center_component);
@@ -41,7 +43,7 @@ PluginWindow::PluginWindow(
 void PluginWindow::update(PluginState const &ps)
 {
     auto const [state, aux] = ps.timeline.get_state();
-    center_component.update(state, aux, ps.scales);
+    center_component.update(state, aux, *ps.resources->scales());
     bottom_bar.input_mode_indicator.set(aux.input_mode);
 }
 
@@ -0,0 +1,180 @@
+#include <xen/gui/staff.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include <juce_graphics/juce_graphics.h>
+
+#include <xen/scale.hpp>
+
+namespace
+{
+
+// Rows shorter than this are drawn without a gap between them.
+constexpr auto min_divided_row_height = 3;
+
+// Thinner bands are left as the lighter color, rather than flickering at every row.
+constexpr auto min_band_height = 2;
+
+/**
+ * Returns list of background colors for each pitch in tuning, starting with pitch 0.
+ */
+[[nodiscard]]
+auto generate_staff_line_colors(std::optional<xen::Scale> const &scale,
+                                juce::Colour light, std::size_t tuning_length,
+                                xen::TranslateDirection scale_translate_direction)
+    -> std::vector<juce::Colour>
+{
+    auto colors = std::vector<juce::Colour>{};
+    colors.reserve(tuning_length);
+    if (scale.has_value())
+    {
+        auto const pitches = xen::generate_valid_pitches(*scale);
+        juce::Colour current_color = light;
+        int previous_pitch = 0;
+
+        for (auto i = 0; i < (int)tuning_length; ++i)
+        {
+            auto const mapped_pitch =
+                map_pitch_to_scale(i, pitches, tuning_length, scale_translate_direction);
+
+            if (mapped_pitch != previous_pitch)
+            {
+                current_color = current_color == light ? light.darker(0.2f) : light;
+            }
+            colors.push_back(current_color);
+            previous_pitch = mapped_pitch;
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < tuning_length; ++i)
+        {
+            colors.push_back((i % 2 == 0) ? light : light.darker(0.2f));
+        }
+    }
+    return colors;
+}
+
+} // namespace
+
+namespace xen::gui
+{
+
+auto clamp_pitch_range(PitchRange range, std::size_t tuning_length) -> PitchRange
+{
+    if (range.count == 0 || range.count > tuning_length)
+    {
+        return {.first = 0, .count = tuning_length};
+    }
+    range.first = std::min(range.first, tuning_length - range.count);
+    return range;
+}
+
+auto pitch_row(juce::Rectangle<int> const &bounds, PitchRange range, std::size_t pitch)
+    -> std::optional<juce::Range<int>>
+{
+    assert(range.count > 0);
+    if (pitch < range.first || pitch >= range.first + range.count)
+    {
+        return std::nullopt;
+    }
+
+    auto const count = static_cast<int>(range.count);
+    auto const int_height = bounds.getHeight() / count;
+    auto const remainder = bounds.getHeight() % count;
+
+    auto const row = static_cast<int>(range.first + range.count - 1 - pitch);
+    auto const y = bounds.getY() + row * int_height + std::min(row, remainder);
+    auto const h = int_height + (row < remainder ? 1 : 0);
+    return juce::Range<int>::withStartAndLength(y, h);
+}
+
+auto pitch_at(juce::Rectangle<int> const &bounds, PitchRange range, int y)
+    -> std::size_t
+{
+    assert(range.count > 0);
+    auto const count = static_cast<int>(range.count);
+    auto const int_height = bounds.getHeight() / count;
+    auto const remainder = bounds.getHeight() % count;
+
+    // The first remainder rows are one pixel taller.
+    auto const offset = std::clamp(y - bounds.getY(), 0, bounds.getHeight() - 1);
+    auto const tall = remainder * (int_height + 1);
+    auto const row = offset < tall || int_height == 0
+                         ? offset / (int_height + 1)
+                         : remainder + (offset - tall) / int_height;
+
+    return range.first + range.count - 1 -
+           static_cast<std::size_t>(std::clamp(row, 0, count - 1));
+}
+
+void draw_staff(juce::Graphics &g, juce::Rectangle<int> bounds,
+                juce::Colour lighter_color, std::optional<Scale> const &scale,
+                std::size_t tuning_length, TranslateDirection scale_translate_direction,
+                PitchRange range)
+{
+    range = clamp_pitch_range(range, tuning_length);
+    if (range.count == 0 || bounds.isEmpty())
+    {
+        return;
+    }
+
+    auto const colors = generate_staff_line_colors(scale, lighter_color, tuning_length,
+                                                   scale_translate_direction);
+    assert(tuning_length == colors.size());
+
+    auto const top = range.first + range.count - 1;
+
+    if (bounds.getHeight() / (int)range.count >= min_divided_row_height)
+    {
+        for (auto i = std::size_t{0}; i < range.count; ++i)
+        {
+            auto const pitch = top - i;
+            auto const row = *pitch_row(bounds, range, pitch);
+            g.setColour(colors[pitch]);
+            if (i == 0)
+            {
+                g.fillRect(bounds.getX(), row.getStart(), bounds.getWidth(),
+                           row.getLength());
+            }
+            else // leave space for dividing line
+            {
+                g.fillRect(bounds.getX(), row.getStart() + 1, bounds.getWidth(),
+                           row.getLength() - 1);
+            }
+        }
+        return;
+    }
+
+    g.setColour(lighter_color);
+    g.fillRect(bounds);
+
+    auto const fill_band = [&](juce::Colour color, int y, int end) {
+        if (color != lighter_color && end - y >= min_band_height)
+        {
+            g.setColour(color);
+            g.fillRect(bounds.getX(), y, bounds.getWidth(), end - y);
+        }
+    };
+
+    auto band_color = colors[top];
+    auto band_y = bounds.getY();
+    for (auto i = std::size_t{1}; i < range.count; ++i)
+    {
+        auto const pitch = top - i;
+        if (colors[pitch] != band_color)
+        {
+            auto const y = pitch_row(bounds, range, pitch)->getStart();
+            fill_band(band_color, band_y, y);
+            band_color = colors[pitch];
+            band_y = y;
+        }
+    }
+    fill_band(band_color, band_y, bounds.getBottom());
+}
+
+} // namespace xen::gui
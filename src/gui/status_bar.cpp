@@ -37,7 +37,7 @@ void StatusBar::set_status(MessageLevel level, std::string text)
 
     label_.setColour(juce::Label::textColourId,
                      this->findColour(get_color_id(current_level_)));
-    label_.setFont(fonts::monospaced().regular.withHeight(18.f));
+    label_.setFont(fonts::monospaced().regular().withHeight(18.f));
     label_.setText(text, juce::dontSendNotification);
 }
 
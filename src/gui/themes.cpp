@@ -25,7 +25,7 @@ class CustomLookAndFeel : public juce::LookAndFeel_V4
     void drawButtonText(juce::Graphics &g, juce::TextButton &button, bool,
                         bool) override
     {
-        g.setFont(xen::gui::fonts::monospaced().bold.withHeight(20.f));
+        g.setFont(xen::gui::fonts::monospaced().bold().withHeight(20.f));
         g.setColour(button.findColour(juce::TextButton::textColourOffId));
         g.drawText(button.getButtonText(), button.getLocalBounds(),
                    juce::Justification::centred, true);
@@ -96,7 +96,7 @@ class CustomLookAndFeel : public juce::LookAndFeel_V4
     //     g.fillAll(this->findColour(xen::gui::ColorID::BackgroundLow));
 
     //     g.setColour(this->findColour(xen::gui::ColorID::ForegroundHigh));
-    //     g.setFont(xen::gui::fonts::monospaced().bold.withHeight(16.f));
+    //     g.setFont(xen::gui::fonts::monospaced().bold().withHeight(16.f));
 
     //     g.drawFittedText(text, 5, 0, width - 10, height,
     //                      juce::Justification::centredLeft, 1);
@@ -107,7 +107,7 @@ class CustomLookAndFeel : public juce::LookAndFeel_V4
     //     -> juce::Rectangle<int> override
     // {
     //     // Calculate a custom width and height for the tooltip
-    //     auto font = xen::gui::fonts::monospaced().bold.withHeight(16.f);
+    //     auto font = xen::gui::fonts::monospaced().bold().withHeight(16.f);
     //     auto width = font.getStringWidth(text) + 20;
     //     auto height = font.getHeight() + 10;
 
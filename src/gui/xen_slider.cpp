@@ -23,7 +23,8 @@ XenSlider::XenSlider(Metadata const &data, juce::Slider::SliderStyle style)
     this->addAndMakeVisible(slider);
 
     label.setText(data.display_name, juce::dontSendNotification);
-    label.setFont(fonts::monospaced().bold.withHeight((float)label.getHeight() * 0.7f));
+    label.setFont(
+        fonts::monospaced().bold().withHeight((float)label.getHeight() * 0.7f));
     label.setJustificationType(juce::Justification::centred);
 
     slider.setComponentID(data.id);
@@ -67,7 +68,8 @@ void XenSlider::resized()
         horizontal_margin + border_thickness + 3.f,
         vertical_margin + border_thickness + 3.f));
 
-    label.setFont(fonts::monospaced().bold.withHeight((float)label.getHeight() * 0.7f));
+    label.setFont(
+        fonts::monospaced().bold().withHeight((float)label.getHeight() * 0.7f));
 }
 
 void XenSlider::mouseUp(const juce::MouseEvent &e)
@@ -2,8 +2,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
+#include <functional>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <optional>
 #include <regex>
 #include <sstream>
@@ -18,6 +21,9 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <embed_tables.hpp>
+
+#include <xen/command.hpp>
 #include <xen/state.hpp>
 #include <xen/string_manip.hpp>
 #include <xen/utility.hpp>
@@ -28,34 +34,44 @@ namespace
 using namespace xen;
 
 /**
- * Merge two YAML files into a single YAML::Node, with the overlay taking precedence.
+ * Key combination strings and their commands, for each component in file order.
+ */
+using KeyBindings = std::vector<
+    std::pair<std::string, std::vector<std::pair<std::string, std::string>>>>;
+
+/**
+ * Overlay the bindings in the user keys file onto the built-in key bindings.
  *
- * @details This is not a general solution, this is specific to the XenSequencer key
- * config. This will remove the 'version' top-level key from base.
- * @param base_filepath The base YAML file.
- * @param overlay_filepath The overlay YAML file.
- * @return YAML::Node The merged YAML node.
- * @throws YAML::Exception if there is an error parsing the YAML files.
+ * @details The built-in bindings are converted from keys.yml at build time, so only
+ * the user file is parsed. A user binding replaces a built-in binding with the same
+ * key string, other bindings and components are appended.
+ * @param overlay_filepath The user keys YAML file.
+ * @throws YAML::Exception if there is an error parsing the YAML file.
  * @throws std::runtime_error if the YAML file structure is invalid.
- * @throws std::runtime_error if either file is larger than 128MB
+ * @throws std::runtime_error if the file is larger than 128MB
  */
-[[nodiscard]] auto merge_yaml_files(juce::File const &base_filepath,
-                                    juce::File const &overlay_filepath) -> YAML::Node
+[[nodiscard]] auto merge_user_keys(juce::File const &overlay_filepath) -> KeyBindings
 {
-    if (base_filepath.getSize() > (128 * 1'024 * 1'024))
+    auto base = KeyBindings{};
+    for (auto const &entry : embed_tables::key_bindings)
     {
-        throw std::runtime_error{"System keys file size exceeds 128MB"};
+        if (base.empty() || base.back().first != entry.component)
+        {
+            base.emplace_back(std::string{entry.component},
+                              KeyBindings::value_type::second_type{});
+        }
+        base.back().second.emplace_back(std::string{entry.keys},
+                                        std::string{entry.command});
     }
+
     if (overlay_filepath.getSize() > (128 * 1'024 * 1'024))
     {
         throw std::runtime_error{"User keys file size exceeds 128MB"};
     }
 
-    auto base = YAML::LoadFile(base_filepath.getFullPathName().toStdString());
     auto overlay = YAML::LoadFile(overlay_filepath.getFullPathName().toStdString());
-    base.remove("version");
 
-    if (!base.IsMap() || !overlay.IsMap())
+    if (!overlay.IsMap())
     {
         // TODO catch this and display as error message in GUI
         throw std::runtime_error{"Invalid YAML file structure."};
@@ -64,12 +80,28 @@ using namespace xen;
     for (auto overlay_pair : overlay)
     {
         auto component_name = overlay_pair.first.as<std::string>();
-        auto bindings_node = overlay_pair.second;
-        for (auto key : bindings_node)
+        auto component = std::ranges::find(base, component_name,
+                                           &KeyBindings::value_type::first);
+        if (component == std::end(base))
+        {
+            component = base.insert(std::end(base), {component_name, {}});
+        }
+        auto &bindings = component->second;
+
+        for (auto key : overlay_pair.second)
         {
             auto key_value = key.first.as<std::string>();
             auto value_value = key.second.as<std::string>();
-            base[component_name][key_value] = value_value;
+            auto binding = std::ranges::find(
+                bindings, key_value, &std::pair<std::string, std::string>::first);
+            if (binding == std::end(bindings))
+            {
+                bindings.emplace_back(std::move(key_value), std::move(value_value));
+            }
+            else
+            {
+                binding->second = std::move(value_value);
+            }
         }
     }
 
@@ -285,116 +317,211 @@ auto const key_map = [] {
 }
 
 /**
- * Parse a YAML::Node into a collection of KeyCore objects.
+ * Split \p text around every `:N=default:` placeholder.
  *
- * @param root The root YAML node.
- * @return A map of KeyCore objects, one for each component.
+ * @param text The text to split.
+ * @return std::vector<std::string> The text between each placeholder. This has one more
+ * element than there are placeholders.
  */
-[[nodiscard]] auto create_component_key_cores(YAML::Node const &root)
-    -> std::unordered_map<std::string, KeyCore>
+[[nodiscard]] auto split_on_placeholder(std::string const &text)
+    -> std::vector<std::string>
 {
-    auto component_to_keycore = std::unordered_map<std::string, KeyCore>{};
+    static auto const re = std::regex{R"(:N=(\d+):)"};
 
-    for (auto const &component : root)
+    auto pieces = std::vector<std::string>{};
+    auto match = std::smatch{};
+    auto begin = std::cbegin(text);
+    while (std::regex_search(begin, std::cend(text), match, re))
     {
-        auto component_name = component.first.as<std::string>();
-        component_name = to_lower(component_name);
-        auto const &key_mappings = component.second;
+        pieces.push_back(match.prefix().str());
+        begin = match.suffix().first;
+    }
+    pieces.emplace_back(begin, std::cend(text));
+    return pieces;
+}
 
-        auto configs = std::vector<KeyConfig>{};
+/**
+ * Join \p pieces with \p value in between each piece.
+ */
+[[nodiscard]] auto fill_placeholder(std::vector<std::string> const &pieces,
+                                    std::string const &value) -> std::string
+{
+    auto result = pieces.front();
+    for (auto i = std::size_t{1}; i < pieces.size(); ++i)
+    {
+        result += value;
+        result += pieces[i];
+    }
+    return result;
+}
 
-        for (auto const &mapping : key_mappings)
+} // namespace
+
+namespace xen
+{
+
+KeyBinding::KeyBinding(std::string const &command_string)
+{
+    static auto const re = std::regex{R"(:N=(\d+):)"};
+
+    auto match = std::smatch{};
+    if (!std::regex_search(command_string, match, re))
+    {
+        default_commands_ = prepare_command_string(command_string);
+        return;
+    }
+
+    // Without a prefix, every placeholder takes the first placeholder's default.
+    default_commands_ =
+        prepare_command_string(std::regex_replace(command_string, re, match.str(1)));
+    auto const templates = prepare_command_string(command_string);
+
+    // Placeholders never contain spaces or quotes, so both preparations have the same
+    // shape unless a placeholder was used where a Pattern is parsed.
+    auto const invalid = std::invalid_argument{
+        "`:N=default:` must be used within a command argument: " +
+        single_quote(command_string)};
+
+    if (templates.size() != default_commands_.size())
+    {
+        throw invalid;
+    }
+
+    for (auto i = std::size_t{0}; i < templates.size(); ++i)
+    {
+        auto const &templ = templates[i];
+        auto const &defaults = default_commands_[i];
+
+        if (!(templ.input.pattern == defaults.input.pattern) ||
+            templ.input.words.size() != defaults.input.words.size())
         {
-            auto const key_combo_str = mapping.first.as<std::string>();
-            auto const command = mapping.second.as<std::string>();
+            throw invalid;
+        }
 
-            auto config = parse_key_config(key_combo_str, command);
-            configs.push_back(std::move(config));
+        if (!std::regex_search(templ.text, re))
+        {
+            continue;
         }
 
-        auto const [_, inserted] =
-            component_to_keycore.try_emplace(component_name, KeyCore{configs});
+        prefix_slots_.push_back(PrefixSlot{
+            .command_index = i,
+            .word_index = std::nullopt,
+            .pieces = split_on_placeholder(templ.text),
+        });
 
-        if (!inserted)
+        for (auto j = std::size_t{0}; j < templ.input.words.size(); ++j)
         {
-            throw std::runtime_error{"Duplicate component name in key config file."};
+            if (std::regex_search(templ.input.words[j], re))
+            {
+                prefix_slots_.push_back(PrefixSlot{
+                    .command_index = i,
+                    .word_index = j,
+                    .pieces = split_on_placeholder(templ.input.words[j]),
+                });
+            }
         }
     }
-
-    return component_to_keycore;
 }
 
-void insert_prefix_int(std::optional<int> value, std::string &cmd_str)
+auto KeyBinding::commands(std::optional<int> prefix) const
+    -> std::vector<PreparedCommand>
 {
-    auto const re = std::regex{R"(:N=(\d+):)"};
-    auto match = std::smatch{};
-    if (value.has_value())
+    if (!prefix.has_value() || prefix_slots_.empty())
     {
-        // Replace ":N=integer:" with value.
-        cmd_str = std::regex_replace(cmd_str, re, std::to_string(*value));
+        return default_commands_;
     }
-    else if (std::regex_search(cmd_str, match, re) && match.size() > 1)
+
+    auto result = default_commands_;
+    auto const value = std::to_string(*prefix);
+    for (auto const &slot : prefix_slots_)
     {
-        // Look for ":N=integer:" and remove everything but integer
-        cmd_str = std::regex_replace(cmd_str, re, match.str(1));
+        auto &command = result[slot.command_index];
+        auto filled = fill_placeholder(slot.pieces, value);
+        if (slot.word_index.has_value())
+        {
+            command.input.words[*slot.word_index] = std::move(filled);
+        }
+        else
+        {
+            command.text = std::move(filled);
+        }
     }
+    return result;
 }
 
-} // namespace
+// -------------------------------------------------------------------------------------
 
-namespace xen
+auto KeyPressHash::operator()(juce::KeyPress const &key) const -> std::size_t
 {
+    // KeyPress::operator== ignores the text character when either side is unset and
+    // compares key codes below 256 case-insensitively, so this must do the same.
+    auto code = key.getKeyCode();
+    if (code < 256)
+    {
+        code = (int)juce::CharacterFunctions::toLowerCase((juce::juce_wchar)code);
+    }
+    return std::hash<int>{}(code) ^ (std::hash<int>{}(key.getModifiers().getRawFlags())
+                                     << 1);
+}
+
+// -------------------------------------------------------------------------------------
 
 KeyCore::KeyCore(std::vector<KeyConfig> const &configs)
 {
     for (auto const &config : configs)
     {
-        if (config.mode)
+        try
         {
-            mode_sensitive_actions_[*config.mode].push_back(
-                KeyCore::KeyAction{config.keypress, config.command});
+            auto binding = KeyBinding{config.command};
+
+            // The first binding for a key wins.
+            auto &table = config.mode ? mode_sensitive_actions_[*config.mode]
+                                      : mode_independent_actions_;
+            table.try_emplace(config.keypress, std::move(binding));
         }
-        else
+        catch (std::exception const &e)
         {
-            mode_independent_actions_.push_back(
-                KeyCore::KeyAction{config.keypress, config.command});
+            skipped_.push_back(
+                "Invalid command for key " +
+                single_quote(config.keypress.getTextDescription().toStdString()) +
+                ", " + single_quote(config.command) + ": " + e.what());
         }
     }
 }
 
-auto KeyCore::find_action(const juce::KeyPress &key, InputMode mode) const
-    -> std::optional<std::string>
+auto KeyCore::skipped() const -> std::vector<std::string> const &
+{
+    return skipped_;
+}
+
+auto KeyCore::find_action(juce::KeyPress const &key, InputMode mode) const
+    -> KeyBinding const *
 {
     // Check mode-sensitive actions first
     auto const it_mode = mode_sensitive_actions_.find(mode);
     if (it_mode != std::cend(mode_sensitive_actions_))
     {
-        auto &actions = it_mode->second;
-
-        auto const it_key = std::ranges::find_if(
-            actions, [key](auto const &x) { return x.key == key; });
-
-        if (it_key != std::cend(actions))
+        auto const it_key = it_mode->second.find(key);
+        if (it_key != std::cend(it_mode->second))
         {
-            return it_key->action;
+            return &it_key->second;
         }
     }
 
     // Check mode-independent actions
-    auto const it_key = std::ranges::find_if(
-        mode_independent_actions_, [key](auto const &x) { return x.key == key; });
-
-    if (it_key != std::end(mode_independent_actions_))
+    auto const it_key = mode_independent_actions_.find(key);
+    if (it_key != std::cend(mode_independent_actions_))
     {
-        return it_key->action;
+        return &it_key->second;
     }
 
-    return std::nullopt;
+    return nullptr;
 }
 
 // -------------------------------------------------------------------------------------
 
-KeyConfigListener::KeyConfigListener(KeyCore key_core, XenTimeline const &tl)
+KeyConfigListener::KeyConfigListener(std::shared_ptr<KeyCore const> key_core,
+                                     XenTimeline const &tl)
     : key_core_{std::move(key_core)}, tl_{tl}, prefix_int_{std::nullopt}
 {
 }
@@ -412,12 +539,13 @@ auto KeyConfigListener::keyPressed(juce::KeyPress const &key, juce::Component *)
             prefix_int_ = *prefix_int_ * 10 + (key.getTextCharacter() - '0');
         }
     }
-    auto action = key_core_.find_action(key, tl_.get_state().aux.input_mode);
-    if (action)
+    auto const *const binding =
+        key_core_->find_action(key, tl_.peek_state().aux.input_mode);
+    if (binding != nullptr)
     {
-        insert_prefix_int(prefix_int_, *action);
-        on_command.emit(*action);
+        auto const commands = binding->commands(prefix_int_);
         prefix_int_ = std::nullopt;
+        on_command.emit(commands);
         return true;
     }
     return false;
@@ -432,17 +560,46 @@ auto KeyConfigListener::keyStateChanged(bool isKeyDown, juce::Component *) -> bo
 
 // -------------------------------------------------------------------------------------
 
-auto build_key_listeners(juce::File const &default_keys, juce::File const &user_keys,
-                         XenTimeline const &tl)
-    -> std::map<std::string, KeyConfigListener>
+auto load_key_cores(juce::File const &user_keys) -> SharedResources::KeyCores
+{
+    auto component_to_keycore = SharedResources::KeyCores{};
+
+    for (auto const &[name, key_mappings] : merge_user_keys(user_keys))
+    {
+        auto const component_name = to_lower(name);
+
+        auto configs = std::vector<KeyConfig>{};
+
+        for (auto const &[key_combo_str, command] : key_mappings)
+        {
+            auto config = parse_key_config(key_combo_str, command);
+            configs.push_back(std::move(config));
+        }
+
+        auto const [_, inserted] =
+            component_to_keycore.try_emplace(component_name, KeyCore{configs});
+
+        if (!inserted)
+        {
+            throw std::runtime_error{"Duplicate component name in key config file."};
+        }
+    }
+
+    return component_to_keycore;
+}
+
+auto build_key_listeners(
+    std::shared_ptr<SharedResources::KeyCores const> const &key_cores,
+    XenTimeline const &tl) -> std::map<std::string, KeyConfigListener>
 {
-    auto const keys_node = merge_yaml_files(default_keys, user_keys);
-    auto key_cores = create_component_key_cores(keys_node);
     auto result = std::map<std::string, KeyConfigListener>{};
 
-    for (auto &[component_name, key_core] : key_cores)
+    for (auto const &[component_name, key_core] : *key_cores)
     {
-        result.try_emplace(component_name, KeyConfigListener{std::move(key_core), tl});
+        // Aliases key_cores, so every listener keeps the shared map alive.
+        auto shared_core = std::shared_ptr<KeyCore const>{key_cores, &key_core};
+        result.try_emplace(component_name,
+                           KeyConfigListener{std::move(shared_core), tl});
     }
 
     return result;
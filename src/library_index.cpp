@@ -0,0 +1,625 @@
+#include <xen/library_index.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include <sequence/measure.hpp>
+#include <sequence/tuning.hpp>
+
+#include <xen/actions.hpp>
+#include <xen/gui/bg_sequence.hpp>
+#include <xen/library_search.hpp>
+#include <xen/user_directory.hpp>
+
+namespace
+{
+
+using namespace xen;
+
+constexpr auto magic = std::array<char, 4>{'X', 'L', 'I', 'B'};
+constexpr auto version = std::uint32_t{2};
+
+/**
+ * Appends little-endian values to a byte string.
+ */
+class Writer
+{
+  public:
+    std::string bytes;
+
+  public:
+    void u8(std::uint8_t x)
+    {
+        bytes.push_back(static_cast<char>(x));
+    }
+
+    void u32(std::uint32_t x)
+    {
+        for (auto i = 0; i < 4; ++i)
+        {
+            this->u8(static_cast<std::uint8_t>(x >> (8 * i)));
+        }
+    }
+
+    void i64(juce::int64 x)
+    {
+        this->u32(static_cast<std::uint32_t>(static_cast<std::uint64_t>(x)));
+        this->u32(static_cast<std::uint32_t>(static_cast<std::uint64_t>(x) >> 32));
+    }
+
+    void f32(float x)
+    {
+        this->u32(std::bit_cast<std::uint32_t>(x));
+    }
+
+    void str(std::string const &x)
+    {
+        this->u32(static_cast<std::uint32_t>(x.size()));
+        bytes += x;
+    }
+};
+
+/**
+ * Reads little-endian values in order from a byte span, with bounds checks.
+ */
+class Reader
+{
+  public:
+    explicit Reader(std::span<std::byte const> bytes) : bytes_{bytes}
+    {
+    }
+
+  public:
+    [[nodiscard]] auto u8() -> std::uint8_t
+    {
+        this->check(1);
+        return static_cast<std::uint8_t>(bytes_[at_++]);
+    }
+
+    [[nodiscard]] auto u32() -> std::uint32_t
+    {
+        auto x = std::uint32_t{0};
+        for (auto i = 0; i < 4; ++i)
+        {
+            x |= static_cast<std::uint32_t>(this->u8()) << (8 * i);
+        }
+        return x;
+    }
+
+    [[nodiscard]] auto i64() -> juce::int64
+    {
+        auto const low = static_cast<std::uint64_t>(this->u32());
+        auto const high = static_cast<std::uint64_t>(this->u32());
+        return static_cast<juce::int64>(low | high << 32);
+    }
+
+    [[nodiscard]] auto f32() -> float
+    {
+        return std::bit_cast<float>(this->u32());
+    }
+
+    [[nodiscard]] auto str() -> std::string
+    {
+        auto const size = this->u32();
+        this->check(size);
+        auto const begin = reinterpret_cast<char const *>(bytes_.data()) + at_;
+        at_ += size;
+        return std::string(begin, size);
+    }
+
+    /**
+     * Read a count of items that each take at least \p item_size bytes.
+     */
+    [[nodiscard]] auto count(std::size_t item_size) -> std::uint32_t
+    {
+        auto const n = this->u32();
+        this->check(n * item_size);
+        return n;
+    }
+
+  private:
+    void check(std::size_t size) const
+    {
+        if (size > bytes_.size() - at_)
+        {
+            throw std::invalid_argument{"Library Index Is Truncated"};
+        }
+    }
+
+  private:
+    std::span<std::byte const> bytes_;
+    std::size_t at_ = 0;
+};
+
+[[nodiscard]] auto to_u8(float unit) -> std::uint8_t
+{
+    return static_cast<std::uint8_t>(std::clamp(std::lround(unit * 255.f), 0l, 255l));
+}
+
+[[nodiscard]] auto make_measure(sequence::Measure const &measure, std::string name)
+    -> LibraryEntry::Measure
+{
+    auto const ir = gui::generate_ir(measure.cell, 12);
+
+    auto result = LibraryEntry::Measure{
+        .name = std::move(name),
+        .numerator = static_cast<std::uint32_t>(measure.time_signature.numerator),
+        .denominator = static_cast<std::uint32_t>(measure.time_signature.denominator),
+        .note_count = static_cast<std::uint32_t>(ir.size()),
+        .preview = {},
+    };
+
+    auto const shown = std::min(ir.size(), LibraryEntry::preview_note_limit);
+    if (shown == 0)
+    {
+        return result;
+    }
+
+    auto const [lowest, highest] = std::ranges::minmax(
+        std::span{ir.data(), shown} |
+        std::views::transform([](gui::NoteIR const &n) { return n.note.pitch; }));
+    auto const range = static_cast<float>(highest - lowest);
+
+    result.preview.reserve(shown);
+    for (auto const &n : std::span{ir.data(), shown})
+    {
+        auto const height = static_cast<float>(n.note.pitch - lowest);
+        result.preview.push_back({
+            .x = to_u8(n.x),
+            .width = std::max(to_u8(n.width), std::uint8_t{1}),
+            .y = range == 0.f ? std::uint8_t{128} : to_u8(height / range),
+        });
+    }
+    return result;
+}
+
+[[nodiscard]] auto parent_path(std::string const &path) -> std::string
+{
+    auto const at = path.rfind(static_cast<char>(juce::File::getSeparatorChar()));
+    return at == std::string::npos ? std::string{} : path.substr(0, at);
+}
+
+} // namespace
+
+namespace xen
+{
+
+auto read_library_entry(juce::File const &file) -> LibraryEntry
+{
+    auto const extension = file.getFileExtension().toLowerCase();
+    if (extension != ".xss" && extension != ".scl")
+    {
+        throw std::invalid_argument{"Not A Library File: " +
+                                    file.getFullPathName().toStdString()};
+    }
+
+    auto entry = LibraryEntry{
+        .path = file.getFullPathName().toStdString(),
+        .modified = file.getLastModificationTime().toMilliseconds(),
+        .size = file.getSize(),
+        .type = extension == ".xss" ? LibraryEntry::Type::SequenceBank
+                                    : LibraryEntry::Type::Tuning,
+        .readable = false,
+        .measures = {},
+        .tuning = {},
+    };
+
+    try
+    {
+        if (entry.type == LibraryEntry::Type::SequenceBank)
+        {
+            auto const [bank, names] = action::load_sequence_bank(file);
+            for (auto i = std::size_t{0}; i < bank.size(); ++i)
+            {
+                entry.measures.push_back(make_measure(bank[i], names[i]));
+            }
+        }
+        else
+        {
+            entry.tuning = sequence::from_scala(entry.path);
+        }
+        entry.readable = true;
+    }
+    catch (std::exception const &)
+    {
+        entry.measures.clear();
+    }
+    return entry;
+}
+
+auto serialize_library_index(std::vector<LibraryEntry> const &entries) -> std::string
+{
+    auto w = Writer{};
+    w.bytes.append(magic.data(), magic.size());
+    w.u32(version);
+    w.u32(static_cast<std::uint32_t>(entries.size()));
+    for (auto const &entry : entries)
+    {
+        w.str(entry.path);
+        w.i64(entry.modified);
+        w.i64(entry.size);
+        w.u8(static_cast<std::uint8_t>(entry.type));
+        w.u8(entry.readable ? 1 : 0);
+
+        w.u32(static_cast<std::uint32_t>(entry.measures.size()));
+        for (auto const &measure : entry.measures)
+        {
+            w.str(measure.name);
+            w.u32(measure.numerator);
+            w.u32(measure.denominator);
+            w.u32(measure.note_count);
+            w.u32(static_cast<std::uint32_t>(measure.preview.size()));
+            for (auto const &note : measure.preview)
+            {
+                w.u8(note.x);
+                w.u8(note.width);
+                w.u8(note.y);
+            }
+        }
+
+        w.str(entry.tuning.description);
+        w.f32(entry.tuning.octave);
+        w.u32(static_cast<std::uint32_t>(entry.tuning.intervals.size()));
+        for (auto const interval : entry.tuning.intervals)
+        {
+            w.f32(interval);
+        }
+    }
+    return std::move(w.bytes);
+}
+
+auto deserialize_library_index(std::span<std::byte const> bytes)
+    -> std::vector<LibraryEntry>
+{
+    if (bytes.size() < magic.size() ||
+        !std::equal(magic.begin(), magic.end(), bytes.begin(),
+                    [](char a, std::byte b) { return a == static_cast<char>(b); }))
+    {
+        throw std::invalid_argument{"Not A Library Index"};
+    }
+
+    auto r = Reader{bytes.subspan(magic.size())};
+    if (r.u32() != version)
+    {
+        throw std::invalid_argument{"Unsupported Library Index Version"};
+    }
+
+    auto entries = std::vector<LibraryEntry>(r.count(30));
+    for (auto &entry : entries)
+    {
+        entry.path = r.str();
+        entry.modified = r.i64();
+        entry.size = r.i64();
+        auto const type = r.u8();
+        if (type > static_cast<std::uint8_t>(LibraryEntry::Type::Tuning))
+        {
+            throw std::invalid_argument{"Invalid Library Entry Type"};
+        }
+        entry.type = static_cast<LibraryEntry::Type>(type);
+        entry.readable = r.u8() != 0;
+
+        entry.measures.resize(r.count(20));
+        for (auto &measure : entry.measures)
+        {
+            measure.name = r.str();
+            measure.numerator = r.u32();
+            measure.denominator = r.u32();
+            measure.note_count = r.u32();
+            measure.preview.resize(r.count(3));
+            for (auto &note : measure.preview)
+            {
+                note.x = r.u8();
+                note.width = r.u8();
+                note.y = r.u8();
+            }
+        }
+
+        entry.tuning.description = r.str();
+        entry.tuning.octave = r.f32();
+        entry.tuning.intervals.resize(r.count(4));
+        for (auto &interval : entry.tuning.intervals)
+        {
+            interval = r.f32();
+        }
+    }
+    return entries;
+}
+
+// -------------------------------------------------------------------------------------
+
+LibraryIndex::LibraryIndex()
+    : entries_{std::make_shared<Entries const>()}, thread_{[this] { this->run(); }}
+{
+}
+
+LibraryIndex::~LibraryIndex()
+{
+    {
+        auto const lock = std::lock_guard{mtx_};
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void LibraryIndex::add_directory(juce::File const &directory)
+{
+    {
+        auto const lock = std::lock_guard{mtx_};
+        added_directories_.push_back(directory);
+    }
+    cv_.notify_one();
+}
+
+auto LibraryIndex::find(juce::File const &file) const
+    -> std::shared_ptr<LibraryEntry const>
+{
+    auto const entries = this->entries();
+    auto const at = entries->find(file.getFullPathName().toStdString());
+    return at == entries->end() ? nullptr : at->second;
+}
+
+auto LibraryIndex::find_current(juce::File const &file) const
+    -> std::shared_ptr<LibraryEntry const>
+{
+    auto entry = this->find(file);
+    if (entry == nullptr ||
+        entry->modified != file.getLastModificationTime().toMilliseconds() ||
+        entry->size != file.getSize())
+    {
+        return nullptr;
+    }
+    return entry;
+}
+
+auto LibraryIndex::entries() const -> std::shared_ptr<Entries const>
+{
+    auto const lock = std::lock_guard{mtx_};
+    return entries_;
+}
+
+auto LibraryIndex::search(std::string_view query) const
+    -> std::vector<std::shared_ptr<LibraryEntry const>>
+{
+    auto search = std::shared_ptr<LibrarySearch const>{};
+    {
+        auto const lock = std::lock_guard{mtx_};
+        search = search_;
+    }
+    return search == nullptr ? std::vector<std::shared_ptr<LibraryEntry const>>{}
+                             : search->search(query);
+}
+
+void LibraryIndex::run()
+{
+    auto scan = Scan{};
+    try
+    {
+        index_file_ = get_user_library_directory().getChildFile("library_index.bin");
+        roots_ = {get_sequences_directory(), get_tunings_directory()};
+    }
+    catch (std::exception const &)
+    {
+        // Without a library there is nothing to index, directories may still be added.
+    }
+
+    this->load_saved_index(scan.entries);
+    this->publish(scan.entries, true);
+
+    for (auto const &root : roots_)
+    {
+        this->scan_directory(root, true, scan);
+    }
+
+    for (auto poll = 1;; ++poll)
+    {
+        // A scan interrupted by stopping hasn't seen every file.
+        if (this->is_stopping())
+        {
+            return;
+        }
+        if (this->remove_missing(scan) > 0 || scan.read_count > 0)
+        {
+            this->publish(scan.entries, true);
+            this->save(scan.entries);
+        }
+        scan.scanned_directories.clear();
+        scan.seen_files.clear();
+        scan.read_count = 0;
+
+        auto added = std::vector<juce::File>{};
+        {
+            auto lock = std::unique_lock{mtx_};
+            cv_.wait_for(lock, poll_interval,
+                         [this] { return stop_ || !added_directories_.empty(); });
+            if (stop_)
+            {
+                return;
+            }
+            added = std::exchange(added_directories_, {});
+        }
+
+        for (auto const &directory : added)
+        {
+            if (!watched_.contains(directory.getFullPathName().toStdString()) &&
+                directory.isDirectory())
+            {
+                this->scan_directory(directory, false, scan);
+            }
+        }
+
+        // Copied, scan_directory adds new subdirectories to watched_.
+        auto const watched = watched_;
+        auto const full_scan = poll % full_scan_polls == 0;
+        for (auto const &[path, watch] : watched)
+        {
+            auto const directory = juce::File{juce::String{path}};
+            if (!directory.isDirectory())
+            {
+                watched_.erase(path);
+                scan.scanned_directories.push_back(path);
+            }
+            else if (full_scan ||
+                     directory.getLastModificationTime().toMilliseconds() !=
+                         watch.modified)
+            {
+                this->scan_directory(directory, watch.recursive, scan);
+            }
+        }
+    }
+}
+
+auto LibraryIndex::is_stopping() const -> bool
+{
+    auto const lock = std::lock_guard{mtx_};
+    return stop_;
+}
+
+void LibraryIndex::load_saved_index(Entries &entries)
+{
+    try
+    {
+        auto data = juce::MemoryBlock{};
+        if (!index_file_.existsAsFile() || !index_file_.loadFileAsData(data))
+        {
+            return;
+        }
+        auto saved = deserialize_library_index(
+            std::span{static_cast<std::byte const *>(data.getData()), data.getSize()});
+
+        // Directories outside of the library are only indexed once browsed to.
+        for (auto &entry : saved)
+        {
+            auto const file = juce::File{juce::String{entry.path}};
+            if (std::ranges::any_of(roots_, [&](juce::File const &root) {
+                    return file.isAChildOf(root);
+                }))
+            {
+                auto path = entry.path;
+                entries.emplace(std::move(path),
+                                std::make_shared<LibraryEntry const>(std::move(entry)));
+            }
+        }
+    }
+    catch (std::exception const &)
+    {
+        entries.clear(); // Rebuilt by the first scan.
+    }
+}
+
+void LibraryIndex::scan_directory(juce::File const &directory, bool recursive,
+                                  Scan &scan)
+{
+    auto const path = directory.getFullPathName().toStdString();
+    watched_[path] = Watch{
+        .modified = directory.getLastModificationTime().toMilliseconds(),
+        .recursive = recursive,
+    };
+    scan.scanned_directories.push_back(path);
+
+    for (auto const &child :
+         directory.findChildFiles(juce::File::findFilesAndDirectories, false, "*"))
+    {
+        if (this->is_stopping())
+        {
+            return;
+        }
+
+        auto child_path = child.getFullPathName().toStdString();
+        if (child.isDirectory())
+        {
+            if (recursive && !child.isSymbolicLink() && !watched_.contains(child_path))
+            {
+                this->scan_directory(child, true, scan);
+            }
+            continue;
+        }
+        if (!child.hasFileExtension("xss;scl"))
+        {
+            continue;
+        }
+
+        auto const at = scan.entries.find(child_path);
+        if (at == scan.entries.end() ||
+            at->second->modified != child.getLastModificationTime().toMilliseconds() ||
+            at->second->size != child.getSize())
+        {
+            scan.entries.insert_or_assign(
+                child_path,
+                std::make_shared<LibraryEntry const>(read_library_entry(child)));
+            if (++scan.read_count % publish_count == 0)
+            {
+                this->publish(scan.entries, false);
+            }
+        }
+        scan.seen_files.push_back(std::move(child_path));
+    }
+}
+
+auto LibraryIndex::remove_missing(Scan &scan) -> std::size_t
+{
+    if (scan.scanned_directories.empty())
+    {
+        return 0;
+    }
+    std::ranges::sort(scan.scanned_directories);
+    std::ranges::sort(scan.seen_files);
+
+    return std::erase_if(scan.entries, [&scan](auto const &item) {
+        return std::ranges::binary_search(scan.scanned_directories,
+                                          parent_path(item.first)) &&
+               !std::ranges::binary_search(scan.seen_files, item.first);
+    });
+}
+
+void LibraryIndex::publish(Entries const &entries, bool rebuild_search)
+{
+    auto published = std::make_shared<Entries const>(entries);
+    auto search = rebuild_search ? std::make_shared<LibrarySearch const>(entries)
+                                 : nullptr;
+    {
+        auto const lock = std::lock_guard{mtx_};
+        entries_ = std::move(published);
+        if (search != nullptr)
+        {
+            search_ = std::move(search);
+        }
+    }
+    this->sendChangeMessage();
+}
+
+void LibraryIndex::save(Entries const &entries)
+{
+    if (index_file_ == juce::File{})
+    {
+        return;
+    }
+
+    auto all = std::vector<LibraryEntry>{};
+    all.reserve(entries.size());
+    std::ranges::transform(entries, std::back_inserter(all),
+                           [](auto const &item) { return *item.second; });
+
+    // Not critical, the index is rebuilt from the files if this fails.
+    auto const bytes = serialize_library_index(all);
+    index_file_.replaceWithData(bytes.data(), bytes.size());
+}
+
+} // namespace xen
@@ -0,0 +1,385 @@
+#include <xen/library_search.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+#include <xen/library_index.hpp>
+
+namespace
+{
+
+enum class Attribute
+{
+    NoteCount,
+    TuningSize,
+    TimeSignature,
+};
+
+enum class Comparison
+{
+    Equal,
+    Less,
+    Greater,
+    LessOrEqual,
+    GreaterOrEqual,
+};
+
+struct AttributeFilter
+{
+    Attribute attribute;
+    Comparison comparison;
+    std::uint32_t value;
+    std::uint32_t denominator; // Time signatures only.
+};
+
+[[nodiscard]] auto is_word_char(char c) -> bool
+{
+    auto const u = static_cast<unsigned char>(c);
+    return u >= 0x80 || (u >= '0' && u <= '9') || (u >= 'a' && u <= 'z') ||
+           (u >= 'A' && u <= 'Z');
+}
+
+[[nodiscard]] auto to_lower_ascii(char c) -> char
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+[[nodiscard]] auto parse_unsigned(std::string_view text, std::string_view term)
+    -> std::uint32_t
+{
+    auto value = std::uint32_t{0};
+    auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(),
+                                              value);
+    if (text.empty() || error != std::errc{} || end != text.data() + text.size())
+    {
+        throw std::invalid_argument{"Invalid Search Value: " + std::string{term}};
+    }
+    return value;
+}
+
+/**
+ * Parse \p term as an attribute filter, or return std::nullopt if it is a plain term.
+ *
+ * @throws std::invalid_argument If the term names an attribute with an invalid value.
+ */
+[[nodiscard]] auto parse_attribute_filter(std::string_view term)
+    -> std::optional<AttributeFilter>
+{
+    auto const op_begin = term.find_first_of("<>=");
+    if (op_begin == std::string_view::npos || op_begin == 0)
+    {
+        return std::nullopt;
+    }
+
+    auto name = std::string{term.substr(0, op_begin)};
+    std::ranges::transform(name, name.begin(), to_lower_ascii);
+
+    auto attribute = Attribute{};
+    if (name == "notes")
+    {
+        attribute = Attribute::NoteCount;
+    }
+    else if (name == "size")
+    {
+        attribute = Attribute::TuningSize;
+    }
+    else if (name == "ts")
+    {
+        attribute = Attribute::TimeSignature;
+    }
+    else
+    {
+        return std::nullopt;
+    }
+
+    auto const op_end = term.find_first_not_of("<>=", op_begin);
+    auto const op = term.substr(op_begin, op_end - op_begin);
+    auto const value = op_end == std::string_view::npos ? std::string_view{}
+                                                        : term.substr(op_end);
+
+    auto comparison = Comparison{};
+    if (op == "=")
+    {
+        comparison = Comparison::Equal;
+    }
+    else if (op == "<")
+    {
+        comparison = Comparison::Less;
+    }
+    else if (op == ">")
+    {
+        comparison = Comparison::Greater;
+    }
+    else if (op == "<=")
+    {
+        comparison = Comparison::LessOrEqual;
+    }
+    else if (op == ">=")
+    {
+        comparison = Comparison::GreaterOrEqual;
+    }
+    else
+    {
+        throw std::invalid_argument{"Invalid Search Comparison: " + std::string{term}};
+    }
+
+    if (attribute == Attribute::TimeSignature)
+    {
+        auto const slash = value.find('/');
+        if (comparison != Comparison::Equal || slash == std::string_view::npos)
+        {
+            throw std::invalid_argument{"Time Signature Search Must Be ts=N/D: " +
+                                        std::string{term}};
+        }
+        return AttributeFilter{
+            .attribute = attribute,
+            .comparison = comparison,
+            .value = parse_unsigned(value.substr(0, slash), term),
+            .denominator = parse_unsigned(value.substr(slash + 1), term),
+        };
+    }
+
+    return AttributeFilter{
+        .attribute = attribute,
+        .comparison = comparison,
+        .value = parse_unsigned(value, term),
+        .denominator = 0,
+    };
+}
+
+[[nodiscard]] auto compare(std::uint32_t lhs, Comparison comparison,
+                           std::uint32_t rhs) -> bool
+{
+    switch (comparison)
+    {
+    case Comparison::Equal:
+        return lhs == rhs;
+    case Comparison::Less:
+        return lhs < rhs;
+    case Comparison::Greater:
+        return lhs > rhs;
+    case Comparison::LessOrEqual:
+        return lhs <= rhs;
+    case Comparison::GreaterOrEqual:
+        return lhs >= rhs;
+    }
+    return false;
+}
+
+/**
+ * Returns true if an entry with the given non-empty \p measures matches \p filter.
+ */
+[[nodiscard]] auto matches(xen::LibraryEntry const &entry, auto const &measures,
+                           AttributeFilter const &filter) -> bool
+{
+    switch (filter.attribute)
+    {
+    case Attribute::NoteCount:
+        return std::ranges::any_of(measures, [&](auto const &measure) {
+            return compare(measure.note_count, filter.comparison, filter.value);
+        });
+    case Attribute::TuningSize:
+        return entry.type == xen::LibraryEntry::Type::Tuning && entry.readable &&
+               compare(static_cast<std::uint32_t>(entry.tuning.intervals.size()),
+                       filter.comparison, filter.value);
+    case Attribute::TimeSignature:
+        return std::ranges::any_of(measures, [&](auto const &measure) {
+            return measure.numerator == filter.value &&
+                   measure.denominator == filter.denominator;
+        });
+    }
+    return false;
+}
+
+} // namespace
+
+namespace xen
+{
+
+auto split_search_words(std::string_view text) -> std::vector<std::string>
+{
+    auto words = std::vector<std::string>{};
+    auto word = std::string{};
+    for (auto const c : text)
+    {
+        if (is_word_char(c))
+        {
+            word.push_back(to_lower_ascii(c));
+        }
+        else if (!word.empty())
+        {
+            words.push_back(std::move(word));
+            word.clear();
+        }
+    }
+    if (!word.empty())
+    {
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+LibrarySearch::LibrarySearch(LibraryIndex::Entries const &entries)
+{
+    documents_.reserve(entries.size());
+    measure_offsets_.reserve(entries.size() + 1);
+    std::ranges::transform(entries, std::back_inserter(documents_),
+                           [](auto const &item) { return item.second; });
+    std::ranges::sort(documents_, [](auto const &a, auto const &b) {
+        return a->path < b->path;
+    });
+
+    // Documents are visited in order, so each posting list is built already sorted.
+    auto postings = std::unordered_map<std::string, std::vector<std::uint32_t>>{};
+    auto const add = [&postings](std::string_view text, std::uint32_t id) {
+        for (auto &word : split_search_words(text))
+        {
+            auto &ids = postings[std::move(word)];
+            if (ids.empty() || ids.back() != id)
+            {
+                ids.push_back(id);
+            }
+        }
+    };
+
+    for (auto id = std::uint32_t{0}; id < documents_.size(); ++id)
+    {
+        auto const &entry = *documents_[id];
+        add(juce::File{juce::String{entry.path}}
+                .getFileNameWithoutExtension()
+                .toStdString(),
+            id);
+        for (auto const &measure : entry.measures)
+        {
+            add(measure.name, id);
+        }
+        add(entry.tuning.description, id);
+
+        measure_offsets_.push_back(static_cast<std::uint32_t>(measures_.size()));
+        for (auto const &measure : entry.measures)
+        {
+            if (measure.note_count > 0)
+            {
+                measures_.push_back({
+                    .numerator = measure.numerator,
+                    .denominator = measure.denominator,
+                    .note_count = measure.note_count,
+                });
+            }
+        }
+    }
+    measure_offsets_.push_back(static_cast<std::uint32_t>(measures_.size()));
+
+    auto sorted = std::vector<std::pair<std::string, std::vector<std::uint32_t>>>{
+        std::make_move_iterator(postings.begin()),
+        std::make_move_iterator(postings.end())};
+    std::ranges::sort(sorted, {}, &decltype(sorted)::value_type::first);
+
+    words_.reserve(sorted.size());
+    postings_.reserve(sorted.size());
+    for (auto &[word, ids] : sorted)
+    {
+        words_.push_back(std::move(word));
+        postings_.push_back(std::move(ids));
+    }
+}
+
+auto LibrarySearch::search(std::string_view query) const
+    -> std::vector<std::shared_ptr<LibraryEntry const>>
+{
+    auto prefixes = std::vector<std::string>{};
+    auto filters = std::vector<AttributeFilter>{};
+    for (auto begin = query.find_first_not_of(" \t\n"); begin != std::string_view::npos;
+         begin = query.find_first_not_of(" \t\n", begin))
+    {
+        auto const end = std::min(query.find_first_of(" \t\n", begin), query.size());
+        auto const term = query.substr(begin, end - begin);
+        begin = end;
+
+        if (auto filter = parse_attribute_filter(term); filter.has_value())
+        {
+            filters.push_back(*filter);
+        }
+        else
+        {
+            std::ranges::move(split_search_words(term), std::back_inserter(prefixes));
+        }
+    }
+
+    // Longest first, it usually has the fewest matches and narrows the rest.
+    std::ranges::sort(prefixes, std::ranges::greater{}, &std::string::size);
+
+    auto candidates = std::optional<std::vector<std::uint32_t>>{};
+    auto hits = std::vector<std::uint8_t>{};
+    for (auto const &prefix : prefixes)
+    {
+        hits.assign(documents_.size(), 0);
+        auto const first = std::ranges::lower_bound(words_, prefix);
+        for (auto at = first; at != words_.end() && at->starts_with(prefix); ++at)
+        {
+            auto const index = static_cast<std::size_t>(at - words_.begin());
+            for (auto const id : postings_[index])
+            {
+                hits[id] = 1;
+            }
+        }
+
+        if (!candidates.has_value())
+        {
+            candidates.emplace();
+            for (auto id = std::uint32_t{0}; id < hits.size(); ++id)
+            {
+                if (hits[id] != 0)
+                {
+                    candidates->push_back(id);
+                }
+            }
+        }
+        else
+        {
+            std::erase_if(*candidates, [&hits](auto id) { return hits[id] == 0; });
+        }
+
+        if (candidates->empty())
+        {
+            return {};
+        }
+    }
+
+    if (!candidates.has_value())
+    {
+        candidates.emplace(documents_.size());
+        std::iota(candidates->begin(), candidates->end(), std::uint32_t{0});
+    }
+
+    auto results = std::vector<std::shared_ptr<LibraryEntry const>>{};
+    for (auto const id : *candidates)
+    {
+        auto const &entry = documents_[id];
+        auto const measures = std::span{measures_.data() + measure_offsets_[id],
+                                        measures_.data() + measure_offsets_[id + 1]};
+        if (std::ranges::all_of(filters, [&](auto const &filter) {
+                return matches(*entry, measures, filter);
+            }))
+        {
+            results.push_back(entry);
+        }
+    }
+    return results;
+}
+
+} // namespace xen
@@ -3,11 +3,13 @@
 #include <compare>
 #include <cstdint>
 #include <ostream>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <utility>
 
 #include <xen/gui/themes.hpp>
+#include <xen/string_manip.hpp>
 
 namespace xen
 {
@@ -39,6 +41,28 @@ auto operator<<(std::ostream &os, MessageLevel level) -> std::ostream &
     return os;
 }
 
+auto parse_message_level(std::string const &str) -> MessageLevel
+{
+    auto const lower_str = to_lower(str);
+    if (lower_str == "debug")
+    {
+        return MessageLevel::Debug;
+    }
+    if (lower_str == "info")
+    {
+        return MessageLevel::Info;
+    }
+    if (lower_str == "warning")
+    {
+        return MessageLevel::Warning;
+    }
+    if (lower_str == "error")
+    {
+        return MessageLevel::Error;
+    }
+    throw std::invalid_argument{"Invalid message level: " + str};
+}
+
 auto mdebug(std::string msg) -> std::pair<MessageLevel, std::string>
 {
     return {MessageLevel::Debug, std::move(msg)};
@@ -1,12 +1,276 @@
 #include <xen/modulator.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <numbers>
 #include <random>
+#include <span>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+namespace
+{
+
+using Op = xen::Modulator::Op;
+using Instruction = xen::Modulator::Instruction;
+
+/**
+ * Equal to std::fmod(x, 1.f), but can be vectorized.
+ */
+[[nodiscard]] inline auto wrap(float x) -> float
+{
+    return x - std::trunc(x);
+}
+
+/**
+ * Map \p t to [0, 1) within the current cycle of a periodic generator.
+ */
+[[nodiscard]] inline auto cycle_position(float t, float frequency, float phase)
+    -> float
+{
+    return wrap(wrap(t + phase) * frequency);
+}
+
+[[nodiscard]] auto noise_sample() -> float
+{
+    static std::mt19937 gen{std::random_device{}()};
+    static std::uniform_real_distribution<float> dist{-1.f, 1.f};
+    return dist(gen);
+}
+
+/**
+ * Call \p visit with the per-value function of a generator or modifier Instruction.
+ *
+ * @details The scalar and batch evaluations both go through here, so they share each
+ * kernel and give the same results.
+ */
+template <typename Visitor>
+void visit_kernel(Instruction const &instruction, Visitor &&visit)
+{
+    auto const [a0, a1, a2, a3] = instruction.args;
+
+    switch (instruction.op)
+    {
+    case Op::Constant: visit([value = a0](float) { return value; }); break;
+
+    case Op::Sine:
+        visit([frequency = a0, amplitude = a1, phase = a2](float t) {
+            auto const two_pi = 2.f * std::numbers::pi_v<float>;
+            return amplitude * std::sin(two_pi * frequency * (t + phase));
+        });
+        break;
+
+    case Op::Triangle:
+        visit([frequency = a0, amplitude = a1, phase = a2](float t) {
+            auto const x = cycle_position(t, frequency, phase);
+            return amplitude * (4.f * std::abs(x - 0.5f) - 1.f);
+        });
+        break;
+
+    case Op::SawtoothUp:
+        visit([frequency = a0, amplitude = a1, phase = a2](float t) {
+            auto const x = cycle_position(t, frequency, phase);
+            return amplitude * (2.f * x - 1.f);
+        });
+        break;
+
+    case Op::SawtoothDown:
+        visit([frequency = a0, amplitude = a1, phase = a2](float t) {
+            auto const x = cycle_position(t, frequency, phase);
+            return amplitude * (1.f - 2.f * x);
+        });
+        break;
+
+    case Op::Square:
+        visit([frequency = a0, amplitude = a1, phase = a2, pulse_width = a3](float t) {
+            auto const x = cycle_position(t, frequency, phase);
+            return amplitude * ((x < pulse_width) ? 1.f : -1.f);
+        });
+        break;
+
+    case Op::Noise:
+        visit([amplitude = a0](float) { return amplitude * noise_sample(); });
+        break;
+
+    case Op::Scale: visit([factor = a0](float x) { return x * factor; }); break;
+
+    case Op::Bias: visit([amount = a0](float x) { return x + amount; }); break;
+
+    case Op::AbsoluteValue: visit([](float x) { return std::abs(x); }); break;
+
+    case Op::Clamp:
+        visit([min = a0, max = a1](float x) { return std::clamp(x, min, max); });
+        break;
+
+    case Op::Power:
+        visit([exponent = a0](float x) { return std::pow(x, exponent); });
+        break;
+
+    default: throw std::logic_error{"Modulator instruction has no kernel."};
+    }
+}
+
+/**
+ * Return the number of values per input needed for the blends in \p program.
+ *
+ * @throws std::invalid_argument If the blend instructions are unbalanced.
+ */
+[[nodiscard]] auto blend_stack_size(std::vector<Instruction> const &program)
+    -> std::size_t
+{
+    auto depth = std::size_t{0};
+    auto max_depth = std::size_t{0};
+    for (auto const &instruction : program)
+    {
+        switch (instruction.op)
+        {
+        case Op::BeginBlend:
+            ++depth;
+            max_depth = std::max(max_depth, depth);
+            break;
+        case Op::LoadInput:
+        case Op::Accumulate:
+            if (depth == 0)
+            {
+                throw std::invalid_argument{"Blend instruction outside of a blend."};
+            }
+            break;
+        case Op::EndBlend:
+            if (depth == 0)
+            {
+                throw std::invalid_argument{"Blend instruction outside of a blend."};
+            }
+            --depth;
+            break;
+        default: break;
+        }
+    }
+    if (depth != 0)
+    {
+        throw std::invalid_argument{"Blend is not ended."};
+    }
+    return max_depth * 2; // An input and a sum for each.
+}
+
+[[nodiscard]] auto single(Op op, std::array<float, 4> args = {}) -> xen::Modulator
+{
+    return xen::Modulator{{Instruction{.op = op, .args = args}}};
+}
+
+} // namespace
+
+namespace xen
+{
+
+Modulator::Modulator(std::vector<Instruction> program)
+    : program_{std::move(program)}, stack_size_{blend_stack_size(program_)}
+{
+}
+
+auto Modulator::operator()(float input) const -> float
+{
+    // Blends are rarely nested deep enough to need the heap.
+    auto small_stack = std::array<float, 16>{};
+    auto large_stack = std::vector<float>{};
+    auto stack = std::span<float>{small_stack};
+    if (stack_size_ > small_stack.size())
+    {
+        large_stack.resize(stack_size_);
+        stack = large_stack;
+    }
+
+    auto value = input;
+    auto top = std::size_t{0}; // One past the last sum.
+    for (auto const &instruction : program_)
+    {
+        switch (instruction.op)
+        {
+        case Op::BeginBlend:
+            stack[top] = value;
+            stack[top + 1] = 0.f;
+            top += 2;
+            break;
+        case Op::LoadInput: value = stack[top - 2]; break;
+        case Op::Accumulate: stack[top - 1] += value; break;
+        case Op::EndBlend:
+            value = stack[top - 1];
+            top -= 2;
+            break;
+        default:
+            visit_kernel(instruction,
+                         [&](auto const &kernel) { value = kernel(value); });
+            break;
+        }
+    }
+    return value;
+}
+
+void Modulator::operator()(std::span<float const> inputs,
+                           std::span<float> outputs) const
+{
+    if (inputs.size() != outputs.size())
+    {
+        throw std::invalid_argument{"Modulator inputs and outputs differ in size."};
+    }
+
+    auto const n = inputs.size();
+    if (inputs.data() != outputs.data())
+    {
+        std::ranges::copy(inputs, outputs.begin());
+    }
+
+    // Each blend level holds an input and a sum for every value, back to back.
+    auto stack = std::vector<float>(stack_size_ * n);
+    auto top = std::size_t{0};
+    auto const at = [&](std::size_t level) {
+        return std::span<float>{stack}.subspan(level * n, n);
+    };
+
+    for (auto const &instruction : program_)
+    {
+        switch (instruction.op)
+        {
+        case Op::BeginBlend:
+            std::ranges::copy(outputs, at(top).begin());
+            std::ranges::fill(at(top + 1), 0.f);
+            top += 2;
+            break;
+        case Op::LoadInput: std::ranges::copy(at(top - 2), outputs.begin()); break;
+        case Op::Accumulate:
+        {
+            auto const sum = at(top - 1);
+            for (auto i = std::size_t{0}; i < n; ++i)
+            {
+                sum[i] += outputs[i];
+            }
+            break;
+        }
+        case Op::EndBlend:
+            std::ranges::copy(at(top - 1), outputs.begin());
+            top -= 2;
+            break;
+        default:
+            visit_kernel(instruction, [&](auto const &kernel) {
+                for (auto &value : outputs)
+                {
+                    value = kernel(value);
+                }
+            });
+            break;
+        }
+    }
+}
+
+void Modulator::set_args(std::size_t index, std::array<float, 4> const &args)
+{
+    program_.at(index).args = args;
+}
+
+} // namespace xen
+
 namespace xen::modulator
 {
 
@@ -14,7 +278,7 @@ namespace xen::modulator
 
 auto constant(float value) -> Modulator
 {
-    return [value](float) -> float { return value; };
+    return single(Op::Constant, {value});
 }
 
 auto sine(float frequency, float amplitude, float phase) -> Modulator
@@ -23,10 +287,7 @@ auto sine(float frequency, float amplitude, float phase) -> Modulator
     {
         throw std::invalid_argument{"Frequency must be non-negative."};
     }
-    return [frequency, amplitude, phase](float t) -> float {
-        auto const two_pi = 2.f * std::numbers::pi_v<float>;
-        return amplitude * std::sin(two_pi * frequency * (t + phase));
-    };
+    return single(Op::Sine, {frequency, amplitude, phase});
 }
 
 auto triangle(float frequency, float amplitude, float phase) -> Modulator
@@ -35,13 +296,7 @@ auto triangle(float frequency, float amplitude, float phase) -> Modulator
     {
         throw std::invalid_argument{"Frequency must be non-negative."};
     }
-
-    return [frequency, amplitude, phase](float t) -> float {
-        auto const wrapped_t = std::fmod(t + phase, 1.0f);
-        auto const x = std::fmod(wrapped_t * frequency, 1.0f); // map to [0, 1)
-        auto const tri = 4.f * std::abs(x - 0.5f) - 1.f; // triangle wave in [-1, 1]
-        return amplitude * tri;
-    };
+    return single(Op::Triangle, {frequency, amplitude, phase});
 }
 
 auto sawtooth_up(float frequency, float amplitude, float phase) -> Modulator
@@ -50,13 +305,7 @@ auto sawtooth_up(float frequency, float amplitude, float phase) -> Modulator
     {
         throw std::invalid_argument{"Frequency must be non-negative."};
     }
-
-    return [frequency, amplitude, phase](float t) -> float {
-        auto const wrapped_t = std::fmod(t + phase, 1.0f);
-        auto const x = std::fmod(wrapped_t * frequency, 1.0f); // map to [0, 1)
-        auto const saw = 2.f * x - 1.f; // sawtooth wave in [-1, 1]
-        return amplitude * saw;
-    };
+    return single(Op::SawtoothUp, {frequency, amplitude, phase});
 }
 
 auto sawtooth_down(float frequency, float amplitude, float phase) -> Modulator
@@ -65,13 +314,7 @@ auto sawtooth_down(float frequency, float amplitude, float phase) -> Modulator
     {
         throw std::invalid_argument{"Frequency must be non-negative."};
     }
-
-    return [frequency, amplitude, phase](float t) -> float {
-        auto const wrapped_t = std::fmod(t + phase, 1.0f);
-        auto const x = std::fmod(wrapped_t * frequency, 1.0f); // map to [0, 1)
-        auto const saw = 1.f - 2.f * x; // inverted sawtooth wave in [-1, 1]
-        return amplitude * saw;
-    };
+    return single(Op::SawtoothDown, {frequency, amplitude, phase});
 }
 
 auto square(float frequency, float amplitude, float phase, float pulse_width)
@@ -85,44 +328,34 @@ auto square(float frequency, float amplitude, float phase, float pulse_width)
     {
         throw std::invalid_argument{"Pulse width must be in the range [0, 1]"};
     }
-
-    return [frequency, amplitude, phase, pulse_width](float t) -> float {
-        auto const wrapped_t = std::fmod(t + phase, 1.0f);
-        auto const x = std::fmod(wrapped_t * frequency, 1.0f); // map to [0, 1)
-        auto const square = (x < pulse_width) ? 1.f : -1.f;    // square wave in [-1, 1]
-        return amplitude * square;
-    };
+    return single(Op::Square, {frequency, amplitude, phase, pulse_width});
 }
 
 auto noise(float amplitude) -> Modulator
 {
-    return [amplitude](float) -> float {
-        static std::mt19937 gen{std::random_device{}()};
-        static std::uniform_real_distribution<float> dist{-1.f, 1.f};
-        return amplitude * dist(gen);
-    };
+    return single(Op::Noise, {amplitude});
 }
 
 // MODIFIERS ---------------------------------------------------------------------------
 
 auto scale(float factor) -> Modulator
 {
-    return [factor](float input) -> float { return input * factor; };
+    return single(Op::Scale, {factor});
 }
 
 auto bias(float amount) -> Modulator
 {
-    return [amount](float input) -> float { return input + amount; };
+    return single(Op::Bias, {amount});
 }
 
 auto absolute_value() -> Modulator
 {
-    return [](float input) -> float { return std::abs(input); };
+    return single(Op::AbsoluteValue);
 }
 
 auto clamp(float min, float max) -> Modulator
 {
-    return [min, max](float input) -> float { return std::clamp(input, min, max); };
+    return single(Op::Clamp, {min, max});
 }
 
 auto invert() -> Modulator
@@ -143,37 +376,42 @@ auto power(float exponent) -> Modulator
     {
         throw std::invalid_argument{"Exponent must be non-negative."};
     }
-    return [exponent](float x) -> float { return std::pow(x, exponent); };
+    return single(Op::Power, {exponent});
 }
 
 // META / ROUTING ----------------------------------------------------------------------
 
 auto chain(std::vector<Modulator> mods) -> Modulator
 {
-    return [modulators = std::move(mods)](float input) -> float {
-        if (modulators.empty())
-        {
-            return 0.f;
-        }
-        auto output = input;
-        for (auto const &mod : modulators)
-        {
-            output = mod(output);
-        }
-        return output;
-    };
+    if (mods.empty())
+    {
+        return modulator::constant(0.f);
+    }
+
+    auto program = std::vector<Modulator::Instruction>{};
+    for (auto const &mod : mods)
+    {
+        program.insert(program.end(), mod.program().begin(), mod.program().end());
+    }
+    return Modulator{std::move(program)};
 }
 
 auto blend(std::vector<Modulator> mods) -> Modulator
 {
-    return [modulators = std::move(mods)](float const input) -> float {
-        auto output = 0.f;
-        for (auto const &mod : modulators)
-        {
-            output += mod(input);
-        }
-        return output;
-    };
+    if (mods.empty())
+    {
+        return modulator::constant(0.f);
+    }
+
+    auto program = std::vector<Modulator::Instruction>{{.op = Op::BeginBlend}};
+    for (auto const &mod : mods)
+    {
+        program.push_back({.op = Op::LoadInput});
+        program.insert(program.end(), mod.program().begin(), mod.program().end());
+        program.push_back({.op = Op::Accumulate});
+    }
+    program.push_back({.op = Op::EndBlend});
+    return Modulator{std::move(program)};
 }
 
-} // namespace xen::modulator
\ No newline at end of file
+} // namespace xen::modulator
@@ -1,10 +1,15 @@
 #include <xen/parse_args.hpp>
 
+#include <cctype>
+#include <charconv>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <system_error>
 #include <vector>
 
 #include <nlohmann/json.hpp>
@@ -128,29 +133,51 @@ namespace xen
 
 auto parse_int(std::string const &x) -> std::optional<int>
 {
-    try
+    auto const *const last = x.data() + x.size();
+    auto const *first = x.data();
+
+    // Sign and base prefix are handled here, std::from_chars accepts neither.
+    while (first != last && std::isspace(static_cast<unsigned char>(*first)) != 0)
+    {
+        ++first;
+    }
+    auto const negative = first != last && *first == '-';
+    if (first != last && (*first == '-' || *first == '+'))
     {
-        auto pos = std::size_t{0};
+        ++first;
+    }
 
-        // Pass 0 as the base to auto-detect from the prefix
-        auto const result = std::stoi(x, &pos, 0);
+    // Auto-detect the base from the prefix, the same as std::stoi with base 0.
+    auto base = 10;
+    if (last - first > 1 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X'))
+    {
+        base = 16;
+        first += 2;
+    }
+    else if (last - first > 1 && first[0] == '0')
+    {
+        base = 8;
+        first += 1;
+    }
 
-        // This verifies the entire string was parsed.
-        if (pos != x.size())
-        {
-            return std::nullopt;
-        }
+    auto magnitude = std::uint64_t{0};
+    auto const [ptr, ec] = std::from_chars(first, last, magnitude, base);
 
-        return result;
-    }
-    catch (std::invalid_argument const &)
+    // This verifies the entire string was parsed.
+    if (ec != std::errc{} || ptr != last)
     {
         return std::nullopt;
     }
-    catch (std::out_of_range const &)
+
+    auto const limit = static_cast<std::uint64_t>(std::numeric_limits<int>::max()) +
+                       (negative ? 1 : 0);
+    if (magnitude > limit)
     {
         return std::nullopt;
     }
+
+    auto const value = static_cast<std::int64_t>(magnitude);
+    return static_cast<int>(negative ? -value : value);
 }
 
 auto parse_bool(std::string const &x) -> std::optional<bool>
@@ -190,4 +217,9 @@ auto parse_modulator(std::string const &mod_json) -> Modulator
     return parse_modulator_json(nlohmann::json::parse(mod_json));
 }
 
+auto modulator_from_json(nlohmann::json const &mod_json) -> Modulator
+{
+    return parse_modulator_json(mod_json);
+}
+
 } // namespace xen
@@ -9,6 +9,8 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <embed_tables.hpp>
+
 #include <xen/constants.hpp>
 #include <xen/string_manip.hpp>
 #include <xen/user_directory.hpp>
@@ -65,23 +67,40 @@ auto Scale::operator!=(Scale const &other) const -> bool
     return !(*this == other);
 }
 
-auto load_scales_from_files() -> std::vector<Scale>
+auto get_system_scales() -> std::vector<Scale>
+{
+    auto scales = std::vector<Scale>{};
+    scales.reserve(embed_tables::scales.size());
+    for (auto const &entry : embed_tables::scales)
+    {
+        scales.push_back({
+            .name = std::string{entry.name},
+            .tuning_length = entry.tuning_length,
+            .intervals = {std::cbegin(entry.intervals), std::cend(entry.intervals)},
+            .mode = entry.mode,
+        });
+    }
+    return scales;
+}
+
+auto load_user_scales() -> std::vector<Scale>
 {
-    auto const system_node =
-        YAML::LoadFile(get_system_scales_file().getFullPathName().toStdString());
     auto const user_node =
         YAML::LoadFile(get_user_scales_file().getFullPathName().toStdString());
-
-    auto system_scales = system_node["scales"].as<std::vector<Scale>>();
-    auto user_scales = std::vector<Scale>{};
     if (user_node["scales"])
     {
-        user_scales = user_node["scales"].as<std::vector<Scale>>();
+        return user_node["scales"].as<std::vector<Scale>>();
     }
-    system_scales.insert(std::end(system_scales),
-                         std::make_move_iterator(std::begin(user_scales)),
-                         std::make_move_iterator(std::end(user_scales)));
-    return system_scales;
+    return {};
+}
+
+auto load_scales_from_files() -> std::vector<Scale>
+{
+    auto scales = get_system_scales();
+    auto user_scales = load_user_scales();
+    scales.insert(std::end(scales), std::make_move_iterator(std::begin(user_scales)),
+                  std::make_move_iterator(std::end(user_scales)));
+    return scales;
 }
 
 auto generate_valid_pitches(xen::Scale const &scale) -> std::vector<int>
@@ -1,9 +1,15 @@
 #include <xen/serialize.hpp>
 
 #include <array>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -11,275 +17,1212 @@
 #include <nlohmann/json.hpp>
 
 #include <sequence/sequence.hpp>
+#include <sequence/utility.hpp>
 
 #include <xen/scale.hpp>
 #include <xen/state.hpp>
 
-namespace sequence
+// Output is written directly from the state objects, and parsed with a SAX handler
+// that builds them without an intermediate nlohmann::json DOM. The output is byte for
+// byte what nlohmann::json::dump() produced for the same objects: compact, with object
+// keys in sorted order, so existing files and host session data are unchanged.
+
+namespace
 {
 
-// Serialization -------------------------------------------------------------
+using namespace xen;
+
+// Writing -----------------------------------------------------------------------------
+
+// A rough upper bound on the serialized size of a single Cell, used to pre-size output.
+constexpr auto bytes_per_cell = std::size_t{96};
 
-static void to_json(nlohmann::json &j, Note const &note)
+[[nodiscard]] auto count_cells(sequence::Cell const &cell) -> std::size_t
 {
-    j = nlohmann::json{{"type", "Note"},
-                       {"pitch", note.pitch},
-                       {"velocity", note.velocity},
-                       {"delay", note.delay},
-                       {"gate", note.gate}};
+    auto count = std::size_t{1};
+    if (auto const *seq = std::get_if<sequence::Sequence>(&cell.element))
+    {
+        for (auto const &child : seq->cells)
+        {
+            count += count_cells(child);
+        }
+    }
+    return count;
 }
 
-static void to_json(nlohmann::json &j, Rest const &)
+[[nodiscard]] auto count_cells(SequenceBank const &bank) -> std::size_t
 {
-    j = nlohmann::json{{"type", "Rest"}};
+    auto count = std::size_t{0};
+    for (auto const &measure : bank)
+    {
+        count += count_cells(measure.cell);
+    }
+    return count;
+}
+
+/**
+ * Return the length of the UTF-8 encoded code point starting at \p at, or zero if it
+ * is not valid UTF-8. Overlong encodings and surrogates are invalid.
+ */
+[[nodiscard]] auto utf8_length(std::string_view s, std::size_t at) -> std::size_t
+{
+    auto const byte = [&](std::size_t i) {
+        return static_cast<unsigned char>(s[at + i]);
+    };
+
+    auto const lead = byte(0);
+    auto length = std::size_t{0};
+    auto low = 0x80u; // Range of the first continuation byte.
+    auto high = 0xBFu;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        low = (lead == 0xE0) ? 0xA0u : low;
+        high = (lead == 0xED) ? 0x9Fu : high;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        low = (lead == 0xF0) ? 0x90u : low;
+        high = (lead == 0xF4) ? 0x8Fu : high;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (s.size() - at < length || byte(1) < low || byte(1) > high)
+    {
+        return 0;
+    }
+    for (auto i = std::size_t{2}; i < length; ++i)
+    {
+        if (byte(i) < 0x80 || byte(i) > 0xBF)
+        {
+            return 0;
+        }
+    }
+    return length;
 }
 
-// Forward declare for Sequence implementation.
-static void to_json(nlohmann::json &j, Cell const &cell);
+/**
+ * Appends compact JSON to a string, formatted as nlohmann::json::dump() would.
+ */
+class JsonWriter
+{
+  public:
+    std::string out;
+
+  public:
+    void raw(std::string_view text)
+    {
+        out += text;
+    }
+
+    /**
+     * Write an object key, preceded by a comma unless it is the first key.
+     */
+    void key(std::string_view name, bool first = false)
+    {
+        if (!first)
+        {
+            out += ',';
+        }
+        this->string(name);
+        out += ':';
+    }
+
+    template <std::integral T>
+    void number(T x)
+    {
+        auto buffer = std::array<char, 24>{};
+        auto const [end, _] = std::to_chars(buffer.data(), buffer.data() + 24, x);
+        out.append(buffer.data(), end);
+    }
+
+    /**
+     * nlohmann::json stores every float as a double, and formats it with its own
+     * shortest round-trip algorithm, which dump() applies here to keep the output
+     * identical. Infinities and NaN are written as null.
+     */
+    void number(std::floating_point auto x)
+    {
+        out += nlohmann::json(static_cast<double>(x)).dump();
+    }
 
-static void to_json(nlohmann::json &j, Sequence const &sequence)
+    /**
+     * @throws std::invalid_argument If \p s is not valid UTF-8.
+     */
+    void string(std::string_view s)
+    {
+        constexpr auto hex = std::string_view{"0123456789abcdef"};
+
+        out += '"';
+        for (auto i = std::size_t{0}; i < s.size();)
+        {
+            auto const c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x80)
+            {
+                auto const length = utf8_length(s, i);
+                if (length == 0)
+                {
+                    throw std::invalid_argument{"Invalid UTF-8 byte at index " +
+                                                std::to_string(i) + " of string"};
+                }
+                out.append(s, i, length);
+                i += length;
+                continue;
+            }
+
+            switch (c)
+            {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20)
+                {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                }
+                else
+                {
+                    out += static_cast<char>(c);
+                }
+            }
+            ++i;
+        }
+        out += '"';
+    }
+
+    template <typename T>
+    void array(std::vector<T> const &values)
+    {
+        out += '[';
+        for (auto i = std::size_t{0}; i < values.size(); ++i)
+        {
+            if (i != 0)
+            {
+                out += ',';
+            }
+            this->number(values[i]);
+        }
+        out += ']';
+    }
+};
+
+// Keys are written in sorted order, as nlohmann::json stores objects in a std::map.
+// write_members writes the keys and values of an object, write_object adds the braces.
+
+void write_members(JsonWriter &w, sequence::Cell const &cell);
+void write_members(JsonWriter &w, sequence::TimeSignature const &ts);
+void write_members(JsonWriter &w, sequence::Measure const &measure);
+void write_members(JsonWriter &w, sequence::Tuning const &tuning);
+void write_members(JsonWriter &w, Scale const &scale);
+void write_members(JsonWriter &w, SequencerState const &state,
+                   std::string_view instance_id = {});
+
+template <typename T>
+void write_object(JsonWriter &w, T const &x)
 {
-    j = nlohmann::json{{"type", "Sequence"}, {"cells", sequence.cells}};
+    w.raw("{");
+    write_members(w, x);
+    w.raw("}");
 }
 
-static void to_json(nlohmann::json &j, Cell const &cell)
+void write_members(JsonWriter &w, sequence::Cell const &cell)
 {
-    std::visit([&j](auto const &element) { to_json(j, element); }, cell.element);
-    j["weight"] = cell.weight;
+    std::visit(sequence::utility::overload{
+                   [&](sequence::Note const &note) {
+                       w.key("delay", true);
+                       w.number(note.delay);
+                       w.key("gate");
+                       w.number(note.gate);
+                       w.key("pitch");
+                       w.number(note.pitch);
+                       w.key("type");
+                       w.raw("\"Note\"");
+                       w.key("velocity");
+                       w.number(note.velocity);
+                   },
+                   [&](sequence::Rest const &) {
+                       w.key("type", true);
+                       w.raw("\"Rest\"");
+                   },
+                   [&](sequence::Sequence const &seq) {
+                       w.key("cells", true);
+                       w.raw("[");
+                       for (auto i = std::size_t{0}; i < seq.cells.size(); ++i)
+                       {
+                           if (i != 0)
+                           {
+                               w.raw(",");
+                           }
+                           write_object(w, seq.cells[i]);
+                       }
+                       w.raw("]");
+                       w.key("type");
+                       w.raw("\"Sequence\"");
+                   },
+               },
+               cell.element);
+    w.key("weight");
+    w.number(cell.weight);
 }
 
-static void to_json(nlohmann::json &j, TimeSignature const &ts)
+void write_members(JsonWriter &w, sequence::TimeSignature const &ts)
 {
-    j = nlohmann::json{
-        {"numerator", ts.numerator},
-        {"denominator", ts.denominator},
-    };
+    w.key("denominator", true);
+    w.number(ts.denominator);
+    w.key("numerator");
+    w.number(ts.numerator);
 }
 
-static void to_json(nlohmann::json &j, Measure const &measure)
+void write_members(JsonWriter &w, sequence::Measure const &measure)
 {
-    j = nlohmann::json{
-        {"cell", measure.cell},
-        {"time_signature", measure.time_signature},
-    };
+    w.key("cell", true);
+    write_object(w, measure.cell);
+    w.key("time_signature");
+    write_object(w, measure.time_signature);
 }
 
-static void to_json(nlohmann::json &j, Tuning const &tuning)
+void write_members(JsonWriter &w, sequence::Tuning const &tuning)
 {
-    j = nlohmann::json{
-        {"intervals", tuning.intervals},
-        {"octave", tuning.octave},
-    };
+    w.key("intervals", true);
+    w.array(tuning.intervals);
+    w.key("octave");
+    w.number(tuning.octave);
 }
 
-// Deserialization -----------------------------------------------------------
+void write_members(JsonWriter &w, Scale const &scale)
+{
+    w.key("intervals", true);
+    w.array(scale.intervals);
+    w.key("mode");
+    w.number(scale.mode);
+    w.key("name");
+    w.string(scale.name);
+    w.key("tuning_length");
+    w.number(scale.tuning_length);
+}
 
-static void from_json(nlohmann::json const &j, Note &note)
+/**
+ * Write the sequence_bank and sequence_names members, shared by bank files and the
+ * plugin state.
+ */
+void write_bank_members(JsonWriter &w, SequenceBank const &bank,
+                        std::array<std::string, 16> const &sequence_names, bool first)
 {
-    note.pitch = j.at("pitch").get<int>();
-    note.velocity = j.at("velocity").get<float>();
-    note.delay = j.at("delay").get<float>();
-    note.gate = j.at("gate").get<float>();
+    w.key("sequence_bank", first);
+    w.raw("[");
+    for (auto i = std::size_t{0}; i < bank.size(); ++i)
+    {
+        if (i != 0)
+        {
+            w.raw(",");
+        }
+        write_object(w, bank[i]);
+    }
+    w.raw("]");
+
+    w.key("sequence_names");
+    w.raw("[");
+    for (auto i = std::size_t{0}; i < sequence_names.size(); ++i)
+    {
+        if (i != 0)
+        {
+            w.raw(",");
+        }
+        w.string(sequence_names[i]);
+    }
+    w.raw("]");
 }
 
-static void from_json(nlohmann::json const &, Rest &)
+void write_members(JsonWriter &w, SequencerState const &state,
+                   std::string_view instance_id)
 {
-    // Empty; Rest has no members
+    w.key("base_frequency", true);
+    w.number(state.base_frequency);
+    if (!instance_id.empty())
+    {
+        w.key("instance_id");
+        w.string(instance_id);
+    }
+    w.key("key");
+    w.number(state.key);
+    w.key("scale");
+    if (state.scale.has_value())
+    {
+        write_object(w, *state.scale);
+    }
+    else
+    {
+        w.raw("null");
+    }
+    w.key("scale_translate_direction");
+    w.number(static_cast<std::underlying_type_t<TranslateDirection>>(
+        state.scale_translate_direction));
+    write_bank_members(w, state.sequence_bank, state.sequence_names, false);
+    w.key("tuning");
+    write_object(w, state.tuning);
+    w.key("tuning_name");
+    w.string(state.tuning_name);
 }
 
-// Forward declare for Sequence implementation.
-static void from_json(nlohmann::json const &j, Cell &cell);
+// Reading -----------------------------------------------------------------------------
 
-static void from_json(nlohmann::json const &j, Sequence &sequence)
+enum class Field : std::uint8_t
 {
-    sequence.cells = j.at("cells").get<std::vector<Cell>>();
+    None,
+    Unknown,
+    Type,
+    Pitch,
+    Velocity,
+    Delay,
+    Gate,
+    Weight,
+    Cells,
+    Cell,
+    TimeSignature,
+    Numerator,
+    Denominator,
+    Intervals,
+    Octave,
+    Name,
+    TuningLength,
+    Mode,
+    SequenceBank,
+    SequenceNames,
+    Tuning,
+    TuningName,
+    Scale,
+    Key,
+    ScaleTranslateDirection,
+    BaseFrequency,
+    InstanceId,
+};
+
+struct KeyInfo
+{
+    std::string_view name;
+    Field field;
+};
+
+[[nodiscard]] constexpr auto bit(Field f) -> std::uint32_t
+{
+    return std::uint32_t{1} << static_cast<unsigned>(f);
+}
+
+/**
+ * The object being read, its fields are filled in as its keys are read.
+ */
+template <typename T>
+struct ObjectFrame
+{
+    T value{};
+    Field field = Field::None;  // The key whose value is being read.
+    std::string_view key_name;  // For error messages.
+    std::uint32_t seen = 0;     // Bitset of Fields that have been read.
+};
+
+struct CellFields
+{
+    std::string type;
+    sequence::Note note;
+    float weight = 1.f;
+    std::vector<sequence::Cell> cells;
+};
+
+using CellFrame = ObjectFrame<CellFields>;
+using MeasureFrame = ObjectFrame<sequence::Measure>;
+using TimeSignatureFrame = ObjectFrame<sequence::TimeSignature>;
+using TuningFrame = ObjectFrame<sequence::Tuning>;
+using ScaleFrame = ObjectFrame<Scale>;
+// The state saved by the host also holds the id of the instance it was saved from.
+using StateFrame = ObjectFrame<std::pair<SequencerState, std::string>>;
+using BankFrame = ObjectFrame<std::pair<SequenceBank, std::array<std::string, 16>>>;
+
+template <typename T>
+struct ArrayFrame
+{
+    std::vector<T> values;
+};
+
+using Frame =
+    std::variant<CellFrame, MeasureFrame, TimeSignatureFrame, TuningFrame, ScaleFrame,
+                 StateFrame, BankFrame, ArrayFrame<sequence::Cell>,
+                 ArrayFrame<sequence::Measure>, ArrayFrame<std::string>,
+                 ArrayFrame<sequence::Tuning::Interval_t>, ArrayFrame<std::uint8_t>>;
+
+template <typename T>
+constexpr auto keys_of = std::array<KeyInfo, 0>{};
+
+template <>
+constexpr auto keys_of<CellFields> = std::array{
+    KeyInfo{"type", Field::Type},         KeyInfo{"pitch", Field::Pitch},
+    KeyInfo{"velocity", Field::Velocity}, KeyInfo{"delay", Field::Delay},
+    KeyInfo{"gate", Field::Gate},         KeyInfo{"weight", Field::Weight},
+    KeyInfo{"cells", Field::Cells},
+};
+
+template <>
+constexpr auto keys_of<sequence::Measure> = std::array{
+    KeyInfo{"cell", Field::Cell},
+    KeyInfo{"time_signature", Field::TimeSignature},
+};
+
+template <>
+constexpr auto keys_of<sequence::TimeSignature> = std::array{
+    KeyInfo{"numerator", Field::Numerator},
+    KeyInfo{"denominator", Field::Denominator},
+};
+
+template <>
+constexpr auto keys_of<sequence::Tuning> = std::array{
+    KeyInfo{"intervals", Field::Intervals},
+    KeyInfo{"octave", Field::Octave},
+};
+
+template <>
+constexpr auto keys_of<Scale> = std::array{
+    KeyInfo{"name", Field::Name},
+    KeyInfo{"tuning_length", Field::TuningLength},
+    KeyInfo{"intervals", Field::Intervals},
+    KeyInfo{"mode", Field::Mode},
+};
+
+template <>
+constexpr auto keys_of<std::pair<SequencerState, std::string>> = std::array{
+    KeyInfo{"sequence_bank", Field::SequenceBank},
+    KeyInfo{"sequence_names", Field::SequenceNames},
+    KeyInfo{"tuning", Field::Tuning},
+    KeyInfo{"tuning_name", Field::TuningName},
+    KeyInfo{"scale", Field::Scale},
+    KeyInfo{"key", Field::Key},
+    KeyInfo{"scale_translate_direction", Field::ScaleTranslateDirection},
+    KeyInfo{"base_frequency", Field::BaseFrequency},
+    KeyInfo{"instance_id", Field::InstanceId},
+};
+
+template <>
+constexpr auto keys_of<std::pair<SequenceBank, std::array<std::string, 16>>> =
+    std::array{
+        KeyInfo{"sequence_bank", Field::SequenceBank},
+        KeyInfo{"sequence_names", Field::SequenceNames},
+    };
+
+/**
+ * Throw if any key in \p keys, other than those in \p optional, has not been seen.
+ */
+template <typename T>
+void check_required(ObjectFrame<T> const &frame, std::uint32_t optional = 0)
+{
+    for (auto const &info : keys_of<T>)
+    {
+        if ((bit(info.field) & (frame.seen | optional)) == 0)
+        {
+            throw std::invalid_argument{"Missing key '" + std::string{info.name} + "'"};
+        }
+    }
 }
 
-static void from_json(nlohmann::json const &j, Cell &cell)
+[[nodiscard]] auto finish(CellFrame &&frame) -> sequence::Cell
 {
-    cell.weight = j.value("weight", 1.f);
+    auto &fields = frame.value;
+    auto cell = sequence::Cell{.element = sequence::Rest{}, .weight = fields.weight};
+
+    auto const note_fields =
+        bit(Field::Pitch) | bit(Field::Velocity) | bit(Field::Delay) | bit(Field::Gate);
+    auto const all = note_fields | bit(Field::Type) | bit(Field::Weight) |
+                     bit(Field::Cells);
 
-    auto const type = j.at("type").get<std::string>();
-    if (type == "Note")
+    check_required(frame, all & ~bit(Field::Type));
+    if (fields.type == "Note")
     {
-        cell.element = j.get<Note>();
+        check_required(frame, all & ~note_fields);
+        cell.element = std::move(fields.note);
     }
-    else if (type == "Rest")
+    else if (fields.type == "Rest")
     {
-        cell.element = j.get<Rest>();
+        // Rest has no members.
     }
-    else if (type == "Sequence")
+    else if (fields.type == "Sequence")
     {
-        cell.element = j.get<Sequence>();
+        check_required(frame, all & ~bit(Field::Cells));
+        cell.element = sequence::Sequence{.cells = std::move(fields.cells)};
     }
     else
     {
         throw std::invalid_argument("Unknown type for Cell");
     }
+    return cell;
 }
 
-static void from_json(nlohmann::json const &j, TimeSignature &ts)
+template <typename T>
+[[nodiscard]] auto finish(ObjectFrame<T> &&frame) -> T
 {
-    ts.numerator = j.at("numerator").get<unsigned>();
-    ts.denominator = j.at("denominator").get<unsigned>();
+    check_required(frame);
+    return std::move(frame.value);
 }
 
-static void from_json(nlohmann::json const &j, Measure &measure)
+[[nodiscard]] auto finish(StateFrame &&frame) -> std::pair<SequencerState, std::string>
 {
-    measure.cell = j.at("cell").get<Cell>();
-    measure.time_signature = j.at("time_signature").get<TimeSignature>();
+    // Only saved by the host, and not by earlier versions.
+    check_required(frame, bit(Field::InstanceId));
+    return std::move(frame.value);
 }
 
-static void from_json(nlohmann::json const &j, Tuning &tuning)
+template <typename T>
+[[nodiscard]] auto first_16(std::vector<T> &&values) -> std::array<T, 16>
 {
-    tuning.intervals = j.at("intervals").get<std::vector<Tuning::Interval_t>>();
-    tuning.octave = j.at("octave").get<Tuning::Interval_t>();
+    if (values.size() < 16)
+    {
+        throw std::invalid_argument{"Expected an array of at least 16 elements"};
+    }
+    auto result = std::array<T, 16>{};
+    std::move(std::begin(values), std::begin(values) + 16, std::begin(result));
+    return result;
 }
 
-} // namespace sequence
+/**
+ * A JSON scalar, as passed to the SAX handler.
+ */
+using Scalar = std::variant<std::nullptr_t, bool, std::int64_t, std::uint64_t, double,
+                            std::string>;
 
-namespace nlohmann
+template <typename T>
+[[nodiscard]] auto to_number(Scalar const &x, std::string_view name) -> T
 {
+    return std::visit(
+        [&](auto const &v) -> T {
+            using V = std::decay_t<decltype(v)>;
+            if constexpr (std::is_arithmetic_v<V>)
+            {
+                return static_cast<T>(v);
+            }
+            else
+            {
+                throw std::invalid_argument{"Expected a number for '" +
+                                            std::string{name} + "'"};
+            }
+        },
+        x);
+}
 
-template <typename T>
-static void to_json(json &j, std::optional<T> const &opt)
+[[nodiscard]] auto to_string(Scalar &&x, std::string_view name) -> std::string
 {
-    if (opt.has_value())
+    if (auto *const s = std::get_if<std::string>(&x))
     {
-        j = *opt;
+        return std::move(*s);
     }
-    else
+    throw std::invalid_argument{"Expected a string for '" + std::string{name} + "'"};
+}
+
+[[noreturn]] void throw_unexpected(std::string_view name)
+{
+    throw std::invalid_argument{"Unexpected value for '" + std::string{name} + "'"};
+}
+
+// Scalar values, dispatched on the frame they are read into.
+
+void set(CellFrame &f, Scalar &&x)
+{
+    auto &v = f.value;
+    switch (f.field)
     {
-        j = nullptr;
+    case Field::Type: v.type = to_string(std::move(x), f.key_name); break;
+    case Field::Pitch: v.note.pitch = to_number<int>(x, f.key_name); break;
+    case Field::Velocity: v.note.velocity = to_number<float>(x, f.key_name); break;
+    case Field::Delay: v.note.delay = to_number<float>(x, f.key_name); break;
+    case Field::Gate: v.note.gate = to_number<float>(x, f.key_name); break;
+    case Field::Weight: v.weight = to_number<float>(x, f.key_name); break;
+    default: throw_unexpected(f.key_name);
     }
 }
 
-template <typename T>
-static void from_json(json const &j, std::optional<T> &opt)
+void set(TimeSignatureFrame &f, Scalar &&x)
 {
-    if (j.is_null())
+    auto &v = f.value;
+    switch (f.field)
     {
-        opt = std::nullopt;
+    case Field::Numerator: v.numerator = to_number<unsigned>(x, f.key_name); break;
+    case Field::Denominator: v.denominator = to_number<unsigned>(x, f.key_name); break;
+    default: throw_unexpected(f.key_name);
     }
-    else
+}
+
+void set(TuningFrame &f, Scalar &&x)
+{
+    if (f.field != Field::Octave)
     {
-        opt = j.get<T>();
+        throw_unexpected(f.key_name);
     }
+    f.value.octave = to_number<sequence::Tuning::Interval_t>(x, f.key_name);
 }
 
-} // namespace nlohmann
+void set(ScaleFrame &f, Scalar &&x)
+{
+    auto &v = f.value;
+    switch (f.field)
+    {
+    case Field::Name: v.name = to_string(std::move(x), f.key_name); break;
+    case Field::TuningLength:
+        v.tuning_length = to_number<std::size_t>(x, f.key_name);
+        break;
+    case Field::Mode: v.mode = to_number<std::uint8_t>(x, f.key_name); break;
+    default: throw_unexpected(f.key_name);
+    }
+}
 
-namespace xen
+void set(StateFrame &f, Scalar &&x)
 {
+    auto &v = f.value.first;
+    switch (f.field)
+    {
+    case Field::TuningName: v.tuning_name = to_string(std::move(x), f.key_name); break;
+    case Field::Key: v.key = to_number<int>(x, f.key_name); break;
+    case Field::BaseFrequency:
+        v.base_frequency = to_number<float>(x, f.key_name);
+        break;
+    case Field::ScaleTranslateDirection:
+        v.scale_translate_direction = static_cast<TranslateDirection>(
+            to_number<std::underlying_type_t<TranslateDirection>>(x, f.key_name));
+        break;
+    case Field::InstanceId:
+        f.value.second = to_string(std::move(x), f.key_name);
+        break;
+    case Field::Scale:
+        if (!std::holds_alternative<std::nullptr_t>(x))
+        {
+            throw_unexpected(f.key_name);
+        }
+        v.scale = std::nullopt;
+        break;
+    default: throw_unexpected(f.key_name);
+    }
+}
 
-static void to_json(nlohmann::json &j, Scale const &scale)
+void set(ArrayFrame<std::string> &f, Scalar &&x)
 {
-    j = nlohmann::json{
-        {"name", scale.name},
-        {"tuning_length", scale.tuning_length},
-        {"intervals", scale.intervals},
-        {"mode", scale.mode},
-    };
+    f.values.push_back(to_string(std::move(x), "sequence_names"));
 }
 
-static void from_json(nlohmann::json const &j, Scale &scale)
+void set(ArrayFrame<sequence::Tuning::Interval_t> &f, Scalar &&x)
 {
-    scale.name = j.at("name").get<std::string>();
-    scale.tuning_length = j.at("tuning_length").get<std::size_t>();
-    scale.intervals = j.at("intervals").get<std::vector<std::uint8_t>>();
-    scale.mode = j.at("mode").get<std::uint8_t>();
+    f.values.push_back(to_number<sequence::Tuning::Interval_t>(x, "intervals"));
 }
 
-static void to_json(nlohmann::json &j, SequencerState const &state)
+void set(ArrayFrame<std::uint8_t> &f, Scalar &&x)
 {
-    j = nlohmann::json{
-        {"sequence_bank", state.sequence_bank},
-        {"sequence_names", state.sequence_names},
-        {"tuning", state.tuning},
-        {"tuning_name", state.tuning_name},
-        {"scale", state.scale},
-        {"key", state.key},
-        {"scale_translate_direction", state.scale_translate_direction},
-        {"base_frequency", state.base_frequency},
-    };
+    f.values.push_back(to_number<std::uint8_t>(x, "intervals"));
 }
 
-static void from_json(nlohmann::json const &j, SequencerState &state)
+template <typename T>
+void set(T &, Scalar &&)
 {
-    state.sequence_bank = j.at("sequence_bank").get<SequenceBank>();
-    state.sequence_names = j.at("sequence_names").get<std::array<std::string, 16>>();
-    state.tuning = j.at("tuning").get<sequence::Tuning>();
-    state.tuning_name = j.at("tuning_name").get<std::string>();
-    state.scale = j.at("scale").get<std::optional<Scale>>();
-    state.key = j.at("key").get<int>();
-    state.scale_translate_direction =
-        j.at("scale_translate_direction").get<TranslateDirection>();
-    state.base_frequency = j.at("base_frequency").get<float>();
+    throw std::invalid_argument{"Unexpected JSON value"};
 }
 
-// -------------------------------------------------------------------------------------
+// Nested objects and arrays, the frame to read them with is chosen by the key they
+// are the value of.
+
+[[nodiscard]] auto open_object(Frame const &parent) -> Frame
+{
+    return std::visit(
+        sequence::utility::overload{
+            [](ArrayFrame<sequence::Cell> const &) -> Frame { return CellFrame{}; },
+            [](ArrayFrame<sequence::Measure> const &) -> Frame {
+                return MeasureFrame{};
+            },
+            [](MeasureFrame const &f) -> Frame {
+                switch (f.field)
+                {
+                case Field::Cell: return CellFrame{};
+                case Field::TimeSignature: return TimeSignatureFrame{};
+                default: throw_unexpected(f.key_name);
+                }
+            },
+            [](StateFrame const &f) -> Frame {
+                switch (f.field)
+                {
+                case Field::Tuning: return TuningFrame{};
+                case Field::Scale: return ScaleFrame{};
+                default: throw_unexpected(f.key_name);
+                }
+            },
+            [](auto const &) -> Frame {
+                throw std::invalid_argument{"Unexpected JSON object"};
+            },
+        },
+        parent);
+}
+
+[[nodiscard]] auto open_bank_array(Field field, std::string_view key_name) -> Frame
+{
+    switch (field)
+    {
+    case Field::SequenceBank: return ArrayFrame<sequence::Measure>{};
+    case Field::SequenceNames: return ArrayFrame<std::string>{};
+    default: throw_unexpected(key_name);
+    }
+}
+
+[[nodiscard]] auto open_array(Frame const &parent) -> Frame
+{
+    return std::visit(
+        sequence::utility::overload{
+            [](CellFrame const &f) -> Frame {
+                if (f.field != Field::Cells)
+                {
+                    throw_unexpected(f.key_name);
+                }
+                return ArrayFrame<sequence::Cell>{};
+            },
+            [](TuningFrame const &f) -> Frame {
+                if (f.field != Field::Intervals)
+                {
+                    throw_unexpected(f.key_name);
+                }
+                return ArrayFrame<sequence::Tuning::Interval_t>{};
+            },
+            [](ScaleFrame const &f) -> Frame {
+                if (f.field != Field::Intervals)
+                {
+                    throw_unexpected(f.key_name);
+                }
+                return ArrayFrame<std::uint8_t>{};
+            },
+            [](StateFrame const &f) -> Frame {
+                return open_bank_array(f.field, f.key_name);
+            },
+            [](BankFrame const &f) -> Frame {
+                return open_bank_array(f.field, f.key_name);
+            },
+            [](auto const &) -> Frame {
+                throw std::invalid_argument{"Unexpected JSON array"};
+            },
+        },
+        parent);
+}
+
+// Completed child frames, moved into their parent.
+
+void adopt(CellFrame &parent, ArrayFrame<sequence::Cell> &&child)
+{
+    parent.value.cells = std::move(child.values);
+}
+
+void adopt(ArrayFrame<sequence::Cell> &parent, CellFrame &&child)
+{
+    parent.values.push_back(finish(std::move(child)));
+}
+
+void adopt(ArrayFrame<sequence::Measure> &parent, MeasureFrame &&child)
+{
+    parent.values.push_back(finish(std::move(child)));
+}
+
+void adopt(MeasureFrame &parent, CellFrame &&child)
+{
+    parent.value.cell = finish(std::move(child));
+}
+
+void adopt(MeasureFrame &parent, TimeSignatureFrame &&child)
+{
+    parent.value.time_signature = finish(std::move(child));
+}
+
+void adopt(TuningFrame &parent, ArrayFrame<sequence::Tuning::Interval_t> &&child)
+{
+    parent.value.intervals = std::move(child.values);
+}
+
+void adopt(ScaleFrame &parent, ArrayFrame<std::uint8_t> &&child)
+{
+    parent.value.intervals = std::move(child.values);
+}
+
+void adopt(StateFrame &parent, TuningFrame &&child)
+{
+    parent.value.first.tuning = finish(std::move(child));
+}
+
+void adopt(StateFrame &parent, ScaleFrame &&child)
+{
+    parent.value.first.scale = finish(std::move(child));
+}
+
+void adopt(StateFrame &parent, ArrayFrame<sequence::Measure> &&child)
+{
+    parent.value.first.sequence_bank = first_16(std::move(child.values));
+}
+
+void adopt(StateFrame &parent, ArrayFrame<std::string> &&child)
+{
+    parent.value.first.sequence_names = first_16(std::move(child.values));
+}
+
+void adopt(BankFrame &parent, ArrayFrame<sequence::Measure> &&child)
+{
+    parent.value.first = first_16(std::move(child.values));
+}
+
+void adopt(BankFrame &parent, ArrayFrame<std::string> &&child)
+{
+    parent.value.second = first_16(std::move(child.values));
+}
+
+template <typename P, typename C>
+void adopt(P &, C &&)
+{
+    // Unreachable, open_object and open_array only create valid children.
+    throw std::logic_error{"Invalid JSON frame nesting"};
+}
+
+/**
+ * Marks the current field of \p frame as seen, if it is an object frame.
+ */
+void mark_seen(Frame &frame)
+{
+    std::visit(
+        [](auto &f) {
+            if constexpr (requires { f.seen; })
+            {
+                f.seen |= bit(f.field);
+            }
+        },
+        frame);
+}
+
+/**
+ * nlohmann::json SAX handler that builds the object held by the root Frame.
+ */
+class StateReader
+{
+  public:
+    using json = nlohmann::json;
+
+    explicit StateReader(Frame root) : root_{std::move(root)}
+    {
+        stack_.reserve(16);
+    }
+
+  public:
+    /**
+     * Return the completed root Frame.
+     *
+     * @throws std::invalid_argument If the input did not contain a complete object.
+     */
+    template <typename T>
+    [[nodiscard]] auto take() -> T
+    {
+        if (!result_.has_value())
+        {
+            throw std::invalid_argument{"Expected a JSON object"};
+        }
+        return std::get<T>(std::move(*result_));
+    }
+
+  public: // nlohmann::json_sax interface
+    auto null() -> bool
+    {
+        return this->scalar(nullptr);
+    }
+
+    auto boolean(bool x) -> bool
+    {
+        return this->scalar(x);
+    }
+
+    auto number_integer(json::number_integer_t x) -> bool
+    {
+        return this->scalar(std::int64_t{x});
+    }
+
+    auto number_unsigned(json::number_unsigned_t x) -> bool
+    {
+        return this->scalar(std::uint64_t{x});
+    }
+
+    auto number_float(json::number_float_t x, json::string_t const &) -> bool
+    {
+        return this->scalar(double{x});
+    }
+
+    auto string(json::string_t &x) -> bool
+    {
+        return this->scalar(std::move(x));
+    }
+
+    auto binary(json::binary_t &) -> bool
+    {
+        // Not produced when parsing JSON text.
+        return false;
+    }
+
+    auto start_object(std::size_t) -> bool
+    {
+        if (this->skip_nested())
+        {
+            return true;
+        }
+        if (stack_.empty())
+        {
+            if (result_.has_value())
+            {
+                throw std::invalid_argument{"Unexpected JSON object"};
+            }
+            stack_.push_back(std::move(root_));
+            return true;
+        }
+        auto child = open_object(stack_.back());
+        stack_.push_back(std::move(child));
+        return true;
+    }
+
+    auto key(json::string_t &name) -> bool
+    {
+        std::visit(
+            [&](auto &f) {
+                if constexpr (requires { f.field; })
+                {
+                    f.field = Field::Unknown;
+                    f.key_name = "";
+                    for (auto const &info : keys_of<decltype(f.value)>)
+                    {
+                        if (info.name == name)
+                        {
+                            f.field = info.field;
+                            f.key_name = info.name;
+                            break;
+                        }
+                    }
+                }
+            },
+            stack_.back());
+        return true;
+    }
+
+    auto end_object() -> bool
+    {
+        return this->end_nested();
+    }
+
+    auto start_array(std::size_t) -> bool
+    {
+        if (this->skip_nested())
+        {
+            return true;
+        }
+        if (stack_.empty())
+        {
+            throw std::invalid_argument{"Expected a JSON object"};
+        }
+        auto child = open_array(stack_.back());
+        stack_.push_back(std::move(child));
+        return true;
+    }
+
+    auto end_array() -> bool
+    {
+        return this->end_nested();
+    }
+
+    auto parse_error(std::size_t, std::string const &,
+                     nlohmann::detail::exception const &e) -> bool
+    {
+        throw std::invalid_argument{e.what()};
+    }
+
+  private:
+    [[nodiscard]] auto current_field() const -> Field
+    {
+        return std::visit(
+            [](auto const &f) {
+                if constexpr (requires { f.field; })
+                {
+                    return f.field;
+                }
+                else
+                {
+                    return Field::None;
+                }
+            },
+            stack_.back());
+    }
+
+    /**
+     * Begin skipping the value of an unknown key, or a value nested within one.
+     */
+    [[nodiscard]] auto skip_nested() -> bool
+    {
+        if (skip_depth_ == 0 && !stack_.empty() &&
+            this->current_field() == Field::Unknown)
+        {
+            skip_depth_ = 1;
+            return true;
+        }
+        if (skip_depth_ > 0)
+        {
+            ++skip_depth_;
+            return true;
+        }
+        return false;
+    }
+
+    auto end_nested() -> bool
+    {
+        if (skip_depth_ > 0)
+        {
+            --skip_depth_;
+            return true;
+        }
+
+        auto child = std::move(stack_.back());
+        stack_.pop_back();
+        if (stack_.empty())
+        {
+            result_ = std::move(child);
+            return true;
+        }
+
+        auto &parent = stack_.back();
+        mark_seen(parent);
+        std::visit([](auto &p, auto &&c) { adopt(p, std::move(c)); }, parent,
+                   std::move(child));
+        return true;
+    }
+
+    auto scalar(Scalar x) -> bool
+    {
+        if (skip_depth_ > 0)
+        {
+            return true;
+        }
+        if (stack_.empty())
+        {
+            throw std::invalid_argument{"Expected a JSON object"};
+        }
+
+        auto &top = stack_.back();
+        if (this->current_field() == Field::Unknown)
+        {
+            return true;
+        }
+        mark_seen(top);
+        std::visit([&](auto &f) { set(f, std::move(x)); }, top);
+        return true;
+    }
+
+  private:
+    Frame root_;
+    std::vector<Frame> stack_;
+    std::optional<Frame> result_{std::nullopt};
+    int skip_depth_ = 0;
+};
+
+/**
+ * Parse \p json_str into the object read by the Frame type T.
+ *
+ * @throws std::invalid_argument If the JSON is malformed or does not match T.
+ */
+template <typename T>
+[[nodiscard]] auto parse(std::string const &json_str) -> T
+{
+    auto reader = StateReader{T{}};
+    if (!nlohmann::json::sax_parse(json_str, &reader))
+    {
+        throw std::invalid_argument{"Invalid JSON"};
+    }
+    return reader.take<T>();
+}
+
+} // namespace
+
+namespace xen
+{
 
 auto serialize_cell(sequence::Cell const &c) -> std::string
 {
-    auto json = nlohmann::json{};
-    to_json(json, c);
-    return json.dump();
+    auto w = JsonWriter{};
+    w.out.reserve(count_cells(c) * bytes_per_cell);
+    write_object(w, c);
+    return std::move(w.out);
 }
 
 auto deserialize_cell(std::string const &json_str) -> sequence::Cell
 {
-    auto const json = nlohmann::json::parse(json_str);
-    auto cell = sequence::Cell{};
-    from_json(json, cell);
-    return cell;
+    return finish(parse<CellFrame>(json_str));
 }
 
 auto serialize_measure(sequence::Measure const &m) -> std::string
 {
-    auto json = nlohmann::json{};
-    to_json(json, m);
-    return json.dump();
+    auto w = JsonWriter{};
+    w.out.reserve(count_cells(m.cell) * bytes_per_cell + 64);
+    write_object(w, m);
+    return std::move(w.out);
 }
 
 auto deserialize_measure(std::string const &json_str) -> sequence::Measure
 {
-    auto const json = nlohmann::json::parse(json_str);
-    auto measure = sequence::Measure{};
-    from_json(json, measure);
-    return measure;
+    return finish(parse<MeasureFrame>(json_str));
 }
 
 auto serialize_sequence_bank(SequenceBank const &bank,
                              std::array<std::string, 16> const &sequence_names)
     -> std::string
 {
-    auto json = nlohmann::json{
-        {"sequence_bank", bank},
-        {"sequence_names", sequence_names},
-    };
-    return json.dump();
+    auto w = JsonWriter{};
+    w.out.reserve(count_cells(bank) * bytes_per_cell + 2'048);
+    w.raw("{");
+    write_bank_members(w, bank, sequence_names, true);
+    w.raw("}");
+    return std::move(w.out);
 }
 
 auto deserialize_sequence_bank(std::string const &json_str)
     -> std::pair<SequenceBank, std::array<std::string, 16>>
 {
-    auto const json = nlohmann::json::parse(json_str);
-    auto bank = json.at("sequence_bank").get<SequenceBank>();
-    auto const sequence_names =
-        json.at("sequence_names").get<std::array<std::string, 16>>();
-    return {bank, sequence_names};
+    return finish(parse<BankFrame>(json_str));
 }
 
 auto serialize_plugin(SequencerState const &state) -> std::string
 {
-    auto json = nlohmann::json{};
-    to_json(json, state);
-    return json.dump();
+    auto w = JsonWriter{};
+    w.out.reserve(count_cells(state.sequence_bank) * bytes_per_cell + 4'096);
+    write_object(w, state);
+    return std::move(w.out);
 }
 
 auto deserialize_plugin(std::string const &json_str) -> SequencerState
 {
-    return nlohmann::json::parse(json_str).get<SequencerState>();
+    return finish(parse<StateFrame>(json_str)).first;
+}
+
+auto serialize_host_state(SequencerState const &state, std::string const &instance_id)
+    -> std::string
+{
+    auto w = JsonWriter{};
+    w.out.reserve(count_cells(state.sequence_bank) * bytes_per_cell + 4'096);
+    w.raw("{");
+    write_members(w, state, instance_id);
+    w.raw("}");
+    return std::move(w.out);
+}
+
+auto deserialize_host_state(std::string const &json_str)
+    -> std::pair<SequencerState, std::string>
+{
+    return finish(parse<StateFrame>(json_str));
 }
 
-} // namespace xen
\ No newline at end of file
+} // namespace xen
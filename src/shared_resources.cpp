@@ -0,0 +1,137 @@
+#include <xen/shared_resources.hpp>
+
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <xen/chord.hpp>
+#include <xen/gui/themes.hpp>
+#include <xen/key_core.hpp>
+#include <xen/scale.hpp>
+#include <xen/user_directory.hpp>
+
+namespace xen
+{
+
+SharedResources::SharedResources()
+    : scales_{std::make_shared<std::vector<Scale> const>(get_system_scales())},
+      chords_{std::make_shared<std::vector<Chord> const>(get_system_chords())},
+      library_thread_{[this] {
+          try
+          {
+              initialize_library_files();
+              this->reload_scales();
+              this->reload_chords();
+          }
+          catch (std::exception const &e)
+          {
+              auto const lock = std::lock_guard{mtx_};
+              library_error_ = e.what();
+          }
+          this->sendChangeMessage();
+      }}
+{
+}
+
+SharedResources::~SharedResources()
+{
+    library_thread_.join();
+}
+
+auto SharedResources::scales() const -> std::shared_ptr<std::vector<Scale> const>
+{
+    auto const lock = std::lock_guard{mtx_};
+    return scales_;
+}
+
+auto SharedResources::chords() const -> std::shared_ptr<std::vector<Chord> const>
+{
+    auto const lock = std::lock_guard{mtx_};
+    return chords_;
+}
+
+auto SharedResources::reload_scales() -> bool
+{
+    auto const lock = std::lock_guard{reload_mtx_};
+    auto current = stamp(get_user_scales_file());
+    if (scales_stamp_ == current)
+    {
+        return false;
+    }
+
+    auto scales = std::make_shared<std::vector<Scale> const>(load_scales_from_files());
+    {
+        auto const publish_lock = std::lock_guard{mtx_};
+        scales_ = std::move(scales);
+    }
+    scales_stamp_ = std::move(current);
+    return true;
+}
+
+auto SharedResources::reload_chords() -> bool
+{
+    auto const lock = std::lock_guard{reload_mtx_};
+    auto current = stamp(get_user_chords_file());
+    if (chords_stamp_ == current)
+    {
+        return false;
+    }
+
+    auto chords = std::make_shared<std::vector<Chord> const>(load_chords_from_files());
+    {
+        auto const publish_lock = std::lock_guard{mtx_};
+        chords_ = std::move(chords);
+    }
+    chords_stamp_ = std::move(current);
+    return true;
+}
+
+auto SharedResources::library_error() const -> std::optional<std::string>
+{
+    auto const lock = std::lock_guard{mtx_};
+    return library_error_;
+}
+
+auto SharedResources::key_cores(juce::File const &user_keys)
+    -> std::shared_ptr<KeyCores const>
+{
+    auto current = stamp(user_keys);
+    if (key_cores_ == nullptr || key_cores_stamp_ != current)
+    {
+        key_cores_ = std::make_shared<KeyCores const>(load_key_cores(user_keys));
+        key_cores_stamp_ = std::move(current);
+    }
+    return key_cores_;
+}
+
+auto SharedResources::look_and_feel(gui::Theme const &theme)
+    -> std::shared_ptr<juce::LookAndFeel>
+{
+    if (laf_ == nullptr || laf_theme_ != theme)
+    {
+        // Editors still showing the previous theme keep it alive until they switch.
+        laf_ = gui::make_laf(theme);
+        laf_theme_ = theme;
+    }
+    return laf_;
+}
+
+auto SharedResources::stamp(juce::File const &file) -> FileStamp
+{
+    return {
+        .path = file.getFullPathName().toStdString(),
+        .modified = file.getLastModificationTime().toMilliseconds(),
+        .size = file.getSize(),
+    };
+}
+
+} // namespace xen
@@ -0,0 +1,116 @@
+#include <xen/state_blob_cache.hpp>
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <xen/serialize.hpp>
+#include <xen/state.hpp>
+
+namespace xen
+{
+
+StateBlobCache::StateBlobCache() : thread_{[this] { this->run(); }}
+{
+}
+
+StateBlobCache::~StateBlobCache()
+{
+    {
+        auto const lock = std::lock_guard{mtx_};
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+void StateBlobCache::update(int commit_id, std::shared_ptr<SequencerState const> state,
+                            std::string instance_id)
+{
+    {
+        auto const lock = std::lock_guard{mtx_};
+        if (commit_id == commit_id_ && instance_id == instance_id_)
+        {
+            return;
+        }
+        commit_id_ = commit_id;
+        instance_id_ = std::move(instance_id);
+        state_ = std::move(state);
+        ++state_id_;
+    }
+    cv_.notify_one();
+}
+
+auto StateBlobCache::get() -> std::shared_ptr<std::string const>
+{
+    auto lock = std::unique_lock{mtx_};
+    if (state_ == nullptr)
+    {
+        throw std::logic_error{"StateBlobCache::get called before update"};
+    }
+    if (blob_id_ == state_id_)
+    {
+        return blob_;
+    }
+
+    auto const id = state_id_;
+    auto const state = state_;
+    auto const instance_id = instance_id_;
+    lock.unlock();
+
+    auto blob =
+        std::make_shared<std::string const>(serialize_host_state(*state, instance_id));
+
+    lock.lock();
+    if (id == state_id_)
+    {
+        blob_id_ = id;
+        blob_ = blob;
+    }
+    return blob;
+}
+
+void StateBlobCache::run()
+{
+    auto lock = std::unique_lock{mtx_};
+    while (true)
+    {
+        cv_.wait(lock, [this] { return stop_ || blob_id_ != state_id_; });
+        if (stop_)
+        {
+            return;
+        }
+
+        auto const id = state_id_;
+        auto const state = state_;
+        auto const instance_id = instance_id_;
+        lock.unlock();
+
+        auto blob = std::shared_ptr<std::string const>{};
+        try
+        {
+            blob = std::make_shared<std::string const>(
+                serialize_host_state(*state, instance_id));
+        }
+        catch (...)
+        {
+            // get() serializes again on the calling thread and reports the error.
+        }
+
+        lock.lock();
+        if (blob == nullptr)
+        {
+            // Wait for the next update instead of retrying this state.
+            cv_.wait(lock, [this, id] { return stop_ || state_id_ != id; });
+        }
+        else if (id == state_id_)
+        {
+            blob_id_ = id;
+            blob_ = std::move(blob);
+        }
+    }
+}
+
+} // namespace xen
@@ -4,7 +4,6 @@
 #include <cctype>
 #include <cstddef>
 #include <iterator>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -35,8 +34,6 @@ auto minimize_spaces(std::string const &input) -> std::string
     auto result = std::string{};
     result.reserve(input.size());
 
-    auto stream = std::istringstream{input};
-    auto word = std::string{};
     bool in_quotes = false;
 
     for (auto const &ch : input)
@@ -64,22 +61,18 @@ auto minimize_spaces(std::string const &input) -> std::string
 auto get_first_word(std::string const &input) -> std::string
 {
     auto result = std::string{};
-    auto stream = std::istringstream{input};
-    char ch;
     bool in_quotes = false;
 
-    // Move stream past initial spaces
-    while (stream.get(ch))
+    // Move past initial spaces
+    auto i = std::string::size_type{0};
+    while (i < input.size() && std::isspace(static_cast<unsigned char>(input[i])))
     {
-        if (!std::isspace(ch))
-        {
-            stream.unget();
-            break;
-        }
+        ++i;
     }
 
-    while (stream.get(ch))
+    for (; i < input.size(); ++i)
     {
+        auto const ch = input[i];
         if (ch == '"')
         {
             in_quotes = !in_quotes;
@@ -166,60 +159,169 @@ auto word_count(std::string const &input) -> std::size_t
 
 auto split(std::string const &input, char delimiter) -> std::vector<std::string>
 {
+    // Same results as repeated std::getline: no trailing empty element.
     auto result = std::vector<std::string>{};
-    auto stream = std::istringstream{input};
-    auto word = std::string{};
+    auto const view = std::string_view{input};
 
-    while (std::getline(stream, word, delimiter))
+    auto begin = std::size_t{0};
+    while (begin < view.size())
     {
-        result.push_back(word);
+        auto const end = std::min(view.find(delimiter, begin), view.size());
+        result.emplace_back(view.substr(begin, end - begin));
+        begin = end + 1;
     }
 
     return result;
 }
 
-auto split_quoted_string(std::string const &input) -> std::vector<std::string>
+ParseError::ParseError(std::string const &message, std::size_t position)
+    : std::invalid_argument{message + " at column " + std::to_string(position + 1)},
+      position_{position}
 {
-    auto result = std::vector<std::string>{};
-    auto current_word = std::string{};
-    bool in_quotes = false;
-    int json_depth = 0;
+}
 
-    for (char ch : input)
+auto ParseError::position() const -> std::size_t
+{
+    return position_;
+}
+
+void TokenList::push_back(Token const &token)
+{
+    if (size_ == capacity)
     {
-        if (ch == '"' && json_depth == 0)
-        {
-            in_quotes = !in_quotes;
-        }
-        else if (ch == '{')
+        throw ParseError{"Too many words, limit is " + std::to_string(capacity),
+                         token.position};
+    }
+    tokens_[size_++] = token;
+}
+
+auto tokenize(std::string_view input) -> TokenList
+{
+    // Same set as std::isspace in the "C" locale, without the per-character call.
+    auto const is_space = [](char ch) {
+        return ch == ' ' || (ch >= '\t' && ch <= '\r');
+    };
+
+    // Default initialized on purpose, TokenList{} would zero the entire array.
+    TokenList result;
+    auto i = std::size_t{0};
+
+    while (true)
+    {
+        while (i < input.size() && is_space(input[i]))
         {
-            json_depth++;
-            current_word += ch;
+            ++i;
         }
-        else if (ch == '}' && json_depth > 0)
+        if (i == input.size())
         {
-            json_depth--;
-            current_word += ch;
+            break;
         }
-        else if (std::isspace(ch) && !in_quotes && json_depth == 0)
+
+        auto const begin = i;
+        auto quote_count = 0;
+        auto quote_open = std::size_t{0};
+        auto json_depth = 0;
+        auto json_open = std::size_t{0};
+
+        for (; i < input.size(); ++i)
         {
-            if (!current_word.empty())
+            auto const ch = input[i];
+            auto const in_quotes = quote_count % 2 == 1;
+            if (ch == '"' && json_depth == 0)
             {
-                result.push_back(current_word);
-                current_word.clear();
+                quote_open = i;
+                ++quote_count;
+            }
+            else if (ch == '{' && !in_quotes)
+            {
+                json_open = (json_depth == 0) ? i : json_open;
+                ++json_depth;
+            }
+            else if (ch == '}' && !in_quotes && json_depth > 0)
+            {
+                --json_depth;
+            }
+            else if (is_space(ch) && !in_quotes && json_depth == 0)
+            {
+                break;
             }
         }
-        else
+
+        if (quote_count % 2 == 1)
         {
-            current_word += ch;
+            throw ParseError{"Unterminated double quote", quote_open};
+        }
+        if (json_depth > 0)
+        {
+            throw ParseError{"Unterminated curly brace", json_open};
+        }
+
+        auto token = Token{
+            .text = input.substr(begin, i - begin),
+            .position = begin,
+            .has_inner_quotes = quote_count > 0,
+        };
+
+        // The common quoted case, "a b c", can be a view without the quotes.
+        if (quote_count == 2 && token.text.front() == '"' && token.text.back() == '"')
+        {
+            token.text = token.text.substr(1, token.text.size() - 2);
+            token.position += 1;
+            token.has_inner_quotes = false;
+        }
+
+        // Quoted empty strings do not produce a word.
+        if (token.text.find_first_not_of('"') != std::string_view::npos)
+        {
+            result.push_back(token);
         }
     }
 
-    if (!current_word.empty())
+    return result;
+}
+
+auto to_string(Token const &token) -> std::string
+{
+    if (!token.has_inner_quotes)
+    {
+        return std::string{token.text};
+    }
+
+    // Mirrors the quote and brace tracking in tokenize().
+    auto result = std::string{};
+    result.reserve(token.text.size());
+    auto in_quotes = false;
+    auto json_depth = 0;
+    for (auto const ch : token.text)
     {
-        result.push_back(current_word);
+        if (ch == '"' && json_depth == 0)
+        {
+            in_quotes = !in_quotes;
+            continue;
+        }
+        if (ch == '{' && !in_quotes)
+        {
+            ++json_depth;
+        }
+        else if (ch == '}' && !in_quotes && json_depth > 0)
+        {
+            --json_depth;
+        }
+        result.push_back(ch);
     }
+    return result;
+}
 
+auto split_quoted_string(std::string const &input) -> std::vector<std::string>
+{
+    auto const tokens = tokenize(input);
+
+    auto result = std::vector<std::string>{};
+    result.reserve(tokens.size());
+    for (auto const &token : tokens)
+    {
+        result.push_back(to_string(token));
+    }
     return result;
 }
 
@@ -1,19 +1,42 @@
 #include <xen/user_directory.hpp>
 
 #include <cstddef>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 
 #include <juce_core/juce_core.h>
 
-#include <yaml-cpp/yaml.h>
-
 #include <embed_chords.hpp>
 #include <embed_demos.hpp>
 #include <embed_keys.hpp>
 #include <embed_scales.hpp>
 
-#include <xen/constants.hpp>
+namespace
+{
+
+/**
+ * Write \p data to \p file unless it already holds exactly that.
+ *
+ * @details Compared byte for byte, so an outdated file is replaced without having to
+ * parse it for its version.
+ * @return False if the file could not be written.
+ */
+[[nodiscard]] auto write_if_changed(juce::File const &file, char const *data, int size)
+    -> bool
+{
+    if (file.existsAsFile() && file.getSize() == size)
+    {
+        auto existing = juce::MemoryBlock{};
+        if (file.loadFileAsData(existing) && existing.matches(data, (std::size_t)size))
+        {
+            return true;
+        }
+    }
+    return file.replaceWithData(data, (std::size_t)size);
+}
+
+} // namespace
 
 namespace xen
 {
@@ -59,33 +82,28 @@ auto get_tunings_directory() -> juce::File
     return tunings_dir;
 }
 
-auto get_system_keys_file() -> juce::File
+auto get_autosave_directory() -> juce::File
 {
-    auto const key_file = get_user_library_directory().getChildFile("keys.yml");
-    auto const full_path = key_file.getFullPathName().toStdString();
-
-    auto write_system_keys = [&key_file] {
-        return key_file.create().wasOk() &&
-        key_file.replaceWithData(embed_keys::keys_yml,
-                                 (std::size_t)embed_keys::keys_ymlSize);
-    };
-
-    auto const file_exists = key_file.existsAsFile();
+    auto const autosave_dir = get_user_library_directory().getChildFile("autosave");
 
-    if (file_exists)
+    // Create directory if it doesn't exist
+    if (!autosave_dir.exists() && !autosave_dir.createDirectory().wasOk())
     {
-        auto root = YAML::LoadFile(full_path);
-        auto const ver_node = root["version"];
-        if (ver_node.IsDefined() && ver_node.as<std::string>() == xen::VERSION)
-        {
-            return key_file;
-        }
+        throw std::runtime_error("Unable to create autosave directory: " +
+                                 autosave_dir.getFullPathName().toStdString() + ".");
     }
+    return autosave_dir;
+}
 
-    return write_system_keys()
-               ? key_file
-               : throw std::runtime_error(
-                     "Unable to create keybinding file: " + full_path + ".");
+auto get_system_keys_file() -> juce::File
+{
+    auto const key_file = get_user_library_directory().getChildFile("keys.yml");
+    if (!write_if_changed(key_file, embed_keys::keys_yml, embed_keys::keys_ymlSize))
+    {
+        throw std::runtime_error("Unable to create keybinding file: " +
+                                 key_file.getFullPathName().toStdString() + ".");
+    }
+    return key_file;
 }
 
 auto get_user_keys_file() -> juce::File
@@ -114,30 +132,13 @@ auto get_user_keys_file() -> juce::File
 auto get_system_scales_file() -> juce::File
 {
     auto const scales_file = get_user_library_directory().getChildFile("scales.yml");
-    auto const full_path = scales_file.getFullPathName().toStdString();
-
-    auto write_system_scales = [&scales_file] {
-        return scales_file.create().wasOk() &&
-               scales_file.replaceWithData(embed_scales::scales_yml,
-                                          (std::size_t)embed_scales::scales_ymlSize);
-    };
-
-    auto const file_exists = scales_file.existsAsFile();
-
-    if (file_exists)
+    if (!write_if_changed(scales_file, embed_scales::scales_yml,
+                          embed_scales::scales_ymlSize))
     {
-        auto root = YAML::LoadFile(full_path);
-        auto const ver_node = root["version"];
-        if (ver_node.IsDefined() && ver_node.as<std::string>() == xen::VERSION)
-        {
-            return scales_file;
-        }
+        throw std::runtime_error("Unable to create scales file: " +
+                                 scales_file.getFullPathName().toStdString() + ".");
     }
-
-    return write_system_scales()
-               ? scales_file
-               : throw std::runtime_error("Unable to create scales file: " + full_path +
-                                          ".");
+    return scales_file;
 }
 
 auto get_user_scales_file() -> juce::File
@@ -166,30 +167,13 @@ auto get_user_scales_file() -> juce::File
 auto get_system_chords_file() -> juce::File
 {
     auto const chords_file = get_user_library_directory().getChildFile("chords.yml");
-    auto const full_path = chords_file.getFullPathName().toStdString();
-
-    auto write_system_chords = [&chords_file] {
-        return chords_file.create().wasOk() &&
-               chords_file.replaceWithData(embed_chords::chords_yml,
-                                          (std::size_t)embed_chords::chords_ymlSize);
-    };
-
-    auto const file_exists = chords_file.existsAsFile();
-
-    if (file_exists)
+    if (!write_if_changed(chords_file, embed_chords::chords_yml,
+                          embed_chords::chords_ymlSize))
     {
-        auto root = YAML::LoadFile(full_path);
-        auto const ver_node = root["version"];
-        if (ver_node.IsDefined() && ver_node.as<std::string>() == xen::VERSION)
-        {
-            return chords_file;
-        }
+        throw std::runtime_error("Unable to create chords file: " +
+                                 chords_file.getFullPathName().toStdString() + ".");
     }
-
-    return write_system_chords()
-               ? chords_file
-               : throw std::runtime_error("Unable to create chords file: " + full_path +
-                                          ".");
+    return chords_file;
 }
 
 auto get_user_chords_file() -> juce::File
@@ -249,4 +233,18 @@ void initialize_demo_files()
     }
 }
 
+void initialize_library_files()
+{
+    static auto once = std::once_flag{};
+    std::call_once(once, [] {
+        initialize_demo_files();
+        (void)get_system_keys_file();
+        (void)get_user_keys_file();
+        (void)get_system_scales_file();
+        (void)get_user_scales_file();
+        (void)get_system_chords_file();
+        (void)get_user_chords_file();
+    });
+}
+
 } // namespace xen
\ No newline at end of file
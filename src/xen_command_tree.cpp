@@ -1,39 +1,225 @@
 #include <xen/xen_command_tree.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
 #include <iterator>
 #include <mutex>
 #include <optional>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <utility>
 #include <variant>
+#include <vector>
+
+#include <juce_core/juce_core.h>
 
 #include <sequence/pattern.hpp>
 #include <sequence/sequence.hpp>
+#include <sequence/tuning.hpp>
 #include <sequence/utility.hpp> //temp
 
 #include <xen/actions.hpp>
+#include <xen/autosave.hpp>
+#include <xen/background_worker.hpp>
 #include <xen/chord.hpp>
 #include <xen/command.hpp>
 #include <xen/constants.hpp>
 #include <xen/gui/themes.hpp>
 #include <xen/input_mode.hpp>
+#include <xen/library_index.hpp>
 #include <xen/message_level.hpp>
 #include <xen/modulator.hpp>
 #include <xen/scale.hpp>
 #include <xen/state.hpp>
 #include <xen/string_manip.hpp>
 #include <xen/user_directory.hpp>
+#include <xen/utility.hpp>
 
 namespace xen
 {
 
 using sequence::Pattern;
 
+namespace
+{
+
+// Selections with more Cells than this are randomized on the background worker.
+constexpr auto background_cell_threshold = std::size_t{4'096};
+
+// Commands that do not modify the TrackedState, these can be run while the background
+// worker is busy. Every other command is rejected until the worker has finished. Two
+// word entries allow a single command from a group.
+constexpr auto commands_allowed_while_busy = std::array{
+    "cancel", "copy", "export messagelog", "focus", "librarydirectory", "search",
+    "set messageloglevel", "show", "version", "welcome",
+};
+
+/**
+ * Count the Cells in \p cell, including itself, stopping once \p limit is passed.
+ */
+[[nodiscard]] auto count_cells(sequence::Cell const &cell, std::size_t limit)
+    -> std::size_t
+{
+    auto count = std::size_t{1};
+    if (auto const *seq = std::get_if<sequence::Sequence>(&cell.element))
+    {
+        for (auto const &child : seq->cells)
+        {
+            if (count > limit)
+            {
+                break;
+            }
+            count += count_cells(child, limit - count);
+        }
+    }
+    return count;
+}
+
+/**
+ * Write \p filepath from a background task, through a temporary file that only
+ * replaces it if the task has not been cancelled by then.
+ *
+ * @param write Called with the temporary file to write to.
+ * @return False if the task was cancelled and \p filepath was left untouched.
+ * @throws std::runtime_error If \p filepath could not be replaced.
+ */
+[[nodiscard]] auto write_unless_cancelled(juce::File const &filepath,
+                                          TaskContext const &ctx, auto const &write)
+    -> bool
+{
+    auto temp = juce::TemporaryFile{filepath}; // Deleted with temp unless moved.
+    write(temp.getFile());
+    if (ctx.is_cancelled())
+    {
+        return false;
+    }
+    if (!temp.overwriteTargetFileWithTemporary())
+    {
+        throw std::runtime_error{"Could not write file: " +
+                                 filepath.getFullPathName().toStdString()};
+    }
+    return true;
+}
+
+/**
+ * Apply a randomize function to the selected Cell.
+ *
+ * @details Small selections are modified in place, large selections are modified on
+ * the background worker against a snapshot of the current state.
+ * @param ps The PluginState to modify.
+ * @param name The name of the randomized parameter, used in status messages.
+ * @param fn The sequence::modify::randomize_* function to apply.
+ * @param args The arguments to pass to fn after the selected Cell.
+ * @throws std::runtime_error If no Cell is selected.
+ */
+template <typename Fn, typename... Args>
+[[nodiscard]] auto randomize_selected(PluginState &ps, std::string const &name, Fn fn,
+                                      Args... args)
+    -> std::pair<MessageLevel, std::string>
+{
+    auto const &[state, aux] = ps.timeline.peek_state();
+    auto const &selected = get_selected_cell_const(state.sequence_bank, aux.selected);
+
+    if (count_cells(selected, background_cell_threshold) <= background_cell_threshold)
+    {
+        increment_state(ps.timeline, fn, args...);
+        ps.timeline.set_commit_flag();
+        return minfo("Randomized " + name);
+    }
+
+    ps.worker.start("Randomize " + name, [snapshot = ps.timeline.get_state(), name, fn,
+                                          args...](TaskContext &) mutable {
+        auto &cell =
+            get_selected_cell(snapshot.sequencer.sequence_bank, snapshot.aux.selected);
+        cell = fn(cell, args...);
+        return TaskResult{[snapshot = std::move(snapshot), name](PluginState &ps) {
+            ps.timeline.stage(snapshot);
+            ps.timeline.set_commit_flag();
+            return minfo("Randomized " + name);
+        }};
+    });
+    return minfo("Randomizing " + name + "...");
+}
+
+/**
+ * Load the sequence bank at \p filepath on the background worker. Binary and JSON
+ * files are both accepted, the format is detected from the file contents.
+ */
+[[nodiscard]] auto start_sequence_bank_load(PluginState &ps, juce::File const &filepath)
+    -> std::pair<MessageLevel, std::string>
+{
+    if (!filepath.exists())
+    {
+        return merror("File Not Found: " + filepath.getFullPathName().toStdString());
+    }
+
+    ps.worker.start("Load Sequence Bank", [filepath](TaskContext &) {
+        auto [sb, names] = action::load_sequence_bank(filepath);
+        return TaskResult{
+            [sb = std::move(sb), names = std::move(names)](PluginState &ps) {
+                auto [state, aux] = ps.timeline.get_state();
+                state.sequence_bank = sb;
+                state.sequence_names = names;
+
+                ps.timeline.stage({std::move(state), std::move(aux)});
+                ps.timeline.set_commit_flag();
+
+                return minfo("Sequence Bank Loaded");
+            }};
+    });
+
+    return minfo("Loading Sequence Bank...");
+}
+
+/**
+ * Stage \p tuning as the current tuning and set the commit flag.
+ */
+[[nodiscard]] auto stage_tuning(PluginState &ps, sequence::Tuning tuning,
+                                std::string name)
+    -> std::pair<MessageLevel, std::string>
+{
+    auto [seq, aux] = ps.timeline.get_state();
+    seq.tuning_name = std::move(name);
+    seq.tuning = std::move(tuning);
+
+    ps.timeline.stage({std::move(seq), std::move(aux)});
+    ps.timeline.set_commit_flag();
+
+    return minfo("Tuning Loaded");
+}
+
+/**
+ * Load the tuning at \p filepath. Files already read by the LibraryIndex are loaded
+ * immediately from their entry, others are parsed on the background worker.
+ */
+[[nodiscard]] auto start_tuning_load(PluginState &ps, juce::File const &filepath)
+    -> std::pair<MessageLevel, std::string>
+{
+    auto name = filepath.getFileNameWithoutExtension().toStdString();
+
+    if (auto const entry = ps.library_index->find_current(filepath);
+        entry != nullptr && entry->readable)
+    {
+        return stage_tuning(ps, entry->tuning, std::move(name));
+    }
+
+    ps.worker.start("Load Tuning", [filepath, name](TaskContext &) {
+        auto tuning = sequence::from_scala(filepath.getFullPathName().toStdString());
+        return TaskResult{[tuning = std::move(tuning), name](PluginState &ps) {
+            return stage_tuning(ps, tuning, name);
+        }};
+    });
+
+    return minfo("Loading Tuning...");
+}
+
+} // namespace
+
 auto create_command_tree() -> XenCommandTree
 {
     using PS = PluginState;
@@ -85,6 +271,54 @@ auto create_command_tree() -> XenCommandTree
         return ps.timeline.redo() ? minfo("Redone") : minfo("Nothing to redo.");
     }));
 
+    // cancel
+    head.add(cmd(signature("cancel"),
+                 "Stop the command running in the background, its result is discarded.",
+                 [](PS &ps) {
+                     return ps.worker.cancel()
+                                ? minfo("Cancelling " + ps.worker.description())
+                                : minfo("Nothing to cancel.");
+                 }));
+
+    // recover
+    head.add(cmd(
+        signature("recover"),
+        "Restore the most recent autosave of this plugin instance, left by a session "
+        "that did not close normally, such as after a crash.",
+        [](PS &ps) {
+            auto const instance_id = ps.instance_id;
+            ps.worker.start("Recover Autosave", [instance_id](TaskContext &ctx) {
+                for (auto const &journal :
+                     find_recoverable_journals(get_autosave_directory(), instance_id))
+                {
+                    if (ctx.is_cancelled())
+                    {
+                        break;
+                    }
+                    try
+                    {
+                        auto session = read_journal(journal);
+                        return TaskResult{[session = std::move(session),
+                                           journal](PluginState &ps) {
+                            ps.timeline.stage({session.state, AuxState{}});
+                            ps.timeline.set_commit_flag();
+                            ps.recoverable_autosave = false;
+                            journal.deleteFile();
+                            return minfo("Autosave Recovered, Last Change: " +
+                                         session.last_command);
+                        }};
+                    }
+                    catch (std::exception const &)
+                    {
+                        // Unreadable, try the next most recent.
+                    }
+                }
+                return TaskResult{
+                    [](PluginState &) { return mwarning("No Autosave To Recover"); }};
+            });
+            return minfo("Recovering Autosave...");
+        }));
+
     // copy
     head.add(cmd(signature("copy"),
                  "Copy the current selection into the shared copy buffer.", [](PS &ps) {
@@ -106,11 +340,13 @@ auto create_command_tree() -> XenCommandTree
 
     // paste
     head.add(cmd(
-        signature("paste"),
-        "Replace the current selection with the contents of the shared copy buffer.",
-        [](PS &ps) {
+        signature("paste", arg<std::size_t>("history", 0)),
+        "Replace the current selection with the contents of the shared copy buffer. "
+        "history selects an earlier copy, 0 is the most recent and up to 15 "
+        "previous copies are kept.",
+        [](PS &ps, std::size_t history) {
             auto [_, aux] = ps.timeline.get_state();
-            ps.timeline.stage({action::paste(ps.timeline), std::move(aux)});
+            ps.timeline.stage({action::paste(ps.timeline, history), std::move(aux)});
             ps.timeline.set_commit_flag();
             return minfo("Selection Pasted Over");
         }));
@@ -152,6 +388,31 @@ auto create_command_tree() -> XenCommandTree
                      return mdebug("Showing " + single_quote(component_id));
                  }));
 
+    // search
+    head.add(cmd(
+        signature("search", arg<std::string>("query")),
+        "Filter the Library to sequence banks and tunings matching the query. Words "
+        "match the beginning of any word in a file name, sequence name or tuning "
+        "description. Attributes can be compared with =, <, >, <= or >=: notes (the "
+        "note count of any measure), size (the size of a tuning) and ts (a measure's "
+        "time signature, as ts=7/8). An empty query clears the filter.",
+        [](PS &ps, std::string const &query) {
+            auto const results = ps.library_index->search(query);
+            auto const sequence_banks =
+                std::ranges::count_if(results, [](auto const &entry) {
+                    return entry->type == LibraryEntry::Type::SequenceBank;
+                });
+            ps.on_search_request(query);
+            ps.on_show_request("LibraryView");
+            if (query.empty())
+            {
+                return mdebug("Library Filter Cleared");
+            }
+            return minfo(std::to_string(sequence_banks) + " Sequence Banks and " +
+                         std::to_string(std::ssize(results) - sequence_banks) +
+                         " Tunings Match " + single_quote(query));
+        }));
+
     {
         auto load = cmd_group("load");
 
@@ -168,22 +429,7 @@ auto create_command_tree() -> XenCommandTree
                     return merror("Invalid Current Sequence Directory");
                 }
 
-                auto const filepath = cd.getChildFile(filename + ".xss");
-                if (!filepath.exists())
-                {
-                    return merror("File Not Found: " +
-                                  filepath.getFullPathName().toStdString());
-                }
-
-                auto [state, aux] = ps.timeline.get_state();
-                auto [sb, names] = action::load_sequence_bank(filepath);
-                state.sequence_bank = std::move(sb);
-                state.sequence_names = std::move(names);
-
-                ps.timeline.stage({std::move(state), std::move(aux)});
-                ps.timeline.set_commit_flag();
-
-                return minfo("Sequence Bank Loaded");
+                return start_sequence_bank_load(ps, cd.getChildFile(filename + ".xss"));
             }));
 
         // load tuning
@@ -205,20 +451,13 @@ auto create_command_tree() -> XenCommandTree
                                   filepath.getFullPathName().toStdString());
                 }
 
-                auto [seq, aux] = ps.timeline.get_state();
-                seq.tuning_name = filepath.getFileNameWithoutExtension().toStdString();
-                seq.tuning =
-                    sequence::from_scala(filepath.getFullPathName().toStdString());
-
-                ps.timeline.stage({std::move(seq), std::move(aux)});
-                ps.timeline.set_commit_flag();
-
-                return minfo("Tuning Loaded");
+                return start_tuning_load(ps, filepath);
             }));
 
         // load keys
-        load->add(
-            cmd(signature("keys"), "Load keys.yml and user_keys.yml.", [](PS &ps) {
+        load->add(cmd(
+            signature("keys"), "Load user_keys.yml over the built-in key bindings.",
+            [](PS &ps) {
                 try
                 {
                     auto const lock = std::lock_guard{
@@ -235,16 +474,20 @@ auto create_command_tree() -> XenCommandTree
 
         // load scales
         load->add(cmd(
-            signature("scales"), "Load scales.yml and user_scales.yml.", [](PS &ps) {
-                ps.scales = load_scales_from_files();
-                return minfo("Scales Loaded: " + std::to_string(ps.scales.size()));
+            signature("scales"), "Load the built-in scales and user_scales.yml.",
+            [](PS &ps) {
+                ps.resources->reload_scales();
+                return minfo("Scales Loaded: " +
+                             std::to_string(ps.resources->scales()->size()));
             }));
 
         // load chords
         load->add(cmd(
-            signature("chords"), "Load chords.yml and user_chords.yml.", [](PS &ps) {
-                ps.chords = load_chords_from_files();
-                return minfo("Chords Loaded: " + std::to_string(ps.chords.size()));
+            signature("chords"), "Load the built-in chords and user_chords.yml.",
+            [](PS &ps) {
+                ps.resources->reload_chords();
+                return minfo("Chords Loaded: " +
+                             std::to_string(ps.resources->chords()->size()));
             }));
 
         head.add(std::move(load));
@@ -255,28 +498,151 @@ auto create_command_tree() -> XenCommandTree
 
         // save sequenceBank
         save->add(cmd(
-            signature("sequenceBank", arg<std::string>("filename")),
+            signature("sequenceBank", arg<std::string>("filename"),
+                      arg<std::string>("format", "json")),
             "Save the entire sequence bank to a file. The file will be located in "
             "the library's current sequence directory. Do not include the .xss "
-            "extension in the filename you provide.",
-            [](PS &ps, std::string const &filename) {
+            "extension in the filename you provide. format is either json or binary, "
+            "binary files are smaller and faster to load but can't be read by "
+            "versions of XenSequencer before it was added.",
+            [](PS &ps, std::string const &filename, std::string const &format) {
                 auto const cd = ps.current_sequence_directory;
                 if (!cd.isDirectory())
                 {
                     return merror("Invalid Current Sequence Directory");
                 }
 
+                auto const binary = to_lower(format) == "binary";
+                if (!binary && to_lower(format) != "json")
+                {
+                    return merror("Unknown Sequence Bank Format: " + format);
+                }
+
                 auto const filepath = cd.getChildFile(filename + ".xss");
-                auto const [state, _] = ps.timeline.get_state();
-                action::save_sequence_bank(state.sequence_bank, state.sequence_names,
-                                           filepath);
-                return minfo("Sequence Bank Saved to " +
-                             single_quote(filepath.getFullPathName().toStdString()));
+                auto const &state = ps.timeline.peek_state().sequencer;
+                ps.worker.start("Save Sequence Bank",
+                                [sb = state.sequence_bank, names = state.sequence_names,
+                                 filepath, binary](TaskContext &ctx) {
+                                    auto const write = [&](juce::File const &file) {
+                                        if (binary)
+                                        {
+                                            action::save_sequence_bank_binary(sb, names,
+                                                                              file);
+                                        }
+                                        else
+                                        {
+                                            action::save_sequence_bank(sb, names, file);
+                                        }
+                                    };
+                                    if (!write_unless_cancelled(filepath, ctx, write))
+                                    {
+                                        return TaskResult{}; // Never applied.
+                                    }
+                                    return TaskResult{[filepath](PluginState &) {
+                                        return minfo(
+                                            "Sequence Bank Saved to " +
+                                            single_quote(filepath.getFullPathName()
+                                                             .toStdString()));
+                                    }};
+                                });
+                return minfo("Saving Sequence Bank...");
             }));
 
         head.add(std::move(save));
     }
 
+    {
+        auto export_ = cmd_group("export");
+
+        // export sequenceBank
+        export_->add(cmd(
+            signature("sequenceBank", arg<std::string>("filename")),
+            "Export the entire sequence bank to a JSON file, for reading or editing "
+            "outside of the plugin. The file will be located in the library's current "
+            "sequence directory. Do not include the .json extension in the filename "
+            "you provide.",
+            [](PS &ps, std::string const &filename) {
+                auto const cd = ps.current_sequence_directory;
+                if (!cd.isDirectory())
+                {
+                    return merror("Invalid Current Sequence Directory");
+                }
+
+                auto const filepath = cd.getChildFile(filename + ".json");
+                auto const &state = ps.timeline.peek_state().sequencer;
+                ps.worker.start("Export Sequence Bank",
+                                [sb = state.sequence_bank, names = state.sequence_names,
+                                 filepath](TaskContext &ctx) {
+                                    auto const write = [&](juce::File const &file) {
+                                        action::save_sequence_bank(sb, names, file);
+                                    };
+                                    if (!write_unless_cancelled(filepath, ctx, write))
+                                    {
+                                        return TaskResult{}; // Never applied.
+                                    }
+                                    return TaskResult{[filepath](PluginState &) {
+                                        return minfo(
+                                            "Sequence Bank Exported to " +
+                                            single_quote(filepath.getFullPathName()
+                                                             .toStdString()));
+                                    }};
+                                });
+                return minfo("Exporting Sequence Bank...");
+            }));
+
+        // export messageLog
+        export_->add(cmd(
+            signature("messageLog", arg<std::string>("filename")),
+            "Write every message held by the MessageLog to a text file in the library "
+            "directory, whatever its level filter. Do not include the .txt extension "
+            "in the filename you provide.",
+            [](PS &ps, std::string const &filename) {
+                // The MessageLog belongs to the editor, it is absent while closed.
+                auto const text = ps.on_message_log_text_request();
+                if (!text.has_value())
+                {
+                    return merror("MessageLog Not Available");
+                }
+
+                auto const filepath =
+                    get_user_library_directory().getChildFile(filename + ".txt");
+                if (!filepath.replaceWithText(*text))
+                {
+                    return merror(
+                        "Unable to Write " +
+                        single_quote(filepath.getFullPathName().toStdString()));
+                }
+                return minfo("MessageLog Exported to " +
+                             single_quote(filepath.getFullPathName().toStdString()));
+            }));
+
+        head.add(std::move(export_));
+    }
+
+    {
+        auto import_ = cmd_group("import");
+
+        // import sequenceBank
+        import_->add(cmd(
+            signature("sequenceBank", arg<std::string>("filename")),
+            "Import the entire sequence bank from a JSON file created by `export "
+            "sequenceBank`. filename must be located in the library's currently set "
+            "sequence directory. Do not include the .json extension in the filename "
+            "you provide.",
+            [](PS &ps, std::string const &filename) {
+                auto const cd = ps.current_sequence_directory;
+                if (!cd.isDirectory())
+                {
+                    return merror("Invalid Current Sequence Directory");
+                }
+
+                return start_sequence_bank_load(ps,
+                                                cd.getChildFile(filename + ".json"));
+            }));
+
+        head.add(std::move(import_));
+    }
+
     // libraryDirectory
     head.add(cmd(signature("libraryDirectory"),
                  "Display the path to the directory where the user library is stored.",
@@ -680,9 +1046,10 @@ auto create_command_tree() -> XenCommandTree
                              return minfo("Scale Set to " + name + ".");
                          }
                          // Scale names are stored as all lower case.
+                         auto const scales = ps.resources->scales();
                          auto const at = std::ranges::find(
-                             ps.scales, name, [](Scale const &s) { return s.name; });
-                         if (at != std::end(ps.scales))
+                             *scales, name, [](Scale const &s) { return s.name; });
+                         if (at != std::end(*scales))
                          {
                              auto state = ps.timeline.get_state();
                              state.sequencer.scale = *at;
@@ -796,6 +1163,18 @@ auto create_command_tree() -> XenCommandTree
                 return minfo("Weights Set");
             }));
 
+        // set messageLogLevel
+        set->add(cmd(
+            signature("messageLogLevel", arg<MessageLevel>("level")),
+            "Only display messages at or above level in the MessageLog: debug, info, "
+            "warning or error. Hidden messages are still kept.",
+            [](PS &ps, MessageLevel level) {
+                ps.on_message_log_filter_request(level);
+                auto oss = std::ostringstream{};
+                oss << level;
+                return mdebug("MessageLog Level Set to " + single_quote(oss.str()));
+            }));
+
         head.add(std::move(set));
     }
 
@@ -965,12 +1344,13 @@ auto create_command_tree() -> XenCommandTree
                        "Move Forward/Backward through the loaded Scales.",
                        [](PS &ps, int amount) {
                            auto [seq, aux] = ps.timeline.get_state();
+                           auto const scales = ps.resources->scales();
                            auto const index = action::shift_scale_index(
-                               ps.scale_shift_index, amount, ps.scales.size());
+                               ps.scale_shift_index, amount, scales->size());
                            ps.scale_shift_index = index;
-                           if (index.has_value() && *index < ps.scales.size())
+                           if (index.has_value() && *index < scales->size())
                            {
-                               seq.scale = ps.scales[*index];
+                               seq.scale = (*scales)[*index];
                            }
                            else
                            {
@@ -1021,6 +1401,7 @@ auto create_command_tree() -> XenCommandTree
                     return merror("Invalid direction, must be 1 or -1");
                 }
                 auto [seq, aux] = ps.timeline.get_state();
+                auto const scales = ps.resources->scales();
                 auto &td = seq.scale_translate_direction;
                 if (seq.scale.has_value())
                 {
@@ -1033,11 +1414,11 @@ auto create_command_tree() -> XenCommandTree
                              direction == -1))
                         {
                             auto const index = action::shift_scale_index(
-                                ps.scale_shift_index, direction, ps.scales.size());
+                                ps.scale_shift_index, direction, scales->size());
                             ps.scale_shift_index = index;
-                            if (index.has_value() && *index < ps.scales.size())
+                            if (index.has_value() && *index < scales->size())
                             {
-                                seq.scale = ps.scales[*index];
+                                seq.scale = (*scales)[*index];
                                 if (direction == -1)
                                 {
                                     seq.scale->mode = seq.scale->intervals.size();
@@ -1050,10 +1431,10 @@ auto create_command_tree() -> XenCommandTree
                         }
                     }
                 }
-                else if (!ps.scales.empty()) // Current is chromatic
+                else if (!scales->empty()) // Current is chromatic
                 {
-                    auto const index = direction == 1 ? 0 : ps.scales.size() - 1;
-                    seq.scale = ps.scales[index];
+                    auto const index = direction == 1 ? 0 : scales->size() - 1;
+                    seq.scale = (*scales)[index];
                     td = TranslateDirection::Up;
                 }
 
@@ -1073,11 +1454,9 @@ auto create_command_tree() -> XenCommandTree
                                      arg<int>("max", 12)),
                            "Set the pitch of any selected Notes to a random value.",
                            [](PS &ps, Pattern const &pattern, int min, int max) {
-                               increment_state(ps.timeline,
-                                               &sequence::modify::randomize_pitch,
-                                               pattern, min, max);
-                               ps.timeline.set_commit_flag();
-                               return minfo("Randomized Pitch");
+                               return randomize_selected(
+                                   ps, "Pitch", &sequence::modify::randomize_pitch,
+                                   pattern, min, max);
                            }));
 
         // randomize velocity
@@ -1085,11 +1464,9 @@ auto create_command_tree() -> XenCommandTree
                                      arg<float>("min", 0.01f), arg<float>("max", 1.f)),
                            "Set the velocity of any selected Notes to a random value.",
                            [](PS &ps, Pattern const &pattern, float min, float max) {
-                               increment_state(ps.timeline,
-                                               &sequence::modify::randomize_velocity,
-                                               pattern, min, max);
-                               ps.timeline.set_commit_flag();
-                               return minfo("Randomized Velocity");
+                               return randomize_selected(
+                                   ps, "Velocity", &sequence::modify::randomize_velocity,
+                                   pattern, min, max);
                            }));
 
         // randomize delay
@@ -1097,11 +1474,9 @@ auto create_command_tree() -> XenCommandTree
                                      arg<float>("max", 0.95f)),
                            "Set the delay of any selected Notes to a random value.",
                            [](PS &ps, Pattern const &pattern, float min, float max) {
-                               increment_state(ps.timeline,
-                                               &sequence::modify::randomize_delay,
-                                               pattern, min, max);
-                               ps.timeline.set_commit_flag();
-                               return minfo("Randomized Delay");
+                               return randomize_selected(
+                                   ps, "Delay", &sequence::modify::randomize_delay,
+                                   pattern, min, max);
                            }));
 
         // randomize gate
@@ -1109,11 +1484,9 @@ auto create_command_tree() -> XenCommandTree
                                      arg<float>("max", 0.95f)),
                            "Set the gate of any selected Notes to a random value.",
                            [](PS &ps, Pattern const &pattern, float min, float max) {
-                               increment_state(ps.timeline,
-                                               &sequence::modify::randomize_gate,
-                                               pattern, min, max);
-                               ps.timeline.set_commit_flag();
-                               return minfo("Randomized Gate");
+                               return randomize_selected(
+                                   ps, "Gate", &sequence::modify::randomize_gate,
+                                   pattern, min, max);
                            }));
 
         head.add(std::move(randomize));
@@ -1233,6 +1606,7 @@ auto create_command_tree() -> XenCommandTree
         "is applied in order to child cells in the selection.",
         [](PS &ps, Pattern const &pattern, std::string chord_name, int inversion) {
             auto [state, aux] = ps.timeline.get_state();
+            auto const chords = ps.resources->chords();
 
             bool const starting_new_chain =
                 aux.selected != aux.arp_state.selected ||
@@ -1248,13 +1622,13 @@ auto create_command_tree() -> XenCommandTree
             if (chord_name == "cycle" && inversion != -1)
             {
                 chord_name =
-                    find_next_chord(ps.chords, aux.arp_state.previous_chord_name).name;
-                auto const chord = find_chord(ps.chords, chord_name);
+                    find_next_chord(*chords, aux.arp_state.previous_chord_name).name;
+                auto const chord = find_chord(*chords, chord_name);
                 inversion = std::min(inversion, (int)chord.intervals.size() - 1);
             }
             else if (chord_name != "cycle" && inversion == -1)
             {
-                auto const chord = find_chord(ps.chords, chord_name);
+                auto const chord = find_chord(*chords, chord_name);
                 inversion =
                     increment_inversion(chord, aux.arp_state.previous_inversion);
             }
@@ -1267,13 +1641,13 @@ auto create_command_tree() -> XenCommandTree
                 }
                 else
                 {
-                    auto const chord = find_chord(ps.chords, chord_name);
+                    auto const chord = find_chord(*chords, chord_name);
                     inversion =
                         increment_inversion(chord, aux.arp_state.previous_inversion);
                 }
                 if (inversion == 0)
                 {
-                    chord_name = find_next_chord(ps.chords, chord_name).name;
+                    chord_name = find_next_chord(*chords, chord_name).name;
                 }
             }
 
@@ -1286,7 +1660,7 @@ auto create_command_tree() -> XenCommandTree
             aux.selected = aux.arp_state.selected;
 
             auto &selected = get_selected_cell(state.sequence_bank, aux.selected);
-            auto const chord = find_chord(ps.chords, chord_name);
+            auto const chord = find_chord(*chords, chord_name);
             auto const intervals =
                 invert_chord(chord, inversion, state.tuning.intervals.size());
             selected = action::arp(selected, pattern, intervals);
@@ -1340,4 +1714,154 @@ auto create_command_tree() -> XenCommandTree
     return head;
 }
 
-} // namespace xen
\ No newline at end of file
+auto execute_commands(XenCommandTree const &tree, PluginState &ps,
+                      std::vector<PreparedCommand> const &commands,
+                      std::vector<PreparedCommand> &previous_commands)
+    -> std::pair<MessageLevel, std::string>
+{
+    auto const is_again = [](PreparedCommand const &command) {
+        return to_lower(command.text) == "again";
+    };
+
+    // Anything that could modify state is rejected while the worker is busy, the
+    // worker's result is based on a snapshot and would overwrite the change.
+    auto const check_not_busy = [&ps](PreparedCommand const &command) {
+        if (!ps.worker.is_busy())
+        {
+            return;
+        }
+        auto const &words = command.input.words;
+        auto const id = words.empty() ? std::string{} : to_lower(words.front());
+        auto const group_id = words.size() < 2 ? id : id + ' ' + to_lower(words[1]);
+        if (std::ranges::find(commands_allowed_while_busy, id) ==
+                std::cend(commands_allowed_while_busy) &&
+            std::ranges::find(commands_allowed_while_busy, group_id) ==
+                std::cend(commands_allowed_while_busy))
+        {
+            throw std::runtime_error{"Busy: " + ps.worker.description() +
+                                     " in progress, use 'cancel' to stop it."};
+        }
+    };
+
+    auto const was_busy = ps.worker.is_busy();
+
+    try
+    {
+        try
+        {
+            // Expand 'again' so that it is replaced with the full command list.
+            auto expanded = std::vector<PreparedCommand>{};
+            for (auto const &command : commands)
+            {
+                if (is_again(command))
+                {
+                    check_not_busy(command);
+                    expanded.insert(std::end(expanded), std::cbegin(previous_commands),
+                                    std::cend(previous_commands));
+                }
+                else
+                {
+                    expanded.push_back(command);
+                }
+            }
+
+            auto status = std::pair<MessageLevel, std::string>{MessageLevel::Debug, ""};
+            for (auto iter = std::cbegin(expanded); iter != std::cend(expanded); ++iter)
+            {
+                check_not_busy(*iter);
+                status = tree.execute(ps, iter->input);
+
+                // The rest of the list may depend on the task's result, so it is run
+                // along with that result. 'again' is already expanded, so it still
+                // repeats the whole list.
+                if (!was_busy && ps.worker.is_busy())
+                {
+                    auto rest = std::vector(std::next(iter), std::cend(expanded));
+                    if (!rest.empty())
+                    {
+                        ps.worker.then(
+                            [&tree, rest = std::move(rest)](PluginState &ps) {
+                                auto unused = std::vector<PreparedCommand>{};
+                                return execute_commands(tree, ps, rest, unused);
+                            });
+                    }
+                    break;
+                }
+            }
+
+            auto const started_task = !was_busy && ps.worker.is_busy();
+            if (ps.timeline.get_commit_flag() || started_task)
+            {
+                previous_commands = std::move(expanded);
+            }
+            if (ps.timeline.get_commit_flag())
+            {
+                ps.timeline.commit();
+            }
+            return status;
+        }
+        catch (...)
+        {
+            // FIXME: This roundabout way can set an invalid selection if a string of
+            // commands is executed that includes splitting and movement. But it isn't a
+            // huge deal and this behaviour is more desirable that without this patch.
+
+            // A task started by this command list is part of the failed change.
+            if (!was_busy)
+            {
+                ps.worker.cancel();
+            }
+
+            // Roundabout way to revert partial changes but keep the selected state.
+            auto aux = ps.timeline.get_state().aux;
+            ps.timeline.reset_stage();
+            auto state = ps.timeline.get_state();
+            state.aux = std::move(aux);
+            ps.timeline.stage(std::move(state));
+            throw; // rethrow so you can return proper message without duplicating above
+        }
+    }
+    catch (utility::ErrorNoMatch const &)
+    {
+        auto texts = std::vector<std::string>{};
+        for (auto const &command : commands)
+        {
+            texts.push_back(command.text);
+        }
+        return {MessageLevel::Error, "Command not found: " + join(texts, ';')};
+    }
+    catch (std::exception const &e)
+    {
+        return {MessageLevel::Error, e.what()};
+    }
+    catch (...)
+    {
+        return {MessageLevel::Error, "Unknown error"};
+    }
+}
+
+auto apply_task_result(PluginState &ps, TaskResult const &result)
+    -> std::pair<MessageLevel, std::string>
+{
+    try
+    {
+        auto status = result(ps);
+        if (ps.timeline.get_commit_flag())
+        {
+            ps.timeline.commit();
+        }
+        return status;
+    }
+    catch (std::exception const &e)
+    {
+        ps.timeline.reset_stage();
+        return {MessageLevel::Error, e.what()};
+    }
+    catch (...)
+    {
+        ps.timeline.reset_stage();
+        return {MessageLevel::Error, "Unknown error"};
+    }
+}
+
+} // namespace xen
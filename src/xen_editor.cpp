@@ -8,12 +8,13 @@
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include <xen/command.hpp>
 #include <xen/gui/themes.hpp>
-#include <xen/guide_text.hpp>
+#include <xen/completion_index.hpp>
 #include <xen/key_core.hpp>
 #include <xen/scale.hpp>
 #include <xen/state.hpp>
@@ -66,7 +67,7 @@ XenEditor::XenEditor(XenProcessor &p, int width, int height)
                 auto const lock = std::lock_guard{p.plugin_state.shared.theme_mtx};
                 return p.plugin_state.shared.theme;
             }();
-            p.plugin_state.laf = gui::make_laf(theme);
+            p.plugin_state.laf = p.plugin_state.resources->look_and_feel(theme);
         }
         this->setLookAndFeel(p.plugin_state.laf.get());
     }
@@ -77,16 +78,22 @@ XenEditor::XenEditor(XenProcessor &p, int width, int height)
             this->execute_command_string(command_string);
         });
 
+    // CommandBar Entered Command, ranks it higher in completions.
+    plugin_window.bottom_bar.command_bar.on_command_entered.connect(
+        [this](std::string const &command_string) {
+            processor_.completion_index.record_use(command_string);
+        });
+
     // CommandBar Guide Text Request
     plugin_window.bottom_bar.command_bar.on_guide_text_request.connect(
         [this](std::string const &partial_command) -> std::string {
-            return generate_guide_text(processor_.command_tree, partial_command);
+            return processor_.completion_index.guide_text(partial_command);
         });
 
-    // CommandBar ID Completion Request
-    plugin_window.bottom_bar.command_bar.on_complete_id_request.connect(
+    // CommandBar Completion Request
+    plugin_window.bottom_bar.command_bar.on_complete_request.connect(
         [this](std::string const &partial_command) -> std::string {
-            return complete_id(processor_.command_tree, partial_command);
+            return processor_.completion_index.complete(partial_command).value_or("");
         });
 
     // Sequence File Selected
@@ -132,7 +139,7 @@ XenEditor::XenEditor(XenProcessor &p, int width, int height)
 
     { // Theme Changed
         auto slot = sl::Slot<void(gui::Theme const &)>{[&](gui::Theme const &theme) {
-            p.plugin_state.laf = gui::make_laf(theme);
+            p.plugin_state.laf = p.plugin_state.resources->look_and_feel(theme);
             this->setLookAndFeel(p.plugin_state.laf.get());
         }};
         slot.track(lifetime_);
@@ -158,9 +165,33 @@ XenEditor::XenEditor(XenProcessor &p, int width, int height)
         p.plugin_state.on_show_request.connect(slot);
     }
 
+    { // Library Search Request
+        auto slot =
+            sl::Slot<void(std::string const &)>{[this](std::string const &query) {
+                plugin_window.center_component.library_view.set_filter(query);
+            }};
+        slot.track(lifetime_);
+        p.plugin_state.on_search_request.connect(slot);
+    }
+
+    { // MessageLog Filter Request
+        auto slot = sl::Slot<void(MessageLevel)>{[this](MessageLevel level) {
+            plugin_window.center_component.message_log.set_level_filter(level);
+        }};
+        slot.track(lifetime_);
+        p.plugin_state.on_message_log_filter_request.connect(slot);
+    }
+
+    { // MessageLog Text Request
+        auto slot = sl::Slot<std::string()>{
+            [this] { return plugin_window.center_component.message_log.to_text(); }};
+        slot.track(lifetime_);
+        p.plugin_state.on_message_log_text_request.connect(slot);
+    }
+
     { // Load Keys File Request
         auto slot = sl::Slot<void()>{[this] {
-            this->update_key_listeners(get_system_keys_file(), get_user_keys_file());
+            this->update_key_listeners(get_user_keys_file());
         }};
         slot.track(lifetime_);
         auto const lock =
@@ -185,7 +216,7 @@ XenEditor::XenEditor(XenProcessor &p, int width, int height)
 
     try
     {
-        this->update_key_listeners(get_system_keys_file(), get_user_keys_file());
+        this->update_key_listeners(get_user_keys_file());
     }
     catch (std::exception const &e)
     {
@@ -196,6 +227,18 @@ XenEditor::XenEditor(XenProcessor &p, int width, int height)
     }
 
     this->execute_command_string("welcome");
+
+    if (processor_.has_recoverable_autosave())
+    {
+        this->warn_recoverable_autosave();
+    }
+}
+
+void XenEditor::warn_recoverable_autosave()
+{
+    this->report_status(MessageLevel::Warning,
+                        "Found an autosave from a session that did not close "
+                        "normally, run `recover` to restore it.");
 }
 
 auto XenEditor::createKeyboardFocusTraverser()
@@ -209,13 +252,22 @@ void XenEditor::update()
     plugin_window.update(processor_.plugin_state);
 }
 
-void XenEditor::update_key_listeners(juce::File const &default_keys,
-                                     juce::File const &user_keys)
+void XenEditor::update_key_listeners(juce::File const &user_keys)
 {
+    auto const key_cores = processor_.plugin_state.resources->key_cores(user_keys);
     auto previous_listeners = std::move(key_config_listeners_);
     key_config_listeners_ =
-        build_key_listeners(default_keys, user_keys, processor_.plugin_state.timeline);
+        build_key_listeners(key_cores, processor_.plugin_state.timeline);
     this->set_key_listeners(std::move(previous_listeners), key_config_listeners_);
+
+    for (auto const &[component_name, key_core] : *key_cores)
+    {
+        for (auto const &message : key_core.skipped())
+        {
+            this->report_status(MessageLevel::Warning,
+                                "Check `user_keys.yml`: " + message);
+        }
+    }
 }
 
 void XenEditor::resized()
@@ -228,6 +280,17 @@ void XenEditor::resized()
 void XenEditor::execute_command_string(std::string const &command_string)
 {
     auto const [level, message] = processor_.execute_command_string(command_string);
+    this->report_status(level, message);
+}
+
+void XenEditor::execute_commands(std::vector<PreparedCommand> const &commands)
+{
+    auto const [level, message] = processor_.execute_commands(commands);
+    this->report_status(level, message);
+}
+
+void XenEditor::report_status(MessageLevel level, std::string const &message)
+{
     if (level != MessageLevel::Error)
     {
         this->update();
@@ -253,9 +316,10 @@ void XenEditor::set_key_listeners(
     auto const add_listener = [&](juce::Component &component) {
         auto const id = to_lower(component.getComponentID().toStdString());
         component.addKeyListener(&new_listeners.at(id));
-        new_listeners.at(id).on_command.connect([&](std::string const &command_string) {
-            this->execute_command_string(command_string);
-        });
+        new_listeners.at(id).on_command.connect(
+            [&](std::vector<PreparedCommand> const &commands) {
+                this->execute_commands(commands);
+            });
     };
 
     try
@@ -3,40 +3,98 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include <sequence/measure.hpp>
 
+#include <xen/autosave.hpp>
+#include <xen/background_worker.hpp>
 #include <xen/command.hpp>
+#include <xen/message_level.hpp>
 #include <xen/midi.hpp>
 #include <xen/serialize.hpp>
+#include <xen/shared_resources.hpp>
 #include <xen/state.hpp>
 #include <xen/string_manip.hpp>
-#include <xen/user_directory.hpp>
 #include <xen/utility.hpp>
 #include <xen/xen_command_tree.hpp>
 #include <xen/xen_editor.hpp>
 
+namespace
+{
+
+/**
+ * The instance ids of the XenProcessors in this process.
+ */
+struct InstanceIds
+{
+    std::mutex mtx;
+    std::set<std::string> ids;
+};
+
+[[nodiscard]] auto instance_ids() -> InstanceIds &
+{
+    static auto instance = InstanceIds{};
+    return instance;
+}
+
+/**
+ * Claim \p id for one instance, or a new id if it is empty or already claimed, such
+ * as when the host duplicates a track.
+ */
+[[nodiscard]] auto claim_instance_id(std::string id) -> std::string
+{
+    auto &instances = instance_ids();
+    auto const lock = std::lock_guard{instances.mtx};
+    while (id.empty() || instances.ids.contains(id))
+    {
+        id = juce::Uuid{}.toString().toStdString();
+    }
+    instances.ids.insert(id);
+    return id;
+}
+
+void release_instance_id(std::string const &id)
+{
+    auto &instances = instance_ids();
+    auto const lock = std::lock_guard{instances.mtx};
+    instances.ids.erase(id);
+}
+
+} // namespace
+
 namespace xen
 {
 
 XenProcessor::XenProcessor()
     : plugin_state{.timeline = XenTimeline{{.sequencer = {}, .aux = {}}}},
-      command_tree{create_command_tree()}
+      command_tree{create_command_tree()}, completion_index{command_tree}
 {
-    initialize_demo_files();
+    plugin_state.instance_id = claim_instance_id({});
 
     // Send initial state to Audio Thread
-    pending_state_update.set(plugin_state.timeline.get_state().sequencer);
+    this->send_state_update("Initial State");
 
-    this->execute_command_string("load scales");
-    this->execute_command_string("load chords");
+    // The built-in Scales and Chords are available at once, the user files are loaded
+    // by SharedResources in the background.
+    plugin_state.resources->addChangeListener(this);
+}
+
+XenProcessor::~XenProcessor()
+{
+    plugin_state.resources->removeChangeListener(this);
+    release_instance_id(plugin_state.instance_id);
 }
 
 void XenProcessor::processBlock(juce::AudioBuffer<float> &buffer,
@@ -45,6 +103,7 @@ void XenProcessor::processBlock(juce::AudioBuffer<float> &buffer,
     buffer.clear();
 
     bool update_needed = false;
+    bool daw_changed = false;
 
     { // Update DAWState
         auto const bpm = [this] {
@@ -60,9 +119,10 @@ void XenProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 
         auto const sample_rate = static_cast<std::uint32_t>(this->getSampleRate());
 
-        update_needed = !utility::compare_within_tolerance(audio_thread_state_.daw.bpm,
-                                                           bpm, 0.0001f) ||
-                        audio_thread_state_.daw.sample_rate != sample_rate;
+        daw_changed = !utility::compare_within_tolerance(audio_thread_state_.daw.bpm,
+                                                         bpm, 0.0001f) ||
+                      audio_thread_state_.daw.sample_rate != sample_rate;
+        update_needed = daw_changed;
 
         audio_thread_state_.daw = DAWState{
             .bpm = bpm,
@@ -91,11 +151,18 @@ void XenProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 
     audio_thread_state_.accumulated_sample_count += (SampleCount)buffer.getNumSamples();
 
-    audio_thread_state_for_gui.write({
-        .daw = audio_thread_state_.daw,
-        .note_start_times =
-            audio_thread_state_.midi_engine.get_trigger_note_start_times(),
-    });
+    // The GUI only animates while the generation changes or triggers are active, so
+    // an unchanged state is not republished.
+    auto const note_start_times =
+        audio_thread_state_.midi_engine.get_trigger_note_start_times();
+    auto &gui_state = audio_thread_state_.published_for_gui;
+    if (daw_changed || note_start_times != gui_state.note_start_times)
+    {
+        gui_state.daw = audio_thread_state_.daw;
+        gui_state.note_start_times = note_start_times;
+        ++gui_state.generation;
+        audio_thread_state_for_gui.write(gui_state);
+    }
 }
 
 void XenProcessor::processBlock(juce::AudioBuffer<double> &buffer,
@@ -116,10 +183,9 @@ void XenProcessor::getStateInformation(juce::MemoryBlock &dest_data)
 {
     try
     {
-        auto const json_str =
-            serialize_plugin(plugin_state.timeline.get_state().sequencer);
-        dest_data.setSize(json_str.size());
-        std::memcpy(dest_data.getData(), json_str.data(), json_str.size());
+        auto const json_str = state_blob_cache_.get();
+        dest_data.setSize(json_str->size());
+        std::memcpy(dest_data.getData(), json_str->data(), json_str->size());
     }
     catch (std::exception const &e)
     {
@@ -133,10 +199,34 @@ void XenProcessor::setStateInformation(void const *data, int sizeInBytes)
 {
     auto const json_str =
         std::string(static_cast<char const *>(data), (std::size_t)sizeInBytes);
-    auto state = deserialize_plugin(json_str);
+    auto [state, instance_id] = deserialize_host_state(json_str);
+
+    // States saved by earlier versions have no id, the current one is kept.
+    if (!instance_id.empty() && instance_id != plugin_state.instance_id)
+    {
+        release_instance_id(plugin_state.instance_id);
+        plugin_state.instance_id = claim_instance_id(std::move(instance_id));
+    }
+
+    // Searching the autosave directory waits on the disk, the editor is warned once
+    // the result is handed back to handleAsyncUpdate.
+    plugin_state.recoverable_autosave = false;
+    autosave_.find_recoverable(
+        plugin_state.instance_id, [this, id = plugin_state.instance_id](bool found) {
+            {
+                auto const lock = std::lock_guard{autosave_search_.mtx};
+                autosave_search_.instance_id = id;
+                autosave_search_.found = found;
+            }
+            this->triggerAsyncUpdate();
+        });
+
+    // A running task was started against the replaced state, its result is stale.
+    plugin_state.worker.cancel();
+
     plugin_state.timeline.stage({std::move(state), {}});
     plugin_state.timeline.commit();
-    pending_state_update.set(plugin_state.timeline.get_state().sequencer);
+    this->send_state_update("Host State Restored");
     auto *const editor_base = this->getActiveEditor();
     if (editor_base != nullptr)
     {
@@ -153,64 +243,124 @@ auto XenProcessor::execute_command_string(std::string const &command_string)
 {
     try
     {
-        auto &ps = plugin_state;
-        try
+        return this->execute_commands(prepare_command_string(command_string));
+    }
+    catch (std::exception const &e)
+    {
+        return {MessageLevel::Error, e.what()};
+    }
+    catch (...)
+    {
+        return {MessageLevel::Error, "Unknown error"};
+    }
+}
+
+auto XenProcessor::execute_commands(std::vector<PreparedCommand> const &commands)
+    -> std::pair<MessageLevel, std::string>
+{
+    auto status =
+        xen::execute_commands(command_tree, plugin_state, commands, previous_commands_);
+
+    auto change = std::string{};
+    for (auto const &command : commands)
+    {
+        change += (change.empty() ? "" : "; ") + command.text;
+    }
+    this->send_state_update(change);
+
+    if (plugin_state.worker.is_busy() && !this->isTimerRunning())
+    {
+        this->startTimerHz(30);
+    }
+
+    return status;
+}
+
+auto XenProcessor::has_recoverable_autosave() const -> bool
+{
+    return plugin_state.recoverable_autosave;
+}
+
+void XenProcessor::timerCallback()
+{
+    auto const description = plugin_state.worker.description();
+    auto const result = plugin_state.worker.take_result();
+    if (result.has_value())
+    {
+        this->stopTimer();
+        auto const status = apply_task_result(plugin_state, *result);
+        this->send_state_update(description);
+        this->report_task_status(status);
+
+        // A deferred command may have started the next task.
+        if (plugin_state.worker.is_busy())
         {
-            auto commands = split(command_string, ';');
-            auto status = std::pair<MessageLevel, std::string>{MessageLevel::Debug, ""};
-            for (auto &command : commands)
-            {
-                command = minimize_spaces(command);
-                if (to_lower(command) == "again")
-                {
-                    command = previous_command_string_;
-                }
-                if (command.empty())
-                {
-                    continue;
-                }
-                status = command_tree.execute(ps, split_input(command));
-            }
-            if (ps.timeline.get_commit_flag())
-            {
-                // join() so that 'again' is replaced with the full command string
-                previous_command_string_ = join(commands, ';');
-                ps.timeline.commit();
-            }
-            if (auto const id = ps.timeline.get_current_commit_id();
-                id != previous_commit_id_)
-            {
-                previous_commit_id_ = id;
-                pending_state_update.set(ps.timeline.get_state().sequencer);
-            }
-            return status;
+            this->startTimerHz(30);
+        }
+        return;
+    }
+
+    if (!plugin_state.worker.is_busy())
+    {
+        this->stopTimer();
+    }
+}
+
+void XenProcessor::changeListenerCallback(juce::ChangeBroadcaster *)
+{
+    if (auto *const editor = dynamic_cast<gui::XenEditor *>(this->getActiveEditor());
+        editor != nullptr)
+    {
+        editor->update();
+        if (auto const error = plugin_state.resources->library_error())
+        {
+            editor->report_status(MessageLevel::Error,
+                                  "Failed to Load User Scales and Chords: " + *error);
         }
-        catch (...)
+    }
+}
+
+void XenProcessor::handleAsyncUpdate()
+{
+    auto found = false;
+    {
+        auto const lock = std::lock_guard{autosave_search_.mtx};
+        if (autosave_search_.instance_id != plugin_state.instance_id)
         {
-            // FIXME: This roundabout way can set an invalid selection if a string of
-            // commands is executed that includes splitting and movement. But it isn't a
-            // huge deal and this behaviour is more desirable that without this patch.
-
-            // Roundabout way to revert partial changes but keep the selected state.
-            auto aux = ps.timeline.get_state().aux;
-            ps.timeline.reset_stage();
-            auto state = ps.timeline.get_state();
-            state.aux = std::move(aux);
-            ps.timeline.stage(std::move(state));
-            throw; // rethrow so you can return proper message without duplicating above
+            return; // Stale, the host has restored another state since.
         }
+        autosave_search_.instance_id = std::nullopt;
+        found = autosave_search_.found;
     }
-    catch (utility::ErrorNoMatch const &)
+
+    plugin_state.recoverable_autosave = found;
+    if (auto *const editor = dynamic_cast<gui::XenEditor *>(this->getActiveEditor());
+        editor != nullptr && found)
     {
-        return {MessageLevel::Error, "Command not found: " + command_string};
+        editor->warn_recoverable_autosave();
     }
-    catch (std::exception const &e)
+}
+
+void XenProcessor::send_state_update(std::string const &change)
+{
+    if (auto const id = plugin_state.timeline.get_current_commit_id();
+        id != previous_commit_id_)
     {
-        return {MessageLevel::Error, e.what()};
+        previous_commit_id_ = id;
+        auto state = std::make_shared<SequencerState const>(
+            plugin_state.timeline.peek_state().sequencer);
+        pending_state_update.set(*state);
+        state_blob_cache_.update(id, state, plugin_state.instance_id);
+        autosave_.append(change, std::move(state), plugin_state.instance_id);
     }
-    catch (...)
+}
+
+void XenProcessor::report_task_status(std::pair<MessageLevel, std::string> const &status)
+{
+    if (auto *const editor = dynamic_cast<gui::XenEditor *>(this->getActiveEditor());
+        editor != nullptr)
     {
-        return {MessageLevel::Error, "Unknown error"};
+        editor->report_status(status.first, status.second);
     }
 }
 
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <juce_core/juce_core.h>
+
+#include <xen/autosave.hpp>
+#include <xen/state.hpp>
+
+using namespace xen;
+
+namespace
+{
+
+/**
+ * An empty directory, deleted along with its contents when this is destroyed.
+ */
+struct TemporaryDirectory
+{
+    juce::File directory =
+        juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getChildFile("XenTests-" + juce::Uuid{}.toString());
+
+    TemporaryDirectory()
+    {
+        REQUIRE(directory.createDirectory().wasOk());
+    }
+
+    ~TemporaryDirectory()
+    {
+        directory.deleteRecursively();
+    }
+};
+
+[[nodiscard]] auto count_journals(juce::File const &directory) -> int
+{
+    return directory.findChildFiles(juce::File::findFiles, false, "*.journal").size();
+}
+
+/**
+ * The one journal in \p directory.
+ */
+[[nodiscard]] auto find_journal(juce::File const &directory) -> juce::File
+{
+    auto const journals =
+        directory.findChildFiles(juce::File::findFiles, false, "*.journal");
+    REQUIRE(journals.size() == 1);
+    return journals[0];
+}
+
+/**
+ * Wait for the background thread of an Autosave writing to \p directory to write
+ * \p command to its journal.
+ */
+[[nodiscard]] auto wait_for_commit(juce::File const &directory,
+                                   std::string const &command) -> RecoveredSession
+{
+    auto const timeout = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (std::chrono::steady_clock::now() < timeout)
+    {
+        try
+        {
+            if (count_journals(directory) == 1 &&
+                read_journal(find_journal(directory)).last_command == command)
+            {
+                break;
+            }
+        }
+        catch (std::runtime_error const &)
+        {
+            // Not written yet.
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+
+    auto session = read_journal(find_journal(directory));
+    REQUIRE(session.last_command == command);
+    return session;
+}
+
+[[nodiscard]] auto count_lines(juce::File const &journal) -> std::size_t
+{
+    auto const text = journal.loadFileAsString().toStdString();
+    return static_cast<std::size_t>(std::ranges::count(text, '\n'));
+}
+
+} // namespace
+
+TEST_CASE("Autosave journal records each commit", "[Autosave]")
+{
+    auto const temp = TemporaryDirectory{};
+    auto state = SequencerState{};
+
+    {
+        auto autosave = Autosave{[&temp] { return temp.directory; }};
+        auto const commit = [&](std::string const &command) {
+            autosave.append(command, std::make_shared<SequencerState const>(state),
+                            "instance");
+        };
+
+        commit("first");
+        CHECK(wait_for_commit(temp.directory, "first").state == state);
+
+        // Bank and name changes are recorded as deltas from the previous line.
+        state.sequence_bank[3].cell.weight = 2.f;
+        state.sequence_names[3] = "Verse";
+        commit("bank");
+        CHECK(wait_for_commit(temp.directory, "bank").state == state);
+
+        // Anything else is recorded with a snapshot.
+        state.base_frequency = 432.f;
+        commit("snapshot");
+        state.sequence_bank[0].cell.weight = 3.f;
+        commit("after snapshot");
+        CHECK(wait_for_commit(temp.directory, "after snapshot").state == state);
+        CHECK(count_lines(find_journal(temp.directory)) == 4);
+    }
+
+    // The journal of a session that closed normally is not kept.
+    CHECK(count_journals(temp.directory) == 0);
+}
+
+TEST_CASE("Autosave journal with a damaged last line", "[Autosave]")
+{
+    auto const temp = TemporaryDirectory{};
+    auto state = SequencerState{};
+    auto text = std::string{};
+
+    {
+        auto autosave = Autosave{[&temp] { return temp.directory; }};
+        autosave.append("first", std::make_shared<SequencerState const>(state),
+                        "instance");
+        state.sequence_names[0] = "Intro";
+        autosave.append("second", std::make_shared<SequencerState const>(state),
+                        "instance");
+        (void)wait_for_commit(temp.directory, "second");
+        text = find_journal(temp.directory).loadFileAsString().toStdString();
+    }
+
+    auto const journal = temp.directory.getChildFile("crashed.journal");
+
+    // A line cut short by the crash.
+    REQUIRE(journal.replaceWithText(text + R"({"command":"torn","meas)"));
+    auto session = read_journal(journal);
+    CHECK(session.last_command == "second");
+    CHECK(session.state == state);
+
+    // Anything after a damaged line is not trusted.
+    REQUIRE(journal.replaceWithText(text + "garbage\n" + text));
+    CHECK(read_journal(journal).last_command == "second");
+
+    REQUIRE(journal.replaceWithText(text + R"({"command":"bad","measures":{"16":{}}})" +
+                                    "\n"));
+    CHECK(read_journal(journal).last_command == "second");
+
+    // Without a snapshot to begin with, there is nothing to recover.
+    REQUIRE(journal.replaceWithText(text.substr(text.find('\n') + 1)));
+    CHECK_THROWS_AS(read_journal(journal), std::runtime_error);
+
+    REQUIRE(journal.replaceWithText("garbage\n"));
+    CHECK_THROWS_AS(read_journal(journal), std::runtime_error);
+
+    CHECK_THROWS_AS(read_journal(temp.directory.getChildFile("missing.journal")),
+                    std::runtime_error);
+}
+
+TEST_CASE("Autosave journal is compacted", "[Autosave]")
+{
+    auto const temp = TemporaryDirectory{};
+    auto state = SequencerState{};
+
+    auto autosave = Autosave{[&temp] { return temp.directory; }};
+    auto const commit = [&](std::string const &command) {
+        autosave.append(command, std::make_shared<SequencerState const>(state),
+                        "instance");
+    };
+
+    for (auto i = std::size_t{0}; i < Autosave::compact_line_count + 10; ++i)
+    {
+        state.sequence_bank[i % 16].cell.weight = static_cast<float>(i + 1);
+        commit("edit " + std::to_string(i));
+    }
+    auto const last = "edit " + std::to_string(Autosave::compact_line_count + 9);
+    CHECK(wait_for_commit(temp.directory, last).state == state);
+    CHECK(count_lines(find_journal(temp.directory)) < Autosave::compact_line_count);
+
+    // Later commits are recorded after the compacted snapshot.
+    state.sequence_names[1] = "Chorus";
+    commit("rename");
+    CHECK(wait_for_commit(temp.directory, "rename").state == state);
+    CHECK(count_lines(find_journal(temp.directory)) < Autosave::compact_line_count);
+}
+
+TEST_CASE("Find recoverable autosave journals", "[Autosave]")
+{
+    auto const temp = TemporaryDirectory{};
+
+    // A journal in use by this process is never recoverable.
+    auto autosave = Autosave{[&temp] { return temp.directory; }};
+    autosave.append("live", std::make_shared<SequencerState const>(), "instance");
+    (void)wait_for_commit(temp.directory, "live");
+
+    auto const journal = [&temp](std::string const &name, std::string const &text,
+                                 double days_old) {
+        auto const file = temp.directory.getChildFile(name);
+        REQUIRE(file.replaceWithText(text));
+        REQUIRE(file.setLastModificationTime(juce::Time::getCurrentTime() -
+                                             juce::RelativeTime::days(days_old)));
+        return file;
+    };
+
+    auto const older = journal("instance.a.journal", "{}\n", 2);
+    auto const recent = journal("instance.b.journal", "{}\n", 1);
+    auto const other = journal("other.c.journal", "{}\n", 1);
+    auto const empty = journal("instance.d.journal", "", 1);
+    auto const expired = journal("other.e.journal", "{}\n", 31);
+
+    auto const journals = find_recoverable_journals(temp.directory, "instance");
+    REQUIRE(journals.size() == 2);
+    CHECK(journals[0] == recent);
+    CHECK(journals[1] == older);
+
+    // Empty and expired journals are removed, whichever instance they belong to.
+    CHECK(other.existsAsFile());
+    CHECK_FALSE(empty.existsAsFile());
+    CHECK_FALSE(expired.existsAsFile());
+
+    CHECK(find_recoverable_journals(temp.directory, "missing").empty());
+
+    // The same search, run on the background thread.
+    auto const find_recoverable = [&autosave](std::string const &instance_id) {
+        auto found = std::promise<bool>{};
+        autosave.find_recoverable(instance_id,
+                                  [&found](bool value) { found.set_value(value); });
+        return found.get_future().get();
+    };
+    CHECK(find_recoverable("instance"));
+    CHECK_FALSE(find_recoverable("missing"));
+}
@@ -0,0 +1,115 @@
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sequence/sequence.hpp>
+
+#include <xen/binary_serialize.hpp>
+#include <xen/serialize.hpp>
+#include <xen/state.hpp>
+
+using namespace xen;
+
+namespace
+{
+
+using Bank = std::pair<SequenceBank, std::array<std::string, 16>>;
+
+[[nodiscard]] auto make_bank() -> Bank
+{
+    auto const note = [](int pitch, float velocity) {
+        return sequence::Cell{
+            .element = sequence::Note{.pitch = pitch,
+                                      .velocity = velocity,
+                                      .delay = 0.25f,
+                                      .gate = 0.75f},
+            .weight = 1.f,
+        };
+    };
+    auto const rest = sequence::Cell{.element = sequence::Rest{}, .weight = 2.5f};
+
+    auto const nested = sequence::Cell{
+        .element = sequence::Sequence{.cells = {rest, note(0, 0.f)}},
+        .weight = 0.5f,
+    };
+
+    auto bank = Bank{};
+    bank.first[0].cell = note(-3, 0.5f);
+    bank.first[1].cell = sequence::Cell{
+        .element = sequence::Sequence{.cells = {note(7, 1.f), rest, nested}},
+        .weight = 1.f,
+    };
+    bank.first[1].time_signature = {.numerator = 7, .denominator = 8};
+    bank.second[0] = "Bass";
+    bank.second[1] = "Arp \xE2\x99\xAF";
+    return bank;
+}
+
+[[nodiscard]] auto as_bytes(std::string const &data) -> std::span<std::byte const>
+{
+    return {reinterpret_cast<std::byte const *>(data.data()), data.size()};
+}
+
+} // namespace
+
+TEST_CASE("Binary sequence bank round trip", "[BinarySerialize]")
+{
+    auto const bank = make_bank();
+    auto const data = serialize_sequence_bank_binary(bank.first, bank.second);
+
+    REQUIRE(is_binary_sequence_bank(as_bytes(data)));
+    CHECK(deserialize_sequence_bank_binary(as_bytes(data)) == bank);
+
+    auto const json = serialize_sequence_bank(bank.first, bank.second);
+    CHECK_FALSE(is_binary_sequence_bank(as_bytes(json)));
+    CHECK_THROWS_AS(deserialize_sequence_bank_binary(as_bytes(json)),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Binary sequence bank rejects truncated input", "[BinarySerialize]")
+{
+    auto const bank = make_bank();
+    auto const data = serialize_sequence_bank_binary(bank.first, bank.second);
+
+    for (auto size = std::size_t{0}; size < data.size(); ++size)
+    {
+        INFO("size: " << size);
+        CHECK_THROWS_AS(deserialize_sequence_bank_binary(as_bytes(data).first(size)),
+                        std::invalid_argument);
+    }
+}
+
+TEST_CASE("Binary sequence bank rejects corrupt input", "[BinarySerialize]")
+{
+    auto const bank = make_bank();
+    auto const data = serialize_sequence_bank_binary(bank.first, bank.second);
+
+    auto newer = data;
+    newer[4] = static_cast<char>(binary_bank::version + 1);
+    CHECK_THROWS_AS(deserialize_sequence_bank_binary(as_bytes(newer)),
+                    std::invalid_argument);
+
+    // Every corrupt byte either still reads or is reported, it is never read past
+    // the end of the input or allocated for.
+    for (auto i = std::size_t{0}; i < data.size(); ++i)
+    {
+        for (auto const value : {'\x00', '\x7F', '\xFF'})
+        {
+            auto corrupt = data;
+            corrupt[i] = value;
+            INFO("byte: " << i << " value: " << (int)value);
+            try
+            {
+                (void)deserialize_sequence_bank_binary(as_bytes(corrupt));
+            }
+            catch (std::invalid_argument const &)
+            {
+            }
+        }
+    }
+}
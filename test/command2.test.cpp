@@ -1,11 +1,17 @@
 #include <memory>
+#include <optional>
+#include <stdexcept>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include <xen/command.hpp>
+#include <xen/completion_index.hpp>
+#include <xen/parse_args.hpp>
 #include <xen/state.hpp>
+#include <xen/string_manip.hpp>
 
 using namespace xen;
 
@@ -159,4 +165,150 @@ TEST_CASE("Pattern", "[Command]")
                             .words = {"sub", "1", "2"},
                         })
               .second == "-1");
-}
\ No newline at end of file
+}
+
+TEST_CASE("CommandGroup lookup is case-insensitive", "[Command]")
+{
+    auto cmd_group_ptr = cmd_group("");
+
+    cmd_group_ptr->add(cmd(signature("show"), "cmd description",
+                           [](PluginState &) -> std::pair<MessageLevel, std::string> {
+                               return {MessageLevel::Debug, "show"};
+                           }));
+
+    cmd_group_ptr->add(cmd(signature("sequenceBank"), "cmd description",
+                           [](PluginState &) -> std::pair<MessageLevel, std::string> {
+                               return {MessageLevel::Debug, "sequenceBank"};
+                           }));
+
+    CHECK(cmd_group_ptr->execute(ps, SplitInput{.pattern = {0, {1}}, .words = {"SHOW"}})
+              .second == "show");
+
+    CHECK(cmd_group_ptr
+              ->execute(ps, SplitInput{.pattern = {0, {1}}, .words = {"sequencebank"}})
+              .second == "sequenceBank");
+
+    CHECK(cmd_group_ptr->execute(ps, SplitInput{.pattern = {0, {1}}, .words = {"sh"}})
+              .first == MessageLevel::Error);
+
+    // First added command wins when a prefix is ambiguous.
+    CHECK(cmd_group_ptr->complete_text(SplitInput{.pattern = {0, {1}}, .words = {"S"}}) ==
+          "how");
+
+    CHECK(cmd_group_ptr->complete_text(
+              SplitInput{.pattern = {0, {1}}, .words = {"Seq"}}) == "uenceBank");
+
+    CHECK_THROWS_AS(cmd_group_ptr->add(cmd(
+                        signature("SHOW"), "cmd description",
+                        [](PluginState &) -> std::pair<MessageLevel, std::string> {
+                            return {MessageLevel::Debug, ""};
+                        })),
+                    std::invalid_argument);
+}
+
+TEST_CASE("CompletionIndex", "[Command]")
+{
+    auto const noop = [](PluginState &, std::string const &) {
+        return std::pair<MessageLevel, std::string>{MessageLevel::Debug, ""};
+    };
+
+    auto head = cmd_group("");
+    head->add(cmd(signature("show", arg<std::string>("component_id")), "", noop));
+    head->add(cmd(signature("select", arg<std::string>("name")), "", noop));
+    {
+        auto load = cmd_group("load");
+        load->add(
+            cmd(signature("sequenceBank", arg<std::string>("filename")), "", noop));
+        load->add(cmd(signature("scales", arg<std::string>("filename")), "", noop));
+        head->add(std::move(load));
+    }
+
+    auto index = CompletionIndex{*head};
+
+    CHECK(index.guide_text("") == "");
+    CHECK(index.guide_text("s") == "how");
+    CHECK(index.guide_text("show") == "[String: component_id]");
+    CHECK(index.guide_text("LOAD") == "[next command]");
+    CHECK(index.guide_text("load s") == "equenceBank");
+    CHECK(index.guide_text("load sb") == " (sequenceBank)");
+    CHECK(index.guide_text("load sequenceBank \"my") == "");
+    CHECK(index.guide_text("load sequenceBank \"my bank\" ") == "");
+    CHECK(index.guide_text("lo s") == "");
+    CHECK(index.guide_text("show x; lo") == "ad");
+
+    CHECK(index.complete("load sb") == "load sequenceBank ");
+    CHECK(index.complete("load sequenceBank") == std::nullopt);
+    CHECK(index.complete("show x; sh") == "show x; show ");
+
+    // Used commands are ranked first.
+    index.record_use("select a; load scales b");
+    CHECK(index.guide_text("s") == "elect");
+    CHECK(index.guide_text("load s") == "cales");
+}
+
+TEST_CASE("Tokenize", "[Command]")
+{
+    auto const input = std::string{R"(load  sequenceBank "my bank" x"y z"w {"a": "b c"})"};
+    auto const tokens = tokenize(input);
+
+    REQUIRE(tokens.size() == 5);
+    CHECK(tokens[0].text == "load");
+    CHECK(tokens[1].text == "sequenceBank");
+    CHECK(tokens[1].position == 6);
+    CHECK(tokens[2].text == "my bank");
+    CHECK(to_string(tokens[3]) == "xy zw");
+    CHECK(tokens[4].text == R"({"a": "b c"})");
+
+    CHECK(tokenize(R"(a "" b)").size() == 2);
+
+    try
+    {
+        (void)tokenize(R"(load sequenceBank "my bank)");
+        FAIL("Expected ParseError");
+    }
+    catch (ParseError const &e)
+    {
+        CHECK(e.position() == 18);
+    }
+
+    CHECK_THROWS_AS(tokenize("set velocity {\"type\": "), ParseError);
+}
+
+TEST_CASE("Parse numeric arguments", "[Command]")
+{
+    CHECK(parse_int("+1") == 1);
+    CHECK(parse_int("-12") == -12);
+    CHECK(parse_int("0x10") == 16);
+    CHECK(parse_int("010") == 8);
+    CHECK(parse_int("-2147483648") == -2147483648LL);
+    CHECK_FALSE(parse_int("2147483648").has_value());
+    CHECK_FALSE(parse_int("12abc").has_value());
+
+    CHECK(parse_unsigned<std::size_t>("42") == 42u);
+    CHECK_FALSE(parse_unsigned<std::size_t>("-1").has_value());
+    CHECK_FALSE(parse_unsigned<unsigned short>("65536").has_value());
+
+    CHECK(parse_float<float>("0.5") == 0.5f);
+    CHECK(parse_float<float>("+.25") == 0.25f);
+    CHECK_FALSE(parse_float<float>("inf").has_value());
+    CHECK_FALSE(parse_float<float>("1.5x").has_value());
+}
+
+TEST_CASE("split_input benchmark", "[.benchmark]")
+{
+    BENCHMARK("move left")
+    {
+        return split_input("move left");
+    };
+
+    BENCHMARK("load sequenceBank")
+    {
+        return split_input(R"(load sequenceBank "my bank")");
+    };
+
+    BENCHMARK("set velocity modulator")
+    {
+        return split_input(
+            R"(set velocity {"type": "sine", "frequency": 1, "amplitude": 0.5} true)");
+    };
+}
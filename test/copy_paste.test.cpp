@@ -0,0 +1,29 @@
+#include <optional>
+#include <stdexcept>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <juce_core/juce_core.h>
+
+#include <sequence/sequence.hpp>
+
+#include <xen/copy_paste.hpp>
+
+using namespace xen;
+
+TEST_CASE("Clipboard without a user library", "[Clipboard]")
+{
+    auto clipboard = Clipboard{[]() -> juce::File {
+        throw std::runtime_error{"Can't find user library directory."};
+    }};
+
+    // Returns once the failed read is done, rather than waiting on it forever.
+    CHECK_FALSE(clipboard.read().has_value());
+
+    auto const cell = sequence::Cell{.element = sequence::Rest{}, .weight = 2.f};
+    clipboard.write(cell);
+
+    auto const pasted = clipboard.read();
+    REQUIRE(pasted.has_value());
+    CHECK(*pasted == cell);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <xen/library_index.hpp>
+
+/**
+ * Library entries shared by the LibraryIndex and LibrarySearch tests: two sequence
+ * banks, a tuning and a tuning that could not be read.
+ */
+[[nodiscard]] inline auto make_library_entries() -> std::vector<xen::LibraryEntry>
+{
+    using xen::LibraryEntry;
+
+    return {
+        {
+            .path = "/library/sequences/Bass Groove.xss",
+            .modified = 1'700'000'000'123,
+            .size = 4096,
+            .type = LibraryEntry::Type::SequenceBank,
+            .readable = true,
+            .measures = {{
+                             .name = "Verse \xE2\x99\xAF",
+                             .numerator = 4,
+                             .denominator = 4,
+                             .note_count = 3,
+                             .preview = {{.x = 0, .width = 127, .y = 0},
+                                         {.x = 128, .width = 127, .y = 255}},
+                         },
+                         {
+                             .name = "Empty",
+                             .numerator = 5,
+                             .denominator = 4,
+                             .note_count = 0,
+                             .preview = {},
+                         }},
+            .tuning = {},
+        },
+        {
+            .path = "/library/sequences/bassline.xss",
+            .modified = 0,
+            .size = 0,
+            .type = LibraryEntry::Type::SequenceBank,
+            .readable = true,
+            .measures = {{
+                .name = "Arp",
+                .numerator = 7,
+                .denominator = 8,
+                .note_count = 12,
+                .preview = {},
+            }},
+            .tuning = {},
+        },
+        {
+            .path = "/library/tunings/12edo.scl",
+            .modified = -1,
+            .size = 0,
+            .type = LibraryEntry::Type::Tuning,
+            .readable = true,
+            .measures = {},
+            .tuning = {.intervals = std::vector<float>(12, 100.f),
+                       .octave = 1200.f,
+                       .description = "Twelve tone equal temperament"},
+        },
+        {
+            .path = "/library/tunings/broken.scl",
+            .modified = 12,
+            .size = 3,
+            .type = LibraryEntry::Type::Tuning,
+            .readable = false,
+            .measures = {},
+            .tuning = {},
+        },
+    };
+}
@@ -0,0 +1,68 @@
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <xen/library_index.hpp>
+
+#include "library_entries.hpp"
+
+using namespace xen;
+
+namespace
+{
+
+[[nodiscard]] auto as_bytes(std::string const &data) -> std::span<std::byte const>
+{
+    return {reinterpret_cast<std::byte const *>(data.data()), data.size()};
+}
+
+} // namespace
+
+TEST_CASE("Library index round trip", "[LibraryIndex]")
+{
+    auto const entries = make_library_entries();
+    auto const data = serialize_library_index(entries);
+    CHECK(deserialize_library_index(as_bytes(data)) == entries);
+
+    auto const empty = serialize_library_index({});
+    CHECK(deserialize_library_index(as_bytes(empty)).empty());
+}
+
+TEST_CASE("Library index rejects other versions", "[LibraryIndex]")
+{
+    auto const data = serialize_library_index(make_library_entries());
+
+    // The version follows the 4 byte magic number, as a little-endian u32.
+    for (auto const version : {0, 1, 3, 255})
+    {
+        INFO("version: " << version);
+        auto other = data;
+        other[4] = static_cast<char>(version);
+        CHECK_THROWS_AS(deserialize_library_index(as_bytes(other)),
+                        std::invalid_argument);
+    }
+
+    auto not_index = data;
+    not_index[0] = 'Y';
+    CHECK_THROWS_AS(deserialize_library_index(as_bytes(not_index)),
+                    std::invalid_argument);
+}
+
+TEST_CASE("Library index rejects truncated files", "[LibraryIndex]")
+{
+    auto const data = serialize_library_index(make_library_entries());
+
+    for (auto size = std::size_t{0}; size < data.size(); ++size)
+    {
+        INFO("size: " << size);
+        CHECK_THROWS_AS(deserialize_library_index(as_bytes(data).first(size)),
+                        std::invalid_argument);
+    }
+
+    // A count larger than the rest of the file is caught before allocating for it.
+    auto huge = data.substr(0, 8) + std::string{"\xFF\xFF\xFF\x7F", 4};
+    CHECK_THROWS_AS(deserialize_library_index(as_bytes(huge)), std::invalid_argument);
+}
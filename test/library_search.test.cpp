@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <xen/library_index.hpp>
+#include <xen/library_search.hpp>
+
+#include "library_entries.hpp"
+
+using namespace xen;
+
+namespace
+{
+
+[[nodiscard]] auto make_entries() -> LibraryIndex::Entries
+{
+    auto entries = LibraryIndex::Entries{};
+    for (auto &entry : make_library_entries())
+    {
+        auto path = entry.path;
+        entries.emplace(std::move(path),
+                        std::make_shared<LibraryEntry const>(std::move(entry)));
+    }
+    return entries;
+}
+
+[[nodiscard]] auto search_paths(LibrarySearch const &search, std::string_view query)
+    -> std::vector<std::string>
+{
+    auto paths = std::vector<std::string>{};
+    std::ranges::transform(search.search(query), std::back_inserter(paths),
+                           [](auto const &entry) { return entry->path; });
+    return paths;
+}
+
+} // namespace
+
+TEST_CASE("Split search words", "[LibrarySearch]")
+{
+    CHECK(split_search_words("Bass-Groove_02 v2") ==
+          std::vector<std::string>{"bass", "groove", "02", "v2"});
+    CHECK(split_search_words("  ..  ").empty());
+    CHECK(split_search_words("Caf\xC3\xA9!") ==
+          std::vector<std::string>{"caf\xC3\xA9"});
+}
+
+TEST_CASE("Library search by name prefix", "[LibrarySearch]")
+{
+    auto const search = LibrarySearch{make_entries()};
+    REQUIRE(search.size() == 4);
+
+    auto const bass_groove = std::string{"/library/sequences/Bass Groove.xss"};
+    auto const bassline = std::string{"/library/sequences/bassline.xss"};
+    auto const edo = std::string{"/library/tunings/12edo.scl"};
+
+    // Results are ordered by path.
+    CHECK(search_paths(search, "bas") == std::vector{bass_groove, bassline});
+    CHECK(search_paths(search, "BASS") == std::vector{bass_groove, bassline});
+    CHECK(search_paths(search, "groove") == std::vector{bass_groove});
+    CHECK(search_paths(search, "bass gro") == std::vector{bass_groove});
+    CHECK(search_paths(search, "bass  \t arp") == std::vector{bassline});
+
+    // Measure names and tuning descriptions are searched along with file names.
+    CHECK(search_paths(search, "verse") == std::vector{bass_groove});
+    CHECK(search_paths(search, "equal temp") == std::vector{edo});
+
+    // Terms only match the start of a word.
+    CHECK(search_paths(search, "roove").empty());
+    CHECK(search_paths(search, "bass drums").empty());
+}
+
+TEST_CASE("Library search with an empty query", "[LibrarySearch]")
+{
+    auto const search = LibrarySearch{make_entries()};
+
+    CHECK(search.search("").size() == 4);
+    CHECK(search.search(" \t\n").size() == 4);
+
+    // A term without any word characters does not narrow the results.
+    CHECK(search.search("--").size() == 4);
+
+    CHECK(LibrarySearch{{}}.search("bass").empty());
+}
+
+TEST_CASE("Library search by note count", "[LibrarySearch]")
+{
+    auto const search = LibrarySearch{make_entries()};
+
+    auto const bass_groove = std::string{"/library/sequences/Bass Groove.xss"};
+    auto const bassline = std::string{"/library/sequences/bassline.xss"};
+
+    CHECK(search_paths(search, "notes=3") == std::vector{bass_groove});
+    CHECK(search_paths(search, "notes>3") == std::vector{bassline});
+    CHECK(search_paths(search, "notes>=3") == std::vector{bass_groove, bassline});
+    CHECK(search_paths(search, "notes<=12") == std::vector{bass_groove, bassline});
+    CHECK(search_paths(search, "NOTES<12") == std::vector{bass_groove});
+
+    // Empty measures are not considered.
+    CHECK(search_paths(search, "notes<3").empty());
+    CHECK(search_paths(search, "notes=0").empty());
+
+    // Filters combine with name prefixes.
+    CHECK(search_paths(search, "groove notes>3").empty());
+    CHECK(search_paths(search, "bass notes>3") == std::vector{bassline});
+}
+
+TEST_CASE("Library search by tuning size", "[LibrarySearch]")
+{
+    auto const search = LibrarySearch{make_entries()};
+
+    auto const edo = std::string{"/library/tunings/12edo.scl"};
+
+    CHECK(search_paths(search, "size=12") == std::vector{edo});
+    CHECK(search_paths(search, "size>=1") == std::vector{edo});
+    CHECK(search_paths(search, "size<12").empty());
+
+    // Sequence banks and unreadable tunings have no size.
+    CHECK(search_paths(search, "size>=0") == std::vector{edo});
+}
+
+TEST_CASE("Library search by time signature", "[LibrarySearch]")
+{
+    auto const search = LibrarySearch{make_entries()};
+
+    auto const bass_groove = std::string{"/library/sequences/Bass Groove.xss"};
+    auto const bassline = std::string{"/library/sequences/bassline.xss"};
+
+    CHECK(search_paths(search, "ts=4/4") == std::vector{bass_groove});
+    CHECK(search_paths(search, "ts=7/8") == std::vector{bassline});
+    CHECK(search_paths(search, "ts=8/7").empty());
+
+    // The only 5/4 measure is empty.
+    CHECK(search_paths(search, "ts=5/4").empty());
+}
+
+TEST_CASE("Library search with invalid terms", "[LibrarySearch]")
+{
+    auto const search = LibrarySearch{make_entries()};
+
+    CHECK_THROWS_AS(search.search("notes="), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("notes=abc"), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("notes=-1"), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("notes=3x"), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("notes=<3"), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("size>>1"), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("ts=7"), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("ts=7/"), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("ts>4/4"), std::invalid_argument);
+    CHECK_THROWS_AS(search.search("bass notes=x"), std::invalid_argument);
+
+    // Unknown attributes and bare comparisons are searched as plain words.
+    CHECK(search.search("tempo=120").empty());
+    CHECK(search.search("=12").size() == 1);
+}
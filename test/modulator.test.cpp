@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <sequence/pattern.hpp>
+#include <sequence/sequence.hpp>
+
+#include <xen/actions.hpp>
+#include <xen/modulator.hpp>
+
+using namespace xen;
+
+namespace
+{
+
+// Modulators as they were written before being compiled, to check results against.
+using Reference = std::function<float(float)>;
+
+[[nodiscard]] auto ref_sine(float frequency, float amplitude, float phase) -> Reference
+{
+    return [=](float t) {
+        auto const two_pi = 2.f * std::numbers::pi_v<float>;
+        return amplitude * std::sin(two_pi * frequency * (t + phase));
+    };
+}
+
+[[nodiscard]] auto ref_triangle(float frequency, float amplitude, float phase)
+    -> Reference
+{
+    return [=](float t) {
+        auto const x = std::fmod(std::fmod(t + phase, 1.f) * frequency, 1.f);
+        return amplitude * (4.f * std::abs(x - 0.5f) - 1.f);
+    };
+}
+
+[[nodiscard]] auto ref_sawtooth_up(float frequency, float amplitude, float phase)
+    -> Reference
+{
+    return [=](float t) {
+        auto const x = std::fmod(std::fmod(t + phase, 1.f) * frequency, 1.f);
+        return amplitude * (2.f * x - 1.f);
+    };
+}
+
+[[nodiscard]] auto ref_sawtooth_down(float frequency, float amplitude, float phase)
+    -> Reference
+{
+    return [=](float t) {
+        auto const x = std::fmod(std::fmod(t + phase, 1.f) * frequency, 1.f);
+        return amplitude * (1.f - 2.f * x);
+    };
+}
+
+[[nodiscard]] auto ref_square(float frequency, float amplitude, float phase,
+                              float pulse_width) -> Reference
+{
+    return [=](float t) {
+        auto const x = std::fmod(std::fmod(t + phase, 1.f) * frequency, 1.f);
+        return amplitude * ((x < pulse_width) ? 1.f : -1.f);
+    };
+}
+
+[[nodiscard]] auto ref_chain(std::vector<Reference> refs) -> Reference
+{
+    return [refs = std::move(refs)](float input) {
+        if (refs.empty())
+        {
+            return 0.f;
+        }
+        auto output = input;
+        for (auto const &ref : refs)
+        {
+            output = ref(output);
+        }
+        return output;
+    };
+}
+
+[[nodiscard]] auto ref_blend(std::vector<Reference> refs) -> Reference
+{
+    return [refs = std::move(refs)](float input) {
+        auto output = 0.f;
+        for (auto const &ref : refs)
+        {
+            output += ref(input);
+        }
+        return output;
+    };
+}
+
+/**
+ * Inputs spanning a few cycles either side of [0, 1).
+ */
+[[nodiscard]] auto make_inputs(std::size_t count) -> std::vector<float>
+{
+    auto inputs = std::vector<float>(count);
+    for (auto i = std::size_t{0}; i < count; ++i)
+    {
+        inputs[i] = -2.f + 5.f * (float)i / (float)count;
+    }
+    return inputs;
+}
+
+/**
+ * Compare bit patterns, so NaNs of the same kind are equal.
+ */
+[[nodiscard]] auto identical(float a, float b) -> bool
+{
+    return std::bit_cast<std::uint32_t>(a) == std::bit_cast<std::uint32_t>(b);
+}
+
+void check_matches(Modulator const &mod, Reference const &ref)
+{
+    auto const inputs = make_inputs(1'000);
+    auto outputs = std::vector<float>(inputs.size());
+    mod(inputs, outputs);
+
+    for (auto i = std::size_t{0}; i < inputs.size(); ++i)
+    {
+        INFO("input: " << inputs[i]);
+        CHECK(identical(mod(inputs[i]), ref(inputs[i])));
+        CHECK(identical(outputs[i], mod(inputs[i])));
+    }
+}
+
+/**
+ * A selection with nesting typical of the modulation pane.
+ */
+[[nodiscard]] auto make_nested() -> std::pair<Modulator, Reference>
+{
+    namespace mod = modulator;
+
+    auto const m = mod::chain({
+        mod::blend({
+            mod::sine(3.f, 0.5f, 0.1f),
+            mod::chain({mod::triangle(2.f), mod::absolute_value(), mod::scale(0.25f)}),
+            mod::blend({mod::square(4.f, 1.f, 0.f, 0.3f), mod::sawtooth_down(1.5f)}),
+        }),
+        mod::bias(1.f),
+        mod::clamp(0.1f, 2.f),
+        mod::power(1.5f),
+    });
+
+    auto const ref = ref_chain({
+        ref_blend({
+            ref_sine(3.f, 0.5f, 0.1f),
+            ref_chain({ref_triangle(2.f, 1.f, 0.f), [](float x) { return std::abs(x); },
+                       [](float x) { return x * 0.25f; }}),
+            ref_blend({ref_square(4.f, 1.f, 0.f, 0.3f),
+                       ref_sawtooth_down(1.5f, 1.f, 0.f)}),
+        }),
+        [](float x) { return x + 1.f; },
+        [](float x) { return std::clamp(x, 0.1f, 2.f); },
+        [](float x) { return std::pow(x, 1.5f); },
+    });
+
+    return {m, ref};
+}
+
+} // namespace
+
+TEST_CASE("Generators match their reference", "[Modulator]")
+{
+    namespace mod = modulator;
+
+    check_matches(mod::constant(0.3f), [](float) { return 0.3f; });
+    check_matches(mod::sine(2.f, 0.5f, 0.25f), ref_sine(2.f, 0.5f, 0.25f));
+    check_matches(mod::triangle(3.f, 2.f, -0.1f), ref_triangle(3.f, 2.f, -0.1f));
+    check_matches(mod::sawtooth_up(0.5f, 1.f, 0.3f), ref_sawtooth_up(0.5f, 1.f, 0.3f));
+    check_matches(mod::sawtooth_down(7.f), ref_sawtooth_down(7.f, 1.f, 0.f));
+    check_matches(mod::square(2.f, 1.f, 0.f, 0.25f), ref_square(2.f, 1.f, 0.f, 0.25f));
+
+    CHECK_THROWS_AS(mod::sine(-1.f), std::invalid_argument);
+    CHECK_THROWS_AS(mod::square(1.f, 1.f, 0.f, 1.5f), std::invalid_argument);
+
+    auto const noise = mod::noise(0.5f);
+    auto outputs = std::vector<float>(1'000);
+    noise(make_inputs(outputs.size()), outputs);
+    CHECK(std::ranges::all_of(outputs, [](float x) { return std::abs(x) <= 0.5f; }));
+}
+
+TEST_CASE("Modifiers match their reference", "[Modulator]")
+{
+    namespace mod = modulator;
+
+    check_matches(Modulator{}, [](float x) { return x; });
+    check_matches(mod::scale(-0.5f), [](float x) { return x * -0.5f; });
+    check_matches(mod::bias(0.75f), [](float x) { return x + 0.75f; });
+    check_matches(mod::absolute_value(), [](float x) { return std::abs(x); });
+    check_matches(mod::clamp(-0.5f, 1.f),
+                  [](float x) { return std::clamp(x, -0.5f, 1.f); });
+    check_matches(mod::invert(), [](float x) { return x * -1.f; });
+    check_matches(mod::power(0.5f), [](float x) { return std::pow(x, 0.5f); });
+
+    CHECK_THROWS_AS(mod::power(-1.f), std::invalid_argument);
+}
+
+TEST_CASE("Chains and blends match their reference", "[Modulator]")
+{
+    namespace mod = modulator;
+
+    check_matches(mod::chain({}), [](float) { return 0.f; });
+    check_matches(mod::blend({}), [](float) { return 0.f; });
+    check_matches(mod::blend({mod::blend({}), mod::chain({Modulator{}})}),
+                  [](float x) { return 0.f + 0.f + x; });
+
+    auto const [m, ref] = make_nested();
+    check_matches(m, ref);
+
+    // Compiled to one program, without any nested Modulator calls.
+    CHECK(m.program().size() == 23);
+
+    using Op = Modulator::Op;
+    CHECK_THROWS_AS(Modulator({{.op = Op::BeginBlend}}), std::invalid_argument);
+    CHECK_THROWS_AS(Modulator({{.op = Op::Accumulate}}), std::invalid_argument);
+}
+
+TEST_CASE("Modulator args can be replaced", "[Modulator]")
+{
+    namespace mod = modulator;
+
+    auto m = mod::blend({mod::chain({mod::sine(1.f), mod::scale(2.f)}), mod::bias(1.f)});
+
+    // The sine follows BeginBlend and LoadInput.
+    m.set_args(2, {2.f, 0.5f, 0.25f});
+    check_matches(m, ref_blend({
+                         ref_chain({ref_sine(2.f, 0.5f, 0.25f),
+                                    [](float x) { return x * 2.f; }}),
+                         [](float x) { return x + 1.f; },
+                     }));
+
+    CHECK_THROWS_AS(m.set_args(m.program().size(), {}), std::out_of_range);
+}
+
+TEST_CASE("Batch evaluation may be in place", "[Modulator]")
+{
+    auto const [m, ref] = make_nested();
+    auto values = make_inputs(100);
+    auto const inputs = values;
+    m(values, values);
+    for (auto i = std::size_t{0}; i < values.size(); ++i)
+    {
+        CHECK(identical(values[i], ref(inputs[i])));
+    }
+
+    auto too_few = std::vector<float>(99);
+    CHECK_THROWS_AS(m(inputs, too_few), std::invalid_argument);
+}
+
+TEST_CASE("Modulated actions only change the Pattern's Cells", "[Modulator]")
+{
+    auto const rest = sequence::Cell{.element = sequence::Rest{}, .weight = 1.f};
+    auto const cell = sequence::Cell{
+        .element = sequence::Sequence{.cells = std::vector<sequence::Cell>(8, rest)},
+        .weight = 1.f,
+    };
+
+    auto const result = action::set_weights(cell, sequence::Pattern{1, {2}},
+                                            modulator::bias(1.f));
+    auto const &cells = std::get<sequence::Sequence>(result.element).cells;
+    for (auto i = std::size_t{0}; i < cells.size(); ++i)
+    {
+        auto const expected = (i % 2 == 1) ? (float)i / 8.f + 1.f : 1.f;
+        CHECK(identical(cells[i].weight, expected));
+    }
+}
+
+TEST_CASE("Modulator benchmark", "[.benchmark]")
+{
+    auto const [m, ref] = make_nested();
+
+    // A selection of 10k Cells.
+    auto const inputs = make_inputs(10'000);
+    auto outputs = std::vector<float>(inputs.size());
+
+    BENCHMARK("batch")
+    {
+        m(inputs, outputs);
+        return outputs.back();
+    };
+
+    BENCHMARK("scalar")
+    {
+        std::ranges::transform(inputs, outputs.begin(), std::cref(m));
+        return outputs.back();
+    };
+
+    // The previous implementation nested a std::function for each Modulator.
+    BENCHMARK("std::function")
+    {
+        std::ranges::transform(inputs, outputs.begin(), std::cref(ref));
+        return outputs.back();
+    };
+
+    auto const rest = sequence::Cell{.element = sequence::Rest{}, .weight = 1.f};
+    auto const cell = sequence::Cell{
+        .element =
+            sequence::Sequence{.cells = std::vector<sequence::Cell>(10'000, rest)},
+        .weight = 1.f,
+    };
+    auto const weights = modulator::chain({m, modulator::bias(1.f)});
+
+    BENCHMARK("set_weights")
+    {
+        return action::set_weights(cell, sequence::Pattern{0, {1}}, weights);
+    };
+}
@@ -0,0 +1,260 @@
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <sequence/sequence.hpp>
+
+#include <xen/binary_serialize.hpp>
+#include <xen/scale.hpp>
+#include <xen/serialize.hpp>
+#include <xen/state.hpp>
+
+using namespace xen;
+
+namespace
+{
+
+/**
+ * Generates random plugin states, with a fixed seed so failures are reproducible.
+ */
+class StateGenerator
+{
+  public:
+    [[nodiscard]] auto cell(int depth) -> sequence::Cell
+    {
+        auto cell = sequence::Cell{.element = sequence::Rest{}, .weight = this->real()};
+        switch (this->index(depth < 4 ? 3 : 2))
+        {
+        case 0: break;
+        case 1:
+            cell.element = sequence::Note{
+                .pitch = static_cast<int>(rng_()),
+                .velocity = this->real(),
+                .delay = this->real(),
+                .gate = this->real(),
+            };
+            break;
+        default: {
+            auto seq = sequence::Sequence{};
+            for (auto i = this->index(5); i > 0; --i)
+            {
+                seq.cells.push_back(this->cell(depth + 1));
+            }
+            cell.element = std::move(seq);
+        }
+        }
+        return cell;
+    }
+
+    [[nodiscard]] auto state() -> SequencerState
+    {
+        auto state = SequencerState{};
+        for (auto &measure : state.sequence_bank)
+        {
+            measure.cell = this->cell(0);
+            measure.time_signature.numerator = static_cast<unsigned>(this->index(32));
+            measure.time_signature.denominator = static_cast<unsigned>(this->index(32));
+        }
+        for (auto &name : state.sequence_names)
+        {
+            name = this->text();
+        }
+
+        state.tuning.intervals.clear();
+        for (auto i = this->index(24); i > 0; --i)
+        {
+            state.tuning.intervals.push_back(this->real());
+        }
+        state.tuning.octave = this->real();
+        state.tuning_name = this->text();
+
+        if (this->index(2) == 0)
+        {
+            auto scale = Scale{
+                .name = this->text(),
+                .tuning_length = this->index(64),
+                .intervals = {},
+                .mode = static_cast<std::uint8_t>(rng_()),
+            };
+            for (auto i = this->index(8); i > 0; --i)
+            {
+                scale.intervals.push_back(static_cast<std::uint8_t>(rng_()));
+            }
+            state.scale = std::move(scale);
+        }
+
+        state.key = static_cast<int>(rng_());
+        state.scale_translate_direction =
+            this->index(2) == 0 ? TranslateDirection::Up : TranslateDirection::Down;
+        state.base_frequency = this->real();
+        return state;
+    }
+
+  private:
+    [[nodiscard]] auto index(std::size_t count) -> std::size_t
+    {
+        return rng_() % count;
+    }
+
+    /**
+     * Special values, small integers and random finite bit patterns.
+     */
+    [[nodiscard]] auto real() -> float
+    {
+        switch (this->index(6))
+        {
+        case 0: return 0.f;
+        case 1: return -0.f;
+        case 2: return 1e-40f; // Denormal
+        case 3: return static_cast<float>(this->index(1'000));
+        default: {
+            auto const bits = static_cast<std::uint32_t>(rng_()) & 0xBF7F'FFFFu;
+            return std::bit_cast<float>(bits); // Exponent below all ones, finite.
+        }
+        }
+    }
+
+    /**
+     * Strings containing characters that must be escaped and multi-byte UTF-8.
+     */
+    [[nodiscard]] auto text() -> std::string
+    {
+        constexpr auto pieces = std::array{
+            "a", "Z", " ", "/", "\"", "\\", "\n", "\t", "\x01", "\x1f", "\x7f",
+            "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+        };
+        auto result = std::string{};
+        for (auto i = this->index(12); i > 0; --i)
+        {
+            result += pieces[this->index(pieces.size())];
+        }
+        return result;
+    }
+
+  private:
+    std::mt19937 rng_{20'240'611};
+};
+
+} // namespace
+
+TEST_CASE("Serialize round trip fuzz", "[Serialize]")
+{
+    auto gen = StateGenerator{};
+    for (auto i = 0; i < 200; ++i)
+    {
+        auto const state = gen.state();
+
+        // Output must match nlohmann::json::dump() for existing files to be unchanged.
+        auto const json_str = serialize_plugin(state);
+        REQUIRE(nlohmann::json::parse(json_str).dump() == json_str);
+        REQUIRE(deserialize_plugin(json_str) == state);
+
+        auto const bank_str =
+            serialize_sequence_bank(state.sequence_bank, state.sequence_names);
+        REQUIRE(nlohmann::json::parse(bank_str).dump() == bank_str);
+        REQUIRE(deserialize_sequence_bank(bank_str) ==
+                std::pair{state.sequence_bank, state.sequence_names});
+
+        auto const &measure = state.sequence_bank[static_cast<std::size_t>(i) % 16];
+        REQUIRE(deserialize_measure(serialize_measure(measure)) == measure);
+        REQUIRE(deserialize_cell(serialize_cell(measure.cell)) == measure.cell);
+
+        auto const binary = serialize_sequence_bank_binary(state.sequence_bank,
+                                                           state.sequence_names);
+        auto const bytes = std::span{reinterpret_cast<std::byte const *>(binary.data()),
+                                     binary.size()};
+        REQUIRE(deserialize_sequence_bank_binary(bytes) ==
+                std::pair{state.sequence_bank, state.sequence_names});
+    }
+}
+
+TEST_CASE("Serialize Cell", "[Serialize]")
+{
+    auto const note = sequence::Cell{
+        .element =
+            sequence::Note{.pitch = 3, .velocity = 0.5f, .delay = 0.f, .gate = 1.f},
+        .weight = 2.f,
+    };
+    CHECK(serialize_cell(note) == R"({"delay":0.0,"gate":1.0,"pitch":3,"type":"Note",)"
+                                  R"("velocity":0.5,"weight":2.0})");
+
+    // nlohmann::json's digits, one longer than the shortest that read back exactly.
+    CHECK(serialize_cell(sequence::Cell{.element = sequence::Rest{},
+                                        .weight = 223.16360473632812f}) ==
+          R"({"type":"Rest","weight":223.16360473632813})");
+
+    // Keys in any order, unknown keys are skipped and weight defaults to one.
+    CHECK(deserialize_cell(R"({"cells": [{"type": "Rest", "extra": [{}, [1]]}],
+                               "comment": {"type": "Note"}, "type": "Sequence"})") ==
+          sequence::Cell{
+              .element = sequence::Sequence{.cells = {sequence::Cell{
+                                                .element = sequence::Rest{},
+                                                .weight = 1.f,
+                                            }}},
+              .weight = 1.f,
+          });
+
+    CHECK_THROWS_AS(deserialize_cell(R"({"type": "Note", "pitch": 1})"),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(deserialize_cell(R"({"type": "Chord"})"), std::invalid_argument);
+    CHECK_THROWS_AS(deserialize_cell(R"({"type": "Rest")"), std::invalid_argument);
+    CHECK_THROWS_AS(deserialize_cell(R"({"type": 5})"), std::invalid_argument);
+    CHECK_THROWS_AS(deserialize_cell(R"([])"), std::invalid_argument);
+}
+
+TEST_CASE("Serialize host state", "[Serialize]")
+{
+    auto const state = StateGenerator{}.state();
+
+    auto const json_str = serialize_host_state(state, "instance");
+    REQUIRE(nlohmann::json::parse(json_str).dump() == json_str);
+    CHECK(deserialize_host_state(json_str) ==
+          std::pair{state, std::string{"instance"}});
+
+    // States saved without an id are read with an empty one.
+    CHECK(serialize_host_state(state, "") == serialize_plugin(state));
+    CHECK(deserialize_host_state(serialize_plugin(state)) ==
+          std::pair{state, std::string{}});
+    CHECK(deserialize_plugin(json_str) == state);
+}
+
+TEST_CASE("Serialize benchmark", "[.benchmark]")
+{
+    auto gen = StateGenerator{};
+    auto const state = gen.state();
+    auto const json_str = serialize_plugin(state);
+    auto const dom = nlohmann::json::parse(json_str);
+
+    BENCHMARK("serialize_plugin")
+    {
+        return serialize_plugin(state);
+    };
+
+    // The previous implementation built this DOM, then converted it to and from the
+    // state objects, so these are lower bounds on its time.
+    BENCHMARK("nlohmann::json dump")
+    {
+        return dom.dump();
+    };
+
+    BENCHMARK("deserialize_plugin")
+    {
+        return deserialize_plugin(json_str);
+    };
+
+    BENCHMARK("nlohmann::json parse")
+    {
+        return nlohmann::json::parse(json_str);
+    };
+}
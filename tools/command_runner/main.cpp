@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h> // PluginState::laf
+
+#include <xen/actions.hpp>
+#include <xen/command.hpp>
+#include <xen/message_level.hpp>
+#include <xen/state.hpp>
+#include <xen/string_manip.hpp>
+#include <xen/xen_command_tree.hpp>
+
+namespace
+{
+
+constexpr auto usage =
+    "Usage: command_runner [options] <script>...\n"
+    "\n"
+    "Execute command scripts against a sequence bank without a GUI.\n"
+    "Each script line is a single command or a ';' separated chain of commands.\n"
+    "Blank lines and lines starting with '#' are ignored. Use '-' to read stdin.\n"
+    "\n"
+    "Options:\n"
+    "  -i, --input <file.xss>   Sequence bank to load before running scripts.\n"
+    "  -o, --output <file.xss>  Write the resulting sequence bank to this file.\n"
+    "  -n, --repeat <count>     Run the scripts this many times, default 1.\n"
+    "  -k, --keep-going         Continue after a command returns an error.\n"
+    "  -q, --quiet              Only print the summary.\n";
+
+struct Options
+{
+    std::optional<std::string> input;
+    std::optional<std::string> output;
+    std::size_t repeat = 1;
+    bool keep_going = false;
+    bool quiet = false;
+    std::vector<std::string> scripts;
+};
+
+/**
+ * A single line from a script, the unit that is timed.
+ */
+struct ScriptLine
+{
+    std::string source; // "filename:line"
+    std::string text;
+};
+
+[[nodiscard]] auto parse_options(int argc, char const *argv[]) -> Options
+{
+    auto options = Options{};
+
+    auto const next_arg = [&](int &i) -> std::string {
+        if (i + 1 >= argc)
+        {
+            throw std::invalid_argument{"Missing value for " + std::string{argv[i]}};
+        }
+        return argv[++i];
+    };
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        auto const arg = std::string{argv[i]};
+        if (arg == "-i" || arg == "--input")
+        {
+            options.input = next_arg(i);
+        }
+        else if (arg == "-o" || arg == "--output")
+        {
+            options.output = next_arg(i);
+        }
+        else if (arg == "-n" || arg == "--repeat")
+        {
+            options.repeat = std::stoul(next_arg(i));
+        }
+        else if (arg == "-k" || arg == "--keep-going")
+        {
+            options.keep_going = true;
+        }
+        else if (arg == "-q" || arg == "--quiet")
+        {
+            options.quiet = true;
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            std::cout << usage;
+            std::exit(EXIT_SUCCESS);
+        }
+        else if (arg.size() > 1 && arg.front() == '-')
+        {
+            throw std::invalid_argument{"Unknown option: " + arg};
+        }
+        else
+        {
+            options.scripts.push_back(arg);
+        }
+    }
+
+    if (options.scripts.empty())
+    {
+        throw std::invalid_argument{"No scripts given."};
+    }
+
+    return options;
+}
+
+[[nodiscard]] auto read_script(std::string const &filename) -> std::vector<ScriptLine>
+{
+    auto file = std::ifstream{};
+    if (filename != "-")
+    {
+        file.open(filename);
+        if (!file)
+        {
+            throw std::runtime_error{"Unable to open script: " + filename};
+        }
+    }
+    auto &stream = (filename == "-") ? std::cin : static_cast<std::istream &>(file);
+
+    auto result = std::vector<ScriptLine>{};
+    auto line = std::string{};
+    for (auto number = 1; std::getline(stream, line); ++number)
+    {
+        line = xen::strip(line);
+        if (line.empty() || line.front() == '#')
+        {
+            continue;
+        }
+        result.push_back({filename + ":" + std::to_string(number), line});
+    }
+    return result;
+}
+
+/**
+ * Resolve a command line path relative to the current working directory.
+ */
+[[nodiscard]] auto to_file(std::string const &path) -> juce::File
+{
+    return juce::File::getCurrentWorkingDirectory().getChildFile(juce::String{path});
+}
+
+} // namespace
+
+/**
+ * Run command scripts against PluginState without constructing any GUI components,
+ * then report per-command latency and overall throughput.
+ */
+int main(int argc, char const *argv[])
+{
+    using Clock = std::chrono::steady_clock;
+    using Microseconds = std::chrono::duration<double, std::micro>;
+
+    try
+    {
+        auto const options = parse_options(argc, argv);
+
+        auto lines = std::vector<ScriptLine>{};
+        for (auto const &script : options.scripts)
+        {
+            auto const script_lines = read_script(script);
+            lines.insert(std::end(lines), std::cbegin(script_lines),
+                         std::cend(script_lines));
+        }
+
+        auto ps = xen::PluginState{
+            .timeline = xen::XenTimeline{xen::TrackedState{
+                .sequencer = xen::SequencerState{},
+                .aux = xen::AuxState{},
+            }},
+        };
+        auto const tree = xen::create_command_tree();
+        auto previous_commands = std::vector<xen::PreparedCommand>{};
+
+        // Scales and chords are needed by some commands, but a missing user library is
+        // not fatal for scripts that do not use them.
+        for (auto const *setup : {"load scales", "load chords"})
+        {
+            auto const [level, message] = xen::execute_commands(
+                tree, ps, xen::prepare_command_string(setup), previous_commands);
+            if (level == xen::MessageLevel::Error)
+            {
+                std::cerr << "Warning: " << setup << ": " << message << '\n';
+            }
+        }
+
+        if (options.input.has_value())
+        {
+            auto [state, aux] = ps.timeline.get_state();
+            auto [bank, names] = xen::action::load_sequence_bank(to_file(*options.input));
+            state.sequence_bank = std::move(bank);
+            state.sequence_names = std::move(names);
+            ps.timeline.stage({std::move(state), std::move(aux)});
+            ps.timeline.commit();
+        }
+
+        auto latencies = std::vector<double>{};
+        latencies.reserve(lines.size() * options.repeat);
+        auto error_count = std::size_t{0};
+        auto command_count = std::size_t{0};
+
+        auto const total_begin = Clock::now();
+        for (auto pass = std::size_t{0}; pass < options.repeat; ++pass)
+        {
+            for (auto const &line : lines)
+            {
+                auto const begin = Clock::now();
+                auto [level, message] = [&]() -> std::pair<xen::MessageLevel, std::string> {
+                    try
+                    {
+                        auto const commands = xen::prepare_command_string(line.text);
+                        command_count += commands.size();
+                        auto status = xen::execute_commands(tree, ps, commands,
+                                                            previous_commands);
+
+                        // Wait on background tasks so latency covers all of the work.
+                        if (auto const result = ps.worker.wait(); result.has_value())
+                        {
+                            status = xen::apply_task_result(ps, *result);
+                        }
+                        return status;
+                    }
+                    catch (std::exception const &e)
+                    {
+                        return {xen::MessageLevel::Error, e.what()};
+                    }
+                }();
+                auto const elapsed = Microseconds{Clock::now() - begin}.count();
+                latencies.push_back(elapsed);
+
+                if (!options.quiet || level == xen::MessageLevel::Error)
+                {
+                    std::cout << std::fixed << std::setprecision(1) << std::setw(10)
+                              << elapsed << " us  " << line.source << "  " << line.text
+                              << "  [" << level << "] " << message << '\n';
+                }
+
+                if (level == xen::MessageLevel::Error)
+                {
+                    ++error_count;
+                    if (!options.keep_going)
+                    {
+                        std::cerr << "Stopped at " << line.source
+                                  << ", use --keep-going to continue past errors.\n";
+                        return EXIT_FAILURE;
+                    }
+                }
+            }
+        }
+        auto const total_seconds =
+            std::chrono::duration<double>{Clock::now() - total_begin}.count();
+
+        if (options.output.has_value())
+        {
+            auto const state = ps.timeline.get_state().sequencer;
+            xen::action::save_sequence_bank(state.sequence_bank, state.sequence_names,
+                                            to_file(*options.output));
+        }
+
+        if (!latencies.empty())
+        {
+            auto sorted = latencies;
+            std::sort(std::begin(sorted), std::end(sorted));
+            auto const percentile = [&](double p) {
+                auto const index = static_cast<std::size_t>(
+                    p * static_cast<double>(sorted.size() - 1) + 0.5);
+                return sorted[index];
+            };
+            auto sum = 0.0;
+            for (auto const x : sorted)
+            {
+                sum += x;
+            }
+
+            std::cout << std::fixed << std::setprecision(1) << '\n'
+                      << "lines executed: " << latencies.size() << " (" << error_count
+                      << " errors)\n"
+                      << "total time:     " << total_seconds * 1'000.0 << " ms\n"
+                      << "commands:       " << command_count << '\n'
+                      << "throughput:     "
+                      << static_cast<double>(command_count) / total_seconds
+                      << " commands/s\n"
+                      << "line latency:   mean " << sum / static_cast<double>(sorted.size())
+                      << ", p50 " << percentile(0.5) << ", p99 " << percentile(0.99)
+                      << ", max " << sorted.back() << " (us)\n";
+        }
+
+        return error_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << e.what() << '\n' << '\n' << usage;
+        return EXIT_FAILURE;
+    }
+}
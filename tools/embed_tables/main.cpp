@@ -0,0 +1,214 @@
+#include <cctype>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+namespace
+{
+
+constexpr auto usage =
+    "Usage: embed_tables <scales.yml> <chords.yml> <keys.yml> <output.hpp>\n"
+    "\n"
+    "Convert the system scales, chords and key bindings to constexpr tables, so they\n"
+    "do not have to be parsed when the plugin starts.\n";
+
+/**
+ * Write \p text as a C++ string literal.
+ */
+[[nodiscard]] auto literal(std::string const &text) -> std::string
+{
+    auto out = std::string{"\""};
+    for (auto const c : text)
+    {
+        auto const u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (u < 0x20 || u >= 0x7F)
+        {
+            // Octal escapes are always three digits, they can't run into what follows.
+            auto escape = std::ostringstream{};
+            escape << '\\' << ((u >> 6) & 7) << ((u >> 3) & 7) << (u & 7);
+            out += escape.str();
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    return out + '"';
+}
+
+[[nodiscard]] auto to_lower(std::string text) -> std::string
+{
+    for (auto &c : text)
+    {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
+template <typename T>
+[[nodiscard]] auto array(std::string const &type, std::vector<T> const &values)
+    -> std::string
+{
+    auto out = "std::array<" + type + ", " + std::to_string(values.size()) + ">{";
+    for (auto i = std::size_t{0}; i < values.size(); ++i)
+    {
+        out += (i == 0 ? "" : ", ") + std::to_string(values[i]);
+    }
+    return out + "}";
+}
+
+void write_scales(std::ostream &out, YAML::Node const &root)
+{
+    auto const scales = root["scales"];
+    for (auto i = std::size_t{0}; i < scales.size(); ++i)
+    {
+        auto const intervals = scales[i]["intervals"].as<std::vector<unsigned>>();
+        out << "inline constexpr auto scale_intervals_" << i << " = "
+            << array("std::uint8_t", intervals) << ";\n";
+    }
+    out << "\ninline constexpr auto scales = std::array<ScaleEntry, " << scales.size()
+        << ">{{\n";
+    for (auto i = std::size_t{0}; i < scales.size(); ++i)
+    {
+        auto const &scale = scales[i];
+        if (!scale["name"] || !scale["tuning_length"] || !scale["intervals"])
+        {
+            throw std::runtime_error{"Scale needs name, tuning_length and intervals"};
+        }
+        // Names are lower case, as they are when user scales are read.
+        out << "    {" << literal(to_lower(scale["name"].as<std::string>())) << ", "
+            << scale["tuning_length"].as<std::size_t>() << ", scale_intervals_" << i
+            << ", " << (scale["mode"] ? scale["mode"].as<unsigned>() : 1u) << "},\n";
+    }
+    out << "}};\n\n";
+}
+
+void write_chords(std::ostream &out, YAML::Node const &root)
+{
+    auto const chords = root["chords"];
+    for (auto i = std::size_t{0}; i < chords.size(); ++i)
+    {
+        auto const intervals = chords[i]["intervals"].as<std::vector<int>>();
+        out << "inline constexpr auto chord_intervals_" << i << " = "
+            << array("int", intervals) << ";\n";
+    }
+    out << "\ninline constexpr auto chords = std::array<ChordEntry, " << chords.size()
+        << ">{{\n";
+    for (auto i = std::size_t{0}; i < chords.size(); ++i)
+    {
+        if (!chords[i]["name"])
+        {
+            throw std::runtime_error{"Chord is missing name"};
+        }
+        out << "    {" << literal(chords[i]["name"].as<std::string>())
+            << ", chord_intervals_" << i << "},\n";
+    }
+    out << "}};\n\n";
+}
+
+void write_key_bindings(std::ostream &out, YAML::Node const &root)
+{
+    auto rows = std::string{};
+    auto count = std::size_t{0};
+    for (auto const &component : root)
+    {
+        auto const name = component.first.as<std::string>();
+        if (name == "version")
+        {
+            continue;
+        }
+        for (auto const &binding : component.second)
+        {
+            rows += "    {" + literal(name) + ", " +
+                    literal(binding.first.as<std::string>()) + ", " +
+                    literal(binding.second.as<std::string>()) + "},\n";
+            ++count;
+        }
+    }
+    out << "inline constexpr auto key_bindings = std::array<KeyBindingEntry, " << count
+        << ">{{\n"
+        << rows << "}};\n";
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int
+{
+    if (argc != 5)
+    {
+        std::cerr << usage;
+        return 1;
+    }
+
+    try
+    {
+        auto const scales = YAML::LoadFile(argv[1]);
+        auto const chords = YAML::LoadFile(argv[2]);
+        auto const keys = YAML::LoadFile(argv[3]);
+
+        auto out = std::ostringstream{};
+        out << "// Generated by tools/embed_tables from data/, do not edit.\n"
+               "#pragma once\n"
+               "\n"
+               "#include <array>\n"
+               "#include <cstddef>\n"
+               "#include <cstdint>\n"
+               "#include <span>\n"
+               "#include <string_view>\n"
+               "\n"
+               "namespace embed_tables\n"
+               "{\n"
+               "\n"
+               "struct ScaleEntry\n"
+               "{\n"
+               "    std::string_view name;\n"
+               "    std::size_t tuning_length;\n"
+               "    std::span<std::uint8_t const> intervals;\n"
+               "    std::uint8_t mode;\n"
+               "};\n"
+               "\n"
+               "struct ChordEntry\n"
+               "{\n"
+               "    std::string_view name;\n"
+               "    std::span<int const> intervals;\n"
+               "};\n"
+               "\n"
+               "struct KeyBindingEntry\n"
+               "{\n"
+               "    std::string_view component;\n"
+               "    std::string_view keys;\n"
+               "    std::string_view command;\n"
+               "};\n"
+               "\n";
+        write_scales(out, scales);
+        write_chords(out, chords);
+        write_key_bindings(out, keys);
+        out << "\n} // namespace embed_tables\n";
+
+        auto file = std::ofstream{argv[4], std::ios::binary};
+        file << out.str();
+        if (!file)
+        {
+            std::cerr << "Unable to write " << argv[4] << '\n';
+            return 1;
+        }
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "embed_tables: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}